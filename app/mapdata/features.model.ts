@@ -19,6 +19,12 @@ function normalizeFeatureIdForLookup(featureId: string): string {
     return featureId;
 }
 
+/** Camera focus facts of one feature in WGS84, see `FeatureTile.featureGeometrySummary()`. */
+export interface FeatureGeometrySummary {
+    center: {x: number, y: number, z: number};
+    boundingRadiusEndPoint: {x: number, y: number, z: number};
+}
+
 /**
  * JS interface of a WASM TileFeatureLayer.
  * The WASM TileFeatureLayer object is stored as a blob when not needed,
@@ -39,6 +45,8 @@ export class FeatureTile {
     private fieldDictBlobCache: Uint8Array | null = null;
     private dataSourceInfoBlobCache: Uint8Array | null = null;
     private featureIdByAddressCache: Map<number, string> = new Map<number, string>();
+    private featureAddressByIdCache: Map<string, number> = new Map<string, number>();
+    private geometrySummaryCache: Map<number, FeatureGeometrySummary> = new Map<number, FeatureGeometrySummary>();
     private tileFeatureLayerBlobsByStage: Map<number, Uint8Array> = new Map<number, Uint8Array>();
     private vertexCountCache: number | null = null;
     private glbAttachmentCacheVersion = -1;
@@ -123,6 +131,8 @@ export class FeatureTile {
         this.fieldDictBlobCache = null;
         this.dataSourceInfoBlobCache = null;
         this.featureIdByAddressCache.clear();
+        this.featureAddressByIdCache.clear();
+        this.geometrySummaryCache.clear();
         this.glbAttachmentCacheVersion = -1;
         this.glbAttachmentCache = undefined;
         this.dataVersion += 1;
@@ -578,10 +588,92 @@ export class FeatureTile {
         });
         if (typeof featureId === "string" && featureId.length > 0) {
             this.featureIdByAddressCache.set(featureAddress, featureId);
+            this.featureAddressByIdCache.set(featureId, featureAddress);
             return featureId;
         }
         return null;
     }
+
+    /**
+     * Resolves the tile-local address of a feature id. Attribute and relation pseudo-ids
+     * resolve to their host feature. Ids obtained from picked addresses are answered
+     * from the cache without a WASM lookup.
+     */
+    featureAddressById(featureId: string): number | null {
+        const lookupFeatureId = normalizeFeatureIdForLookup(featureId);
+        const cached = this.featureAddressByIdCache.get(lookupFeatureId);
+        if (cached !== undefined) {
+            return cached;
+        }
+        const featureAddress = this.peek((tileFeatureLayer: TileFeatureLayer) =>
+            tileFeatureLayer.featureAddressById(lookupFeatureId));
+        if (!Number.isInteger(featureAddress) || featureAddress < 0) {
+            return null;
+        }
+        this.featureIdByAddressCache.set(featureAddress, lookupFeatureId);
+        this.featureAddressByIdCache.set(lookupFeatureId, featureAddress);
+        return featureAddress;
+    }
+
+    /**
+     * Returns the center and bounding-radius end point of a feature. Summaries are kept
+     * with the tile until its data changes, so they survive between peeks. Pass the layer
+     * when already peeking into this tile, to avoid deserializing it again on a miss.
+     */
+    featureGeometrySummary(featureAddress: number, tileFeatureLayer?: TileFeatureLayer): FeatureGeometrySummary | null {
+        const cached = this.geometrySummaryCache.get(featureAddress);
+        if (cached !== undefined) {
+            return cached;
+        }
+        if (!Number.isInteger(featureAddress) || featureAddress < 0 || featureAddress >= this.numFeatures) {
+            return null;
+        }
+        const summarize = (layer: TileFeatureLayer): FeatureGeometrySummary => ({
+            center: layer.featureCenter(featureAddress),
+            boundingRadiusEndPoint: layer.featureBoundingRadiusEndPoint(featureAddress)
+        });
+        const summary = tileFeatureLayer ? summarize(tileFeatureLayer) : this.peek(summarize);
+        if (summary) {
+            this.geometrySummaryCache.set(featureAddress, summary);
+        }
+        return summary;
+    }
+
+    /**
+     * Batch variant of featureIdByAddress: all uncached addresses are resolved
+     * with a single WASM call. Unknown addresses map to null.
+     */
+    featureIdsByAddresses(featureAddresses: number[]): Array<string | null> {
+        const result: Array<string | null> = new Array(featureAddresses.length).fill(null);
+        const missingSlots: number[] = [];
+        const missingAddresses: number[] = [];
+        featureAddresses.forEach((featureAddress, slot) => {
+            if (!Number.isInteger(featureAddress) || featureAddress < 0 || featureAddress >= this.numFeatures) {
+                return;
+            }
+            const cached = this.featureIdByAddressCache.get(featureAddress);
+            if (cached !== undefined) {
+                result[slot] = cached;
+                return;
+            }
+            missingSlots.push(slot);
+            missingAddresses.push(featureAddress);
+        });
+        if (!missingAddresses.length) {
+            return result;
+        }
+        const resolved = this.peek((tileFeatureLayer: TileFeatureLayer) =>
+            tileFeatureLayer.featureIdsByAddresses(Uint32Array.from(missingAddresses)) as string[]);
+        missingSlots.forEach((slot, i) => {
+            const featureId = resolved?.[i];
+            if (typeof featureId === "string" && featureId.length > 0) {
+                this.featureIdByAddressCache.set(missingAddresses[i], featureId);
+                this.featureAddressByIdCache.set(featureId, missingAddresses[i]);
+                result[slot] = featureId;
+            }
+        });
+        return result;
+    }
 }
 
 /**
@@ -609,6 +701,8 @@ export class FeatureWrapper implements TileFeatureId {
 
     /**
      * Run a callback with the WASM Feature object referenced by this wrapper.
+     * The callback also receives the TileFeatureLayer the feature was found in,
+     * so per-tile caches can be queried by `feature.address()`.
      * The feature object will be deleted after the callback is called.
      * @returns The value returned by the callback.
      */
@@ -621,7 +715,7 @@ export class FeatureWrapper implements TileFeatureId {
             }
             let result = null;
             if (callback) {
-                result = callback(feature);
+                result = callback(feature, tileFeatureLayer);
             }
             feature.delete();
             return result;
@@ -867,4 +867,23 @@ describe('MapDataService', () => {
             "Tile request failed: MapA/LayerA: NoDataSource"
         );
     });
+
+    it('resolves the feature addresses of one tile with a single batch lookup', () => {
+        const {service} = createMapDataService();
+        const tileKey = coreLib.getTileFeatureLayerKey('m1', 'layerA', 1n);
+        const featureIdsByAddresses = vi.fn().mockReturnValue(['feature-a', null, 'feature-c']);
+        service.loadedTileLayers.set(tileKey, {
+            mapTileKey: tileKey,
+            hasData: () => true,
+            featureIdsByAddresses,
+        } as any);
+
+        expect(service.resolveTileFeatureIdsByAddresses(tileKey, [4, 99, 2])).toEqual([
+            {mapTileKey: tileKey, featureId: 'feature-a'},
+            null,
+            {mapTileKey: tileKey, featureId: 'feature-c'},
+        ]);
+        expect(featureIdsByAddresses).toHaveBeenCalledTimes(1);
+        expect(featureIdsByAddresses).toHaveBeenCalledWith([4, 99, 2]);
+    });
 });
@@ -15,7 +15,7 @@ import {BehaviorSubject, distinctUntilChanged, firstValueFrom, skip, Subject} fr
 import {ErdblickStyle, StyleService} from "../styledata/style.service";
 import {StyleValidationIssue, StyleSourceRef} from "../styledata/style-validation.model";
 import {StyleValidationReportService} from "../styledata/style-validation-report.service";
-import {Feature, FeatureLayerStyle, HighlightMode, TileLayerParser, Viewport} from '../../build/libs/core/erdblick-core';
+import {Feature, FeatureLayerStyle, HighlightMode, TileFeatureLayer, TileLayerParser, Viewport} from '../../build/libs/core/erdblick-core';
 import {
     AppStateService,
     InspectionPanelModel,
@@ -1353,14 +1353,21 @@ export class MapDataService {
             return;
         }
 
-        const mapViewLayerStyleId = this.pointMergeService.makeMapViewLayerStyleId(
-            viewIndex,
-            optionNode.mapId,
-            optionNode.layerId,
-            optionNode.styleId,
-            coreLib.HighlightMode.NO_HIGHLIGHT);
-        for (const removedMergedPointsTile of this.pointMergeService.clear(mapViewLayerStyleId)) {
-            this.mergedTileVisualizationDestructionTopic.next(removedMergedPointsTile);
+        // Merged points are only rebuilt by base visualizations which re-render, so keep
+        // them if no base rule reads the option.
+        const featureLayerStyle = this.styleService.styles.get(optionNode.styleId)?.featureLayerStyle;
+        const affectsBasePass = featureLayerStyle?.optionAffectsHighlightMode?.(
+            optionNode.id, coreLib.HighlightMode.NO_HIGHLIGHT) ?? true;
+        if (affectsBasePass) {
+            const mapViewLayerStyleId = this.pointMergeService.makeMapViewLayerStyleId(
+                viewIndex,
+                optionNode.mapId,
+                optionNode.layerId,
+                optionNode.styleId,
+                coreLib.HighlightMode.NO_HIGHLIGHT);
+            for (const removedMergedPointsTile of this.pointMergeService.clear(mapViewLayerStyleId)) {
+                this.mergedTileVisualizationDestructionTopic.next(removedMergedPointsTile);
+            }
         }
 
         viewState.visualizationQueue.retain(visu =>
@@ -2419,6 +2426,22 @@ export class MapDataService {
         } : null;
     }
 
+    /**
+     * Batch variant of resolveTileFeatureIdByAddress: all addresses of one tile are resolved
+     * with at most one WASM call. Unknown addresses map to null.
+     */
+    resolveTileFeatureIdsByAddresses(tileKey: string, featureAddresses: number[]): Array<TileFeatureId | null> {
+        const canonicalTileKey = this.canonicalizeMapTileKey(tileKey);
+        const tile = this.loadedTileLayers.get(canonicalTileKey);
+        if (!tile || !tile.hasData()) {
+            return featureAddresses.map(() => null);
+        }
+        return tile.featureIdsByAddresses(featureAddresses).map(featureId => featureId ? {
+            mapTileKey: canonicalTileKey,
+            featureId
+        } : null);
+    }
+
     /** Ensures a set of tiles is loaded, using selection-style pin requests for cache misses. */
     async loadTiles(tileKeys: Set<string | null>): Promise<Map<string, FeatureTile>> {
         const result = new Map<string, FeatureTile>();
@@ -2655,11 +2678,15 @@ export class MapDataService {
             }
         }
 
-        featureWrapper.peek((feature: Feature) => {
-            const center = feature.center() as Cartesian3;
+        featureWrapper.peek((feature: Feature, tileFeatureLayer: TileFeatureLayer) => {
+            const summary = featureWrapper.featureTile.featureGeometrySummary(feature.address(), tileFeatureLayer);
+            if (!summary) {
+                return;
+            }
+            const center = summary.center;
             const centerCartesian = Cartesian3.fromDegrees(center.x, center.y, center.z);
-            let radiusPoint = feature.boundingRadiusEndPoint() as Cartesian3;
-            radiusPoint = Cartesian3.fromDegrees(radiusPoint.x, radiusPoint.y, radiusPoint.z);
+            const radiusEnd = summary.boundingRadiusEndPoint;
+            const radiusPoint = Cartesian3.fromDegrees(radiusEnd.x, radiusEnd.y, radiusEnd.z);
             const boundingRadius = Cartesian3.distance(centerCartesian, radiusPoint);
             const geometryType = feature.getGeometryType() as any;
 
@@ -0,0 +1,68 @@
+import {describe, expect, it} from "vitest";
+import {canRenderJointly, DeckTileRenderRequest} from "./deck-render.worker.pool";
+import {DECK_GEOMETRY_OUTPUT_ALL} from "./deck-render.worker.protocol";
+
+const tileStageBlob = new Uint8Array([1, 2, 3]);
+const fieldDictBlob = new Uint8Array([4]);
+const dataSourceInfoBlob = new Uint8Array([5]);
+
+function makeRequest(overrides: Partial<DeckTileRenderRequest> = {}): DeckTileRenderRequest {
+    return {
+        viewIndex: 0,
+        tileKey: "Island-6/Lane/42",
+        tileStageBlobs: [tileStageBlob],
+        fieldDictBlob,
+        dataSourceInfoBlob,
+        nodeId: "node",
+        mapName: "Island-6",
+        layerName: "Lane",
+        styleSource: "name: Lanes",
+        styleSourceRef: {sourceKind: "base"},
+        styleOptions: {},
+        highlightModeValue: 0,
+        fidelityValue: 0,
+        highFidelityStage: 0,
+        maxLowFiLod: -1,
+        outputMode: DECK_GEOMETRY_OUTPUT_ALL,
+        featureIdSubset: [],
+        mergeCountSnapshot: {},
+        ...overrides
+    };
+}
+
+describe("canRenderJointly", () => {
+    it("combines full-tile passes of the same tile data with different styles", () => {
+        const lanes = makeRequest();
+        const outlines = makeRequest({
+            styleSource: "name: Outlines",
+            styleOptions: {showOutlines: true},
+            mergeCountSnapshot: {"0:Island-6:Lane:Outlines:0:0|1:2:3": 2},
+            tileStageBlobs: [tileStageBlob]
+        });
+        expect(canRenderJointly(lanes, outlines)).toBe(true);
+    });
+
+    it("keeps requests of the same style, other tile data or another configuration apart", () => {
+        const lanes = makeRequest();
+        expect(canRenderJointly(lanes, makeRequest())).toBe(false);
+
+        const outlines = {styleSource: "name: Outlines"};
+        expect(canRenderJointly(lanes, makeRequest({...outlines, tileStageBlobs: [new Uint8Array([1, 2, 3])]}))).toBe(false);
+        expect(canRenderJointly(lanes, makeRequest({...outlines, highlightModeValue: 1}))).toBe(false);
+        expect(canRenderJointly(lanes, makeRequest({...outlines, maxLowFiLod: 3}))).toBe(false);
+    });
+
+    it("never combines passes restricted to a feature subset", () => {
+        const lanes = makeRequest();
+        const outlines = {styleSource: "name: Outlines"};
+        expect(canRenderJointly(lanes, makeRequest({...outlines, featureIdSubset: ["Lane.1"]}))).toBe(false);
+        expect(canRenderJointly(lanes, makeRequest({
+            ...outlines,
+            featureAddressSubset: {
+                featureAddresses: new Uint32Array([1]),
+                attributeIndices: new Uint32Array([0xffffffff]),
+                validityIndices: new Uint32Array([0xffffffff])
+            }
+        }))).toBe(false);
+    });
+});
@@ -1,6 +1,9 @@
 import {
+    DeckCancelTaskMessage,
+    DeckFeatureAddressSubset,
     DeckGeometryOutputMode,
     DeckLowFiBundleBuffers,
+    DeckMultiStyleRenderTask,
     DeckTileRenderBuffers,
     DeckTileRenderResult,
     DeckTileRenderTask,
@@ -11,6 +14,8 @@ import {StyleSourceRef} from "../../styledata/style-validation.model";
 const AUTO_WORKER_MIN = 2;
 const AUTO_WORKER_FALLBACK_CPU_COUNT = 4;
 const WORKER_OVERRIDE_CAP = 32;
+/** Upper bound of styles rendered by one multi-style task, so one tile does not hog a worker. */
+const MAX_STYLES_PER_TASK = 8;
 
 /** Main-thread request payload accepted by the render-worker pool. */
 export interface DeckTileRenderRequest {
@@ -31,6 +36,7 @@ export interface DeckTileRenderRequest {
     maxLowFiLod: number;
     outputMode: DeckGeometryOutputMode;
     featureIdSubset: string[];
+    featureAddressSubset?: DeckFeatureAddressSubset;
     mergeCountSnapshot: Record<string, number>;
 }
 
@@ -40,26 +46,66 @@ export interface DeckRenderWorkerSettings {
     workerCountOverride: number | null;
 }
 
-/** Promise bookkeeping kept until one worker finishes rendering a specific tile task. */
+/** Promise bookkeeping kept until one worker finishes rendering a specific tile request. */
 type PendingTask = {
-    task: DeckTileRenderTask;
+    taskId: string;
     resolve: (value: DeckTileRenderBuffers) => void;
     reject: (reason?: unknown) => void;
+    /** Set if the caller aborted while the request renders jointly with others. */
+    aborted: boolean;
 };
 
+/** Render request waiting for a free worker. */
+type QueuedRequest = {
+    request: DeckTileRenderRequest;
+    resolve: (value: DeckTileRenderBuffers) => void;
+    reject: (reason?: unknown) => void;
+    pending?: PendingTask;
+};
+
+/** Task running on one worker, and the pending requests its result answers. */
+type RunningTask = {
+    taskId: string;
+    members: PendingTask[];
+};
+
+/**
+ * Returns whether two requests can be answered by one multi-style task: full-tile passes over
+ * the same staged tile data with the same render configuration, differing only in style.
+ */
+export function canRenderJointly(a: DeckTileRenderRequest, b: DeckTileRenderRequest): boolean {
+    const isFullTilePass = (request: DeckTileRenderRequest) =>
+        !request.featureIdSubset.length && !request.featureAddressSubset;
+    return isFullTilePass(a)
+        && isFullTilePass(b)
+        && a.styleSource !== b.styleSource
+        && a.tileKey === b.tileKey
+        && a.viewIndex === b.viewIndex
+        && a.nodeId === b.nodeId
+        && a.mapName === b.mapName
+        && a.layerName === b.layerName
+        && a.fieldDictBlob === b.fieldDictBlob
+        && a.dataSourceInfoBlob === b.dataSourceInfoBlob
+        && a.tileStageBlobs.length === b.tileStageBlobs.length
+        && a.tileStageBlobs.every((blob, index) => blob === b.tileStageBlobs[index])
+        && a.highlightModeValue === b.highlightModeValue
+        && a.fidelityValue === b.fidelityValue
+        && a.highFidelityStage === b.highFidelityStage
+        && a.maxLowFiLod === b.maxLowFiLod
+        && a.outputMode === b.outputMode;
+}
+
 /**
  * Pool of module workers that turn staged tile/style inputs into deck-ready buffers.
  * The pool lazily initializes, keeps one task in flight per worker, and can be rebuilt on settings changes.
+ * Requests for the same tile which wait for a worker together are rendered by one multi-style task,
+ * which walks the tile's features once for all of their styles.
  */
 export class DeckRenderWorkerPool {
     private readonly workers: Worker[] = [];
-    private readonly workerBusy: boolean[] = [];
-    private readonly runningTaskIdByWorker: Array<string | null> = [];
+    private readonly runningTaskByWorker: Array<RunningTask | null> = [];
     private readonly inFlightByTaskId = new Map<string, PendingTask>();
-    private readonly availableWorkerWaiters: Array<{
-        resolve: (workerIndex: number) => void;
-        reject: (reason?: unknown) => void;
-    }> = [];
+    private readonly queuedRequests: QueuedRequest[] = [];
     private workerBlobUrl: string | null = null;
     private initPromise: Promise<void> | null = null;
     private nextTaskId = 0;
@@ -67,21 +113,123 @@ export class DeckRenderWorkerPool {
     /** Creates the pool wrapper with the maximum number of workers to spawn on initialization. */
     constructor(private readonly maxWorkers: number) {}
 
-    /** Queues one tile render request onto the next free worker and resolves with the packed buffers. */
-    async renderTile(request: DeckTileRenderRequest): Promise<DeckTileRenderBuffers> {
+    /**
+     * Queues one tile render request onto the next free worker and resolves with the packed buffers.
+     * Aborting `signal` drops a queued request, or cancels its task between the worker's render slices,
+     * and rejects the promise. A multi-style task is only cancelled once all of its requests aborted.
+     */
+    async renderTile(request: DeckTileRenderRequest, signal?: AbortSignal): Promise<DeckTileRenderBuffers> {
         await this.ensureInitialized();
-        const workerIndex = await this.acquireWorkerSlot();
+        if (signal?.aborted) {
+            throw new Error("Deck render task cancelled.");
+        }
         return await new Promise<DeckTileRenderBuffers>((resolve, reject) => {
+            const queued: QueuedRequest = {request, resolve, reject};
+            this.queuedRequests.push(queued);
+            signal?.addEventListener("abort", () => this.abortRequest(queued), {once: true});
+            this.dispatchQueuedRequests();
+        });
+    }
+
+    /** Drops an aborted request from the queue, or cancels the task rendering it. */
+    private abortRequest(queued: QueuedRequest): void {
+        const queueIndex = this.queuedRequests.indexOf(queued);
+        if (queueIndex >= 0) {
+            this.queuedRequests.splice(queueIndex, 1);
+            queued.reject(new Error("Deck render task cancelled."));
+            return;
+        }
+        const pending = queued.pending;
+        if (!pending || !this.inFlightByTaskId.has(pending.taskId)) {
+            return;
+        }
+        pending.aborted = true;
+        const workerIndex = this.runningTaskByWorker.findIndex(running => running?.members.includes(pending));
+        const running = this.runningTaskByWorker[workerIndex];
+        if (!running || !running.members.every(member => member.aborted)) {
+            return;
+        }
+        this.workers[workerIndex]!.postMessage(
+            {type: "DeckCancelTask", taskId: running.taskId} as DeckCancelTaskMessage
+        );
+    }
+
+    /** Hands queued requests to idle workers, combining requests which can render jointly. */
+    private dispatchQueuedRequests(): void {
+        for (let i = 0; i < this.workers.length && this.queuedRequests.length; i++) {
+            if (this.runningTaskByWorker[i]) {
+                continue;
+            }
+            this.postRequestGroup(i, this.takeNextRequestGroup());
+        }
+    }
+
+    /** Removes the oldest queued request and every later one which can share its task. */
+    private takeNextRequestGroup(): QueuedRequest[] {
+        const group = [this.queuedRequests.shift()!];
+        for (let i = 0; i < this.queuedRequests.length && group.length < MAX_STYLES_PER_TASK;) {
+            const candidate = this.queuedRequests[i];
+            if (group.every(member => canRenderJointly(member.request, candidate.request))) {
+                group.push(candidate);
+                this.queuedRequests.splice(i, 1);
+                continue;
+            }
+            i++;
+        }
+        return group;
+    }
+
+    /** Posts one render task for a group of requests to an idle worker. */
+    private postRequestGroup(workerIndex: number, group: QueuedRequest[]): void {
+        const members = group.map((queued): PendingTask => {
+            const pending: PendingTask = {
+                taskId: this.makeTaskId(),
+                resolve: queued.resolve,
+                reject: queued.reject,
+                aborted: false
+            };
+            queued.pending = pending;
+            this.inFlightByTaskId.set(pending.taskId, pending);
+            return pending;
+        });
+        if (group.length === 1) {
             const task: DeckTileRenderTask = {
                 type: "DeckTileRenderTask",
-                taskId: this.makeTaskId(),
-                ...request
+                taskId: members[0].taskId,
+                ...group[0].request
             };
-            const pendingTask: PendingTask = {task, resolve, reject};
-            this.inFlightByTaskId.set(task.taskId, pendingTask);
-            this.runningTaskIdByWorker[workerIndex] = task.taskId;
+            this.runningTaskByWorker[workerIndex] = {taskId: task.taskId, members};
             this.workers[workerIndex]!.postMessage(task);
-        });
+            return;
+        }
+
+        const request = group[0].request;
+        const task: DeckMultiStyleRenderTask = {
+            type: "DeckMultiStyleRenderTask",
+            taskId: this.makeTaskId(),
+            viewIndex: request.viewIndex,
+            tileKey: request.tileKey,
+            tileStageBlobs: request.tileStageBlobs,
+            fieldDictBlob: request.fieldDictBlob,
+            dataSourceInfoBlob: request.dataSourceInfoBlob,
+            nodeId: request.nodeId,
+            mapName: request.mapName,
+            layerName: request.layerName,
+            highlightModeValue: request.highlightModeValue,
+            fidelityValue: request.fidelityValue,
+            highFidelityStage: request.highFidelityStage,
+            maxLowFiLod: request.maxLowFiLod,
+            outputMode: request.outputMode,
+            styles: group.map((queued, index) => ({
+                taskId: members[index].taskId,
+                styleSource: queued.request.styleSource,
+                styleSourceRef: queued.request.styleSourceRef,
+                styleOptions: queued.request.styleOptions,
+                mergeCountSnapshot: queued.request.mergeCountSnapshot
+            }))
+        };
+        this.runningTaskByWorker[workerIndex] = {taskId: task.taskId, members};
+        this.workers[workerIndex]!.postMessage(task);
     }
 
     /** Initializes workers once and shares the same promise across concurrent callers. */
@@ -152,24 +300,26 @@ export class DeckRenderWorkerPool {
     /** Registers message/error handlers for one worker slot. */
     private registerWorker(worker: Worker, index: number): void {
         this.workers[index] = worker;
-        this.workerBusy[index] = false;
-        this.runningTaskIdByWorker[index] = null;
+        this.runningTaskByWorker[index] = null;
         worker.onmessage = (event: MessageEvent<DeckWorkerOutboundMessage>) => {
             const msg = event.data;
-            this.runningTaskIdByWorker[index] = null;
-            this.handleTaskResult(msg as DeckTileRenderResult);
-            this.releaseWorkerSlot(index);
+            this.runningTaskByWorker[index] = null;
+            if (msg.type === "DeckMultiStyleRenderResult") {
+                msg.results.forEach(result => this.handleTaskResult(result));
+            } else {
+                this.handleTaskResult(msg as DeckTileRenderResult);
+            }
+            this.dispatchQueuedRequests();
         };
         worker.onerror = (event) => {
-            const runningTaskId = this.runningTaskIdByWorker[index];
-            this.runningTaskIdByWorker[index] = null;
-            if (runningTaskId) {
-                const inFlight = this.inFlightByTaskId.get(runningTaskId);
-                this.inFlightByTaskId.delete(runningTaskId);
-                inFlight!.reject(new Error(event.message || "Deck worker execution failed."));
+            const running = this.runningTaskByWorker[index];
+            this.runningTaskByWorker[index] = null;
+            for (const member of running?.members ?? []) {
+                this.inFlightByTaskId.delete(member.taskId);
+                member.reject(new Error(event.message || "Deck worker execution failed."));
             }
             // The slot is still reusable after one task failure; the pool only tears down on reconfiguration.
-            this.releaseWorkerSlot(index);
+            this.dispatchQueuedRequests();
         };
     }
 
@@ -180,6 +330,10 @@ export class DeckRenderWorkerPool {
             return;
         }
         this.inFlightByTaskId.delete(result.taskId);
+        if (result.cancelled || pending.aborted) {
+            pending.reject(new Error("Deck render task cancelled."));
+            return;
+        }
         if (result.error) {
             pending.reject(new Error(result.error));
             return;
@@ -192,6 +346,7 @@ export class DeckRenderWorkerPool {
             labelWorld: result.labelWorld,
             labelBillboard: result.labelBillboard,
             surface: result.surface,
+            mesh: result.mesh,
             pathWorld: result.pathWorld,
             pathBillboard: result.pathBillboard,
             arrowWorld: result.arrowWorld,
@@ -206,6 +361,7 @@ export class DeckRenderWorkerPool {
                 labelWorld: bundle.labelWorld,
                 labelBillboard: bundle.labelBillboard,
                 surface: bundle.surface,
+                mesh: bundle.mesh,
                 pathWorld: bundle.pathWorld,
                 pathBillboard: bundle.pathBillboard,
                 arrowWorld: bundle.arrowWorld,
@@ -219,31 +375,6 @@ export class DeckRenderWorkerPool {
         });
     }
 
-    /** Acquires the next idle worker slot or waits until one becomes available. */
-    private async acquireWorkerSlot(): Promise<number> {
-        for (let i = 0; i < this.workers.length; i++) {
-            if (this.workerBusy[i]) {
-                continue;
-            }
-            this.workerBusy[i] = true;
-            return i;
-        }
-        return await new Promise<number>((resolve, reject) => {
-            this.availableWorkerWaiters.push({resolve, reject});
-        });
-    }
-
-    /** Releases a worker slot and immediately hands it to the next waiter if one exists. */
-    private releaseWorkerSlot(index: number): void {
-        const waiter = this.availableWorkerWaiters.shift();
-        if (waiter) {
-            this.workerBusy[index] = true;
-            waiter.resolve(index);
-            return;
-        }
-        this.workerBusy[index] = false;
-    }
-
     /** Builds a unique task id used to correlate worker results back to their pending promise. */
     private makeTaskId(): string {
         this.nextTaskId += 1;
@@ -253,13 +384,12 @@ export class DeckRenderWorkerPool {
     /** Tears down the entire pool and rejects every pending or waiting task with a reset reason. */
     dispose(reason = "Deck render worker pool reset."): void {
         const resetError = new Error(reason);
-        this.availableWorkerWaiters.splice(0).forEach(waiter => waiter.reject(resetError));
+        this.queuedRequests.splice(0).forEach(queued => queued.reject(resetError));
         for (const pending of this.inFlightByTaskId.values()) {
             pending.reject(resetError);
         }
         this.inFlightByTaskId.clear();
-        this.workerBusy.length = 0;
-        this.runningTaskIdByWorker.length = 0;
+        this.runningTaskByWorker.length = 0;
         for (const worker of this.workers) {
             worker.terminate();
         }
@@ -1,5 +1,13 @@
 import {StyleSourceRef, StyleValidationIssue} from "../../styledata/style-validation.model";
 
+/** Deck wasm ABI whose render results carry columnar label buffers instead of label objects. */
+export const DECK_WASM_ABI_VERSION = 2;
+
+/** Bit in `DeckLabelBuffers.flags`: the label is depth-tested. */
+export const DECK_LABEL_FLAG_DEPTH_TEST = 1;
+/** Bit in `DeckLabelBuffers.flags`: the label carries a pixel offset. */
+export const DECK_LABEL_FLAG_PIXEL_OFFSET = 2;
+
 /** Render every deck geometry family the wasm renderer can emit. */
 export const DECK_GEOMETRY_OUTPUT_ALL = 0;
 /** Restrict wasm output to point-like geometry so point-only passes skip heavy mesh work. */
@@ -13,6 +21,16 @@ export type DeckGeometryOutputMode =
     typeof DECK_GEOMETRY_OUTPUT_POINTS_ONLY |
     typeof DECK_GEOMETRY_OUTPUT_NON_POINTS_ONLY;
 
+/**
+ * Highlight subset given by tile feature address. Attribute and validity indices are parallel
+ * to the addresses; 0xffffffff selects the whole feature or attribute.
+ */
+export interface DeckFeatureAddressSubset {
+    featureAddresses: Uint32Array;
+    attributeIndices: Uint32Array;
+    validityIndices: Uint32Array;
+}
+
 /** Inbound worker task that contains every staged tile/style input needed for buffer generation. */
 export interface DeckTileRenderTask {
     type: "DeckTileRenderTask";
@@ -34,9 +52,38 @@ export interface DeckTileRenderTask {
     maxLowFiLod: number;
     outputMode: DeckGeometryOutputMode;
     featureIdSubset: string[];
+    featureAddressSubset?: DeckFeatureAddressSubset;
     mergeCountSnapshot: Record<string, number>;
 }
 
+/** Style-specific part of a multi-style task; its result carries the entry's own task id. */
+export interface DeckMultiStyleEntry {
+    taskId: string;
+    styleSource: string;
+    styleSourceRef: StyleSourceRef;
+    styleOptions: Record<string, boolean | number | string>;
+    mergeCountSnapshot: Record<string, number>;
+}
+
+/**
+ * Inbound worker task rendering one tile with several styles in one feature traversal.
+ * Only full-tile passes are combined, so there are no feature subsets.
+ */
+export interface DeckMultiStyleRenderTask extends Omit<
+    DeckTileRenderTask,
+    "type" | keyof DeckMultiStyleEntry | "featureIdSubset" | "featureAddressSubset"
+> {
+    type: "DeckMultiStyleRenderTask";
+    taskId: string;
+    styles: DeckMultiStyleEntry[];
+}
+
+/** Asks the worker to abandon a task between render slices; it answers with a `cancelled` result. */
+export interface DeckCancelTaskMessage {
+    type: "DeckCancelTask";
+    taskId: string;
+}
+
 /** Handshake message sent from the main thread to bootstrap the render worker. */
 export interface DeckWorkerInitMessage {
     type: "DeckWorkerInit";
@@ -71,9 +118,28 @@ export interface DeckSurfaceBucketBuffers {
     colors: Uint8Array;
     depthTests: Uint8Array;
     featureAddresses: Uint32Array;
+    /** Triangle vertex indices relative to each surface's first vertex, when triangulated in wasm. */
+    indices?: Uint32Array;
+    /** Per-surface offsets into `indices`; only as long as `startIndices` when triangulated. */
+    indexStartIndices?: Uint32Array;
 }
 
-/** Packed deck path/arrow buffers emitted by the worker. */
+/** Packed indexed mesh buffers; color, depth test and feature address are stored once per mesh. */
+export interface DeckMeshBucketBuffers {
+    positions: Float32Array;
+    startIndices: Uint32Array;
+    /** Triangle vertex indices relative to each mesh's first vertex. */
+    indices: Uint32Array;
+    indexStartIndices: Uint32Array;
+    colors: Uint8Array;
+    depthTests: Uint8Array;
+    featureAddresses: Uint32Array;
+}
+
+/**
+ * Packed deck path/arrow buffers emitted by the worker. `colors`, `widths` and `dashArrays`
+ * hold one entry per vertex, or one per path when the worker enabled per-path attributes.
+ */
 export interface DeckPathBucketBuffers {
     positions: Float32Array;
     startIndices: Uint32Array;
@@ -114,13 +180,31 @@ export interface DeckLabelDatum {
     depthTest?: boolean;
 }
 
+/** Columnar label buffers emitted by deck ABI v2; text is one UTF-8 blob split by `textOffsets`. */
+export interface DeckLabelBuffers {
+    positions: Float32Array;
+    text: Uint8Array;
+    textOffsets: Uint32Array;
+    fillColors: Uint8Array;
+    outlineColors: Uint8Array;
+    outlineWidths: Float32Array;
+    scales: Float32Array;
+    pixelOffsets: Float32Array;
+    flags: Uint8Array;
+    featureAddresses: Uint32Array;
+}
+
+/** Label bucket payload: label objects (ABI v1) or columnar buffers (ABI v2). */
+export type DeckLabelBucket = DeckLabelDatum[] | DeckLabelBuffers;
+
 /** Full set of geometry buckets for one rendered tile or low-fi LOD bundle. */
 export interface DeckGeometryBucketBuffers {
     pointWorld: DeckPointBucketBuffers;
     pointBillboard: DeckPointBucketBuffers;
-    labelWorld: DeckLabelDatum[];
-    labelBillboard: DeckLabelDatum[];
+    labelWorld: DeckLabelBucket;
+    labelBillboard: DeckLabelBucket;
     surface: DeckSurfaceBucketBuffers;
+    mesh: DeckMeshBucketBuffers;
     pathWorld: DeckPathBucketBuffers;
     pathBillboard: DeckPathBucketBuffers;
     arrowWorld: DeckPathBucketBuffers;
@@ -142,6 +226,33 @@ export interface DeckVisualizationBufferResult extends DeckGeometryBucketBuffers
     styleIssues?: StyleValidationIssue[];
 }
 
+/** Typed-array constructor names used by the packed render arena descriptor table. */
+export type DeckArenaElementType = "Float32Array" | "Float64Array" | "Uint32Array" | "Uint8Array";
+
+/** Location of one typed buffer inside the packed wasm render arena. */
+export interface DeckArenaBufferDescriptor {
+    /** LOD of the low-fi bundle owning the buffer, or -1 for the aggregate buckets. */
+    lod: number;
+    bucket: string;
+    field: string;
+    type: DeckArenaElementType;
+    byteOffset: number;
+    length: number;
+}
+
+/** Descriptor-table render result returned by `renderResultArena()`. */
+export interface DeckArenaRenderResult {
+    arenaPointer: number;
+    arenaByteLength: number;
+    buffers: DeckArenaBufferDescriptor[];
+    /** Only present for ABI v1; ABI v2 labels are part of the descriptor table. */
+    labelWorld?: DeckLabelDatum[];
+    labelBillboard?: DeckLabelDatum[];
+    lowFiBundles: {lod: number, labelWorld?: DeckLabelDatum[], labelBillboard?: DeckLabelDatum[]}[];
+    coordinateOrigin: Float64Array;
+    mergedPointFeatures: Record<string, any[]>;
+}
+
 /** Main-thread-friendly view of a worker result after message unpacking and timing normalization. */
 export interface DeckTileRenderBuffers extends DeckVisualizationBufferResult {
     vertexCount: number;
@@ -156,9 +267,19 @@ export interface DeckTileRenderResult extends DeckVisualizationBufferResult {
     vertexCount: number;
     timings?: DeckWorkerTimings;
     error?: string;
+    /** Set if the task was cancelled before it finished; the buffers are empty then. */
+    cancelled?: boolean;
+}
+
+/** Worker-to-main-thread result of a multi-style task, with one result per style entry. */
+export interface DeckMultiStyleRenderResult {
+    type: "DeckMultiStyleRenderResult";
+    taskId: string;
+    results: DeckTileRenderResult[];
 }
 
 /** All messages accepted by the worker. */
-export type DeckWorkerInboundMessage = DeckTileRenderTask | DeckWorkerInitMessage;
+export type DeckWorkerInboundMessage =
+    DeckTileRenderTask | DeckMultiStyleRenderTask | DeckCancelTaskMessage | DeckWorkerInitMessage;
 /** All messages emitted by the worker. */
-export type DeckWorkerOutboundMessage = DeckTileRenderResult | DeckWorkerReadyMessage;
+export type DeckWorkerOutboundMessage = DeckTileRenderResult | DeckMultiStyleRenderResult | DeckWorkerReadyMessage;
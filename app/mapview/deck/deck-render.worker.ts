@@ -1,6 +1,7 @@
 import {initializeLibrary, coreLib, type ErdblickCore_, uint8ArrayToWasm} from "../../integrations/wasm";
 import {
     DeckFeatureLayerVisualization,
+    DeckMultiStyleVisualization,
     FeatureLayerStyle,
     HighlightMode,
     RuleFidelity,
@@ -8,12 +9,17 @@ import {
     TileLayerParser
 } from "../../../build/libs/core/erdblick-core";
 import {
+    DeckArenaElementType,
+    DeckArenaRenderResult,
     DECK_GEOMETRY_OUTPUT_ALL,
     DECK_GEOMETRY_OUTPUT_NON_POINTS_ONLY,
     DECK_GEOMETRY_OUTPUT_POINTS_ONLY,
+    DECK_WASM_ABI_VERSION,
     DeckGeometryBucketBuffers,
     DeckGeometryOutputMode,
     DeckLowFiBundleBuffers,
+    DeckMultiStyleRenderResult,
+    DeckMultiStyleRenderTask,
     DeckTileRenderResult,
     DeckTileRenderTask,
     DeckVisualizationBufferResult,
@@ -30,11 +36,53 @@ const styleCache = new Map<string, FeatureLayerStyle>();
 
 /** Strongly typed handle for the wasm deck visualization constructor exposed after init. */
 type DeckFeatureLayerVisualizationCtor = ErdblickCore_["DeckFeatureLayerVisualization"];
+/** Strongly typed handle for the wasm multi-style deck visualization constructor. */
+type DeckMultiStyleVisualizationCtor = ErdblickCore_["DeckMultiStyleVisualization"];
 /** Strongly typed handle for the wasm `RuleFidelity` enum object. */
 type RuleFidelityEnum = ErdblickCore_["RuleFidelity"];
 /** Deck visualization variant that exposes the packed binary render result to the worker. */
 type DeckFeatureLayerVisualizationWithRenderResult = DeckFeatureLayerVisualization & {
     renderResult(): DeckVisualizationBufferResult;
+    renderResultArena?(): DeckArenaRenderResult;
+    setAbiVersion(version: number): void;
+    setTriangulateSurfaces?(enabled: boolean): void;
+    setPerPathAttributes?(enabled: boolean): void;
+    runFor?(budgetMicros: number): boolean;
+    cancel?(): void;
+    resetForNextTile?(): void;
+    setFeatureMergeService?(mergeService: unknown): void;
+    setFeatureAddressSubset?(
+        featureAddresses: Uint32Array,
+        attributeIndices: Uint32Array,
+        validityIndices: Uint32Array
+    ): void;
+};
+
+/** Render budget per `runFor()` slice; the worker checks for cancellation between slices. */
+const RUN_SLICE_BUDGET_MICROS = 8000;
+/** Id of the task currently being rendered, and whether the pool asked to cancel it. */
+let activeTaskId: string | null = null;
+let activeTaskCancelled = false;
+/** Visualization shared by consecutive tasks with the same configuration, see `acquireVisualization()`. */
+let reusableVisualization: {
+    key: string;
+    style: FeatureLayerStyle;
+    visu: DeckFeatureLayerVisualizationWithRenderResult;
+} | null = null;
+/** Private channel used to yield to the event loop without the nested-timer clamping of `setTimeout`. */
+const yieldChannel = new MessageChannel();
+
+/** Task fields which select the parser for a tile. */
+type ParserContext = Pick<DeckTileRenderTask, "nodeId" | "mapName" | "fieldDictBlob" | "dataSourceInfoBlob">;
+/** Task fields which annotate the runtime style issues of one style's result. */
+type StyleIssueContext = Pick<DeckTileRenderTask, "styleSourceRef" | "mapName" | "layerName" | "tileKey">;
+
+/** Typed-array constructors for the element types named in arena descriptors. */
+const ARENA_VIEW_CTORS: Record<DeckArenaElementType, new (buffer: ArrayBuffer, byteOffset: number, length: number) => ArrayBufferView> = {
+    Float32Array,
+    Float64Array,
+    Uint32Array,
+    Uint8Array
 };
 
 /** Returns the wasm constructor for deck feature visualizations after the core library is initialized. */
@@ -42,6 +90,11 @@ function deckFeatureLayerVisualizationCtor(): DeckFeatureLayerVisualizationCtor
     return coreLib.DeckFeatureLayerVisualization as DeckFeatureLayerVisualizationCtor;
 }
 
+/** Returns the wasm constructor for multi-style deck visualizations. */
+function deckMultiStyleVisualizationCtor(): DeckMultiStyleVisualizationCtor {
+    return coreLib.DeckMultiStyleVisualization as DeckMultiStyleVisualizationCtor;
+}
+
 /** Returns the wasm fidelity enum used by the deck render worker. */
 function ruleFidelityEnum(): RuleFidelityEnum {
     return coreLib.RuleFidelity as RuleFidelityEnum;
@@ -57,7 +110,7 @@ function blobSignature(blob: Uint8Array): string {
 }
 
 /** Builds the parser-cache key from the datasource node and parser-context blobs. */
-function parserCacheKey(task: DeckTileRenderTask): string {
+function parserCacheKey(task: ParserContext): string {
     return [
         task.nodeId,
         task.mapName,
@@ -67,7 +120,7 @@ function parserCacheKey(task: DeckTileRenderTask): string {
 }
 
 /** Reuses parser instances that share identical field dictionaries and datasource metadata. */
-function getOrCreateParser(task: DeckTileRenderTask): TileLayerParser {
+function getOrCreateParser(task: ParserContext): TileLayerParser {
     const key = parserCacheKey(task);
     const cached = parserCache.get(key);
     if (cached) {
@@ -122,17 +175,56 @@ function resolveFidelity(fidelityValue: number): RuleFidelity {
 
 /** Adapts the main thread's merge-count snapshot into the callback shape expected by wasm rendering. */
 function createMergeCountProvider(snapshot: Record<string, number>): {
-    count: (_geoPos: unknown, hashPos: string, _level: number, mapViewLayerStyleRuleId: string) => number
+    count: (_geoPos: unknown, hashPos: string, _level: number, mapViewLayerStyleRuleId: string) => number,
+    countBatch: (
+        _level: number,
+        mapViewLayerStyleRuleIds: string[],
+        ruleSlots: Uint32Array,
+        _geoPositions: Float64Array,
+        cells: Float64Array
+    ) => Int32Array
 } {
     const table = snapshot ?? {};
+    const lookup = (mapViewLayerStyleRuleId: string, hashPos: string) => {
+        const value = table[`${mapViewLayerStyleRuleId}|${hashPos}`];
+        return Number.isInteger(value) ? value : 0;
+    };
     return {
-        count: (_geoPos: unknown, hashPos: string, _level: number, mapViewLayerStyleRuleId: string) => {
-            const value = table[`${mapViewLayerStyleRuleId}|${hashPos}`];
-            return Number.isInteger(value) ? value : 0;
+        count: (_geoPos: unknown, hashPos: string, _level: number, mapViewLayerStyleRuleId: string) =>
+            lookup(mapViewLayerStyleRuleId, hashPos),
+        // Resolves all grid cells of a tile in one WASM->JS crossing; cells are packed as x,y,z triples.
+        countBatch: (
+            _level: number,
+            mapViewLayerStyleRuleIds: string[],
+            ruleSlots: Uint32Array,
+            _geoPositions: Float64Array,
+            cells: Float64Array
+        ) => {
+            const counts = new Int32Array(ruleSlots.length);
+            for (let i = 0; i < ruleSlots.length; i++) {
+                const hashPos = `${cells[i * 3]}:${cells[i * 3 + 1]}:${cells[i * 3 + 2]}`;
+                counts[i] = lookup(mapViewLayerStyleRuleIds[ruleSlots[i]], hashPos);
+            }
+            return counts;
         }
     };
 }
 
+/** Deserializes the staged tile blobs, skipping stages the parser rejects. */
+function deserializeTileLayers(parser: TileLayerParser, tileStageBlobs: Uint8Array[]): TileFeatureLayer[] {
+    const layers: TileFeatureLayer[] = [];
+    for (const tileBlob of tileStageBlobs) {
+        const layer = uint8ArrayToWasm((data) => parser.readTileFeatureLayer(data), tileBlob) as TileFeatureLayer | null;
+        if (layer) {
+            layers.push(layer);
+        }
+    }
+    if (!layers.length) {
+        throw new Error("Worker render requested without any deserializable tile layers.");
+    }
+    return layers;
+}
+
 /** Attaches every higher-stage tile layer as an overlay to the base layer before rendering. */
 function attachOverlayChain(baseLayer: TileFeatureLayer, overlays: TileFeatureLayer[]): void {
     for (const overlay of overlays) {
@@ -147,7 +239,27 @@ function transferPointBucket(bucket: DeckGeometryBucketBuffers["pointWorld"]): A
 
 /** Collects transferable buffers for one packed surface bucket. */
 function transferSurfaceBucket(bucket: DeckGeometryBucketBuffers["surface"]): ArrayBuffer[] {
-    return [bucket.positions.buffer, bucket.startIndices.buffer, bucket.colors.buffer, bucket.featureAddresses.buffer];
+    return [
+        bucket.positions.buffer,
+        bucket.startIndices.buffer,
+        bucket.colors.buffer,
+        bucket.featureAddresses.buffer,
+        ...(bucket.indices ? [bucket.indices.buffer] : []),
+        ...(bucket.indexStartIndices ? [bucket.indexStartIndices.buffer] : [])
+    ];
+}
+
+/** Collects transferable buffers for one packed indexed mesh bucket. */
+function transferMeshBucket(bucket: DeckGeometryBucketBuffers["mesh"]): ArrayBuffer[] {
+    return [
+        bucket.positions.buffer,
+        bucket.startIndices.buffer,
+        bucket.indices.buffer,
+        bucket.indexStartIndices.buffer,
+        bucket.colors.buffer,
+        bucket.depthTests.buffer,
+        bucket.featureAddresses.buffer
+    ];
 }
 
 /** Collects transferable buffers for one packed path or arrow bucket. */
@@ -162,6 +274,25 @@ function transferPathBucket(bucket: DeckGeometryBucketBuffers["pathWorld"]): Arr
     ];
 }
 
+/** Collects transferable buffers for one columnar label bucket; label object arrays are cloned instead. */
+function transferLabelBucket(bucket: DeckGeometryBucketBuffers["labelWorld"]): ArrayBuffer[] {
+    if (Array.isArray(bucket)) {
+        return [];
+    }
+    return [
+        bucket.positions.buffer,
+        bucket.text.buffer,
+        bucket.textOffsets.buffer,
+        bucket.fillColors.buffer,
+        bucket.outlineColors.buffer,
+        bucket.outlineWidths.buffer,
+        bucket.scales.buffer,
+        bucket.pixelOffsets.buffer,
+        bucket.flags.buffer,
+        bucket.featureAddresses.buffer
+    ];
+}
+
 /** Collects transferable buffers for one packed GLTF-node bucket. */
 function transferGltfBucket(bucket: DeckGeometryBucketBuffers["gltfNodes"]): ArrayBuffer[] {
     return [
@@ -187,7 +318,10 @@ function transferGeometryBuffers(buffers: DeckGeometryBucketBuffers): ArrayBuffe
     return [
         ...transferPointBucket(buffers.pointWorld),
         ...transferPointBucket(buffers.pointBillboard),
+        ...transferLabelBucket(buffers.labelWorld),
+        ...transferLabelBucket(buffers.labelBillboard),
         ...transferSurfaceBucket(buffers.surface),
+        ...transferMeshBucket(buffers.mesh),
         ...transferPathBucket(buffers.pathWorld),
         ...transferPathBucket(buffers.pathBillboard),
         ...transferPathBucket(buffers.arrowWorld),
@@ -197,23 +331,58 @@ function transferGeometryBuffers(buffers: DeckGeometryBucketBuffers): ArrayBuffe
     ];
 }
 
-/** Flattens every transferable array buffer from the full worker render result, including low-fi bundles. */
+/**
+ * Flattens every transferable array buffer from the full worker render result, including low-fi bundles.
+ * Arena-backed results share one buffer across all views, so duplicates are dropped.
+ */
 function transferVisualizationResult(result: DeckVisualizationBufferResult): ArrayBuffer[] {
     const lowFiTransfers: ArrayBuffer[] = [];
     for (const bundle of result.lowFiBundles) {
         lowFiTransfers.push(...transferGeometryBuffers(bundle));
     }
-    return [
+    return [...new Set([
         ...transferGeometryBuffers(result),
         result.coordinateOrigin.buffer,
         ...lowFiTransfers
-    ];
+    ])];
+}
+
+/**
+ * Rebuilds the bucketed result shape from an arena descriptor table. The arena is copied out of
+ * the wasm heap with a single `slice()`; every typed array is a view into that copy.
+ */
+function unpackArenaRenderResult(arenaResult: DeckArenaRenderResult): DeckVisualizationBufferResult {
+    const start = arenaResult.arenaPointer;
+    const arena = (coreLib as ErdblickCore_).HEAPU8.slice(start, start + arenaResult.arenaByteLength).buffer;
+    const aggregate: Record<string, any> = {};
+    if (arenaResult.labelWorld && arenaResult.labelBillboard) {
+        aggregate["labelWorld"] = arenaResult.labelWorld;
+        aggregate["labelBillboard"] = arenaResult.labelBillboard;
+    }
+    const bundles = new Map<number, Record<string, any>>();
+    for (const bundle of arenaResult.lowFiBundles) {
+        bundles.set(bundle.lod, {...bundle});
+    }
+    for (const descriptor of arenaResult.buffers) {
+        const target = descriptor.lod < 0 ? aggregate : bundles.get(descriptor.lod);
+        if (!target) {
+            continue;
+        }
+        const bucket = target[descriptor.bucket] ?? (target[descriptor.bucket] = {});
+        bucket[descriptor.field] = new ARENA_VIEW_CTORS[descriptor.type](arena, descriptor.byteOffset, descriptor.length);
+    }
+    return {
+        ...(aggregate as DeckGeometryBucketBuffers),
+        coordinateOrigin: arenaResult.coordinateOrigin,
+        lowFiBundles: [...bundles.values()] as DeckLowFiBundleBuffers[],
+        mergedPointFeatures: arenaResult.mergedPointFeatures
+    };
 }
 
 /** Reads runtime style validation issues from a render result. */
 function readRuntimeStyleIssues(
     deckVisu: DeckFeatureLayerVisualization,
-    task: DeckTileRenderTask
+    task: StyleIssueContext
 ): StyleValidationIssue[] {
     const rawIssues = typeof (deckVisu as any).runtimeStyleIssues === "function"
         ? ((deckVisu as any).runtimeStyleIssues() as StyleValidationIssue[])
@@ -234,36 +403,164 @@ function readRuntimeStyleIssues(
 /** Reads the binary render result from the wasm visualization wrapper. */
 function readRenderResult(
     deckVisu: DeckFeatureLayerVisualization,
-    task: DeckTileRenderTask
+    task: StyleIssueContext
 ): DeckVisualizationBufferResult {
-    const renderResult = (deckVisu as DeckFeatureLayerVisualizationWithRenderResult).renderResult();
+    const visu = deckVisu as DeckFeatureLayerVisualizationWithRenderResult;
+    // Prefer the packed arena: one heap copy instead of one typed-array copy per buffer.
+    const renderResult = typeof visu.renderResultArena === "function"
+        ? unpackArenaRenderResult(visu.renderResultArena())
+        : visu.renderResult();
     return {
         ...renderResult,
         styleIssues: readRuntimeStyleIssues(deckVisu, task)
     };
 }
 
+/** Resolves after pending messages, such as cancellations, had a chance to be handled. */
+function yieldToEventLoop(): Promise<void> {
+    return new Promise((resolve) => {
+        yieldChannel.port1.onmessage = () => resolve();
+        yieldChannel.port2.postMessage(null);
+    });
+}
+
+/**
+ * Runs the visualization in time slices, yielding between them. Returns false if the task
+ * was cancelled meanwhile, in which case the visualization has already released its buffers.
+ */
+async function runInSlices(deckVisu: DeckFeatureLayerVisualizationWithRenderResult): Promise<boolean> {
+    if (!deckVisu.runFor) {
+        deckVisu.run();
+        return true;
+    }
+    while (deckVisu.runFor(RUN_SLICE_BUDGET_MICROS)) {
+        await yieldToEventLoop();
+        if (activeTaskCancelled) {
+            deckVisu.cancel?.();
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Key of the configuration a visualization is constructed with, or null if the task must not
+ * share one. Consecutive base renders, such as the burst of tiles requested at startup, share
+ * their configuration and are rendered as a batch by one visualization.
+ */
+function batchConfigurationKey(task: DeckTileRenderTask): string | null {
+    if (task.featureIdSubset.length || task.featureAddressSubset) {
+        return null;
+    }
+    return JSON.stringify([
+        task.viewIndex,
+        task.styleOptions,
+        task.highlightModeValue,
+        task.fidelityValue,
+        task.highFidelityStage,
+        task.maxLowFiLod,
+        task.outputMode
+    ]);
+}
+
+/** Applies the output settings shared by all worker visualizations. */
+function configureVisualization(
+    deckVisu: DeckFeatureLayerVisualizationWithRenderResult,
+    outputMode: DeckGeometryOutputMode
+): void {
+    const normalizedOutputMode = [
+        DECK_GEOMETRY_OUTPUT_ALL,
+        DECK_GEOMETRY_OUTPUT_POINTS_ONLY,
+        DECK_GEOMETRY_OUTPUT_NON_POINTS_ONLY
+    ].includes(outputMode)
+        ? outputMode
+        // Guard against stale main-thread enums so the worker still produces a sane full render.
+        : DECK_GEOMETRY_OUTPUT_ALL;
+    deckVisu.setGeometryOutputMode(normalizedOutputMode);
+    deckVisu.setAbiVersion(DECK_WASM_ABI_VERSION);
+    // Tessellate polygons here so SolidPolygonLayer does not run earcut on the main thread.
+    deckVisu.setTriangulateSurfaces?.(true);
+    // Path colors/widths/dashes are constant per path; the layer builder expands them on receipt.
+    deckVisu.setPerPathAttributes?.(true);
+}
+
+/**
+ * Returns the visualization of the previous task if it has the same configuration, so options,
+ * expression scope and rule ids are not set up again. Otherwise constructs a new one.
+ */
+function acquireVisualization(
+    task: DeckTileRenderTask,
+    style: FeatureLayerStyle
+): DeckFeatureLayerVisualizationWithRenderResult {
+    const key = batchConfigurationKey(task);
+    const mergeCountProvider = createMergeCountProvider(task.mergeCountSnapshot);
+    const reusable = reusableVisualization;
+    if (key !== null && reusable && reusable.key === key && reusable.style === style) {
+        reusable.visu.setFeatureMergeService!(mergeCountProvider);
+        return reusable.visu;
+    }
+    if (reusable) {
+        reusable.visu.delete();
+        reusableVisualization = null;
+    }
+
+    const deckCtor = deckFeatureLayerVisualizationCtor();
+    const deckVisu = new deckCtor(
+        task.viewIndex,
+        task.tileKey,
+        style,
+        task.styleOptions,
+        mergeCountProvider,
+        resolveHighlightMode(task.highlightModeValue),
+        resolveFidelity(task.fidelityValue),
+        task.highFidelityStage,
+        task.maxLowFiLod,
+        task.outputMode,
+        task.featureIdSubset
+    ) as DeckFeatureLayerVisualizationWithRenderResult;
+    configureVisualization(deckVisu, task.outputMode);
+    if (task.featureAddressSubset) {
+        // Address subsets let highlight passes jump straight to tile roots without id parsing.
+        deckVisu.setFeatureAddressSubset?.(
+            task.featureAddressSubset.featureAddresses,
+            task.featureAddressSubset.attributeIndices,
+            task.featureAddressSubset.validityIndices
+        );
+    }
+    if (key !== null && deckVisu.resetForNextTile && deckVisu.setFeatureMergeService) {
+        reusableVisualization = {key, style, visu: deckVisu};
+    }
+    return deckVisu;
+}
+
+/**
+ * Hands a visualization back after its task. The batch visualization only drops the tile and
+ * its buffers; it is deleted instead if the task failed, as are all non-batch visualizations.
+ */
+function releaseVisualization(deckVisu: DeckFeatureLayerVisualizationWithRenderResult, finished: boolean): void {
+    if (reusableVisualization?.visu === deckVisu) {
+        if (finished) {
+            deckVisu.resetForNextTile!();
+            return;
+        }
+        reusableVisualization = null;
+    }
+    deckVisu.delete();
+}
+
 /** Executes one full staged tile render inside the worker and returns deck-ready buffers. */
-function processTileRenderTask(task: DeckTileRenderTask): DeckTileRenderResult {
+async function processTileRenderTask(task: DeckTileRenderTask): Promise<DeckTileRenderResult> {
     const totalStart = performance.now();
     let baseLayer: TileFeatureLayer | null = null;
     const overlays: TileFeatureLayer[] = [];
-    let deckVisu: DeckFeatureLayerVisualization | null = null;
+    let deckVisu: DeckFeatureLayerVisualizationWithRenderResult | null = null;
+    let finished = false;
     try {
         const parser = getOrCreateParser(task);
         const style = getOrCreateStyle(task.styleSource);
         const deserializeStart = performance.now();
-        const deserializedLayers: TileFeatureLayer[] = [];
-        for (const tileBlob of task.tileStageBlobs) {
-            const layer = uint8ArrayToWasm((data) => parser.readTileFeatureLayer(data), tileBlob) as TileFeatureLayer | null;
-            if (layer) {
-                deserializedLayers.push(layer);
-            }
-        }
+        const deserializedLayers = deserializeTileLayers(parser, task.tileStageBlobs);
         const deserializeMs = performance.now() - deserializeStart;
-        if (!deserializedLayers.length) {
-            throw new Error("Worker render requested without any deserializable tile layers.");
-        }
         baseLayer = deserializedLayers[0];
         overlays.push(...deserializedLayers.slice(1));
         // Stage fusion happens inside the worker too so the wasm renderer sees the same merged tile view
@@ -271,34 +568,22 @@ function processTileRenderTask(task: DeckTileRenderTask): DeckTileRenderResult {
         attachOverlayChain(baseLayer, overlays);
         const vertexCount = Math.max(0, Math.floor(Number(baseLayer.numVertices())));
 
-        const deckCtor = deckFeatureLayerVisualizationCtor();
-        deckVisu = new deckCtor(
-            task.viewIndex,
-            task.tileKey,
-            style,
-            task.styleOptions,
-            createMergeCountProvider(task.mergeCountSnapshot),
-            resolveHighlightMode(task.highlightModeValue),
-            resolveFidelity(task.fidelityValue),
-            task.highFidelityStage,
-            task.maxLowFiLod,
-            task.outputMode,
-            task.featureIdSubset
-        );
-        const normalizedOutputMode = [
-            DECK_GEOMETRY_OUTPUT_ALL,
-            DECK_GEOMETRY_OUTPUT_POINTS_ONLY,
-            DECK_GEOMETRY_OUTPUT_NON_POINTS_ONLY
-        ].includes(task.outputMode)
-            ? task.outputMode
-            // Guard against stale main-thread enums so the worker still produces a sane full render.
-            : DECK_GEOMETRY_OUTPUT_ALL;
-        deckVisu.setGeometryOutputMode(normalizedOutputMode);
+        deckVisu = acquireVisualization(task, style);
         const renderStart = performance.now();
         deckVisu.addTileFeatureLayer(baseLayer);
-        deckVisu.run();
+        if (!await runInSlices(deckVisu)) {
+            finished = true;
+            return {
+                type: "DeckTileRenderResult",
+                taskId: task.taskId,
+                tileKey: task.tileKey,
+                ...emptyResult(),
+                cancelled: true
+            };
+        }
         const renderResult = readRenderResult(deckVisu, task);
         const renderMs = performance.now() - renderStart;
+        finished = true;
 
         return {
             type: "DeckTileRenderResult",
@@ -314,8 +599,97 @@ function processTileRenderTask(task: DeckTileRenderTask): DeckTileRenderResult {
         };
     } finally {
         if (deckVisu) {
-            deckVisu.delete();
+            releaseVisualization(deckVisu, finished);
+        }
+        for (const overlay of overlays) {
+            overlay.delete();
+        }
+        if (baseLayer) {
+            baseLayer.delete();
+        }
+    }
+}
+
+/**
+ * Renders one tile with several styles in a single feature traversal and returns one result
+ * per style. The joint run is not sliced, so a cancellation only takes effect once it is done.
+ */
+async function processMultiStyleRenderTask(task: DeckMultiStyleRenderTask): Promise<DeckMultiStyleRenderResult> {
+    const totalStart = performance.now();
+    let baseLayer: TileFeatureLayer | null = null;
+    const overlays: TileFeatureLayer[] = [];
+    let multiStyleVisu: DeckMultiStyleVisualization | null = null;
+    try {
+        const parser = getOrCreateParser(task);
+        const styles = task.styles.map(entry => getOrCreateStyle(entry.styleSource));
+        const deserializeStart = performance.now();
+        const deserializedLayers = deserializeTileLayers(parser, task.tileStageBlobs);
+        const deserializeMs = performance.now() - deserializeStart;
+        baseLayer = deserializedLayers[0];
+        overlays.push(...deserializedLayers.slice(1));
+        attachOverlayChain(baseLayer, overlays);
+        const vertexCount = Math.max(0, Math.floor(Number(baseLayer.numVertices())));
+
+        // Rule ids carry the style name, so the snapshots of the styles never share a key.
+        const mergeCountSnapshot: Record<string, number> = {};
+        for (const entry of task.styles) {
+            Object.assign(mergeCountSnapshot, entry.mergeCountSnapshot);
         }
+        const multiStyleCtor = deckMultiStyleVisualizationCtor();
+        multiStyleVisu = new multiStyleCtor(
+            task.viewIndex,
+            task.tileKey,
+            styles,
+            task.styles.map(entry => entry.styleOptions),
+            createMergeCountProvider(mergeCountSnapshot),
+            resolveHighlightMode(task.highlightModeValue),
+            resolveFidelity(task.fidelityValue),
+            task.highFidelityStage,
+            task.maxLowFiLod,
+            task.outputMode
+        );
+        // The per-style visualizations are owned by the multi-style one and must not be deleted.
+        const visualizations = task.styles.map((_, index) =>
+            multiStyleVisu!.visualization(index) as DeckFeatureLayerVisualizationWithRenderResult);
+        for (const deckVisu of visualizations) {
+            configureVisualization(deckVisu, task.outputMode);
+        }
+
+        const renderStart = performance.now();
+        multiStyleVisu.addTileFeatureLayer(baseLayer);
+        multiStyleVisu.run();
+        if (activeTaskCancelled) {
+            return {
+                type: "DeckMultiStyleRenderResult",
+                taskId: task.taskId,
+                results: task.styles.map(entry => ({
+                    type: "DeckTileRenderResult",
+                    taskId: entry.taskId,
+                    tileKey: task.tileKey,
+                    ...emptyResult(),
+                    cancelled: true
+                }))
+            };
+        }
+        const renderResults = visualizations.map((deckVisu, index) =>
+            readRenderResult(deckVisu, {...task, ...task.styles[index]}));
+        const renderMs = performance.now() - renderStart;
+        const totalMs = performance.now() - totalStart;
+
+        return {
+            type: "DeckMultiStyleRenderResult",
+            taskId: task.taskId,
+            results: renderResults.map((renderResult, index): DeckTileRenderResult => ({
+                type: "DeckTileRenderResult",
+                taskId: task.styles[index].taskId,
+                tileKey: task.tileKey,
+                vertexCount,
+                ...renderResult,
+                timings: {deserializeMs, renderMs, totalMs}
+            }))
+        };
+    } finally {
+        multiStyleVisu?.delete();
         for (const overlay of overlays) {
             overlay.delete();
         }
@@ -331,6 +705,15 @@ function emptyGeometryBuffers(): DeckGeometryBucketBuffers {
         pointWorld: {positions: new Float32Array(), colors: new Uint8Array(), radii: new Float32Array(), featureAddresses: new Uint32Array()},
         pointBillboard: {positions: new Float32Array(), colors: new Uint8Array(), radii: new Float32Array(), featureAddresses: new Uint32Array()},
         surface: {positions: new Float32Array(), startIndices: new Uint32Array(), colors: new Uint8Array(), featureAddresses: new Uint32Array()},
+        mesh: {
+            positions: new Float32Array(),
+            startIndices: new Uint32Array(),
+            indices: new Uint32Array(),
+            indexStartIndices: new Uint32Array(),
+            colors: new Uint8Array(),
+            depthTests: new Uint8Array(),
+            featureAddresses: new Uint32Array()
+        },
         pathWorld: {
             positions: new Float32Array(),
             startIndices: new Uint32Array(),
@@ -395,7 +778,10 @@ function toErrorMessage(error: unknown): string {
     return String(error);
 }
 
-/** Worker entry point: initialize on handshake, otherwise render one tile task and transfer its buffers. */
+/**
+ * Worker entry point: initialize on handshake, flag cancellations of the running task,
+ * otherwise render one tile task, with one or several styles, and transfer its buffers.
+ */
 addEventListener("message", async ({data}) => {
     const message = data as DeckWorkerInboundMessage;
 
@@ -407,11 +793,48 @@ addEventListener("message", async ({data}) => {
         return;
     }
 
+    if (message.type === "DeckCancelTask") {
+        // Cancellations for tasks which already finished are stale and ignored.
+        if (message.taskId === activeTaskId) {
+            activeTaskCancelled = true;
+        }
+        return;
+    }
+
+    if (message.type === "DeckMultiStyleRenderTask") {
+        activeTaskId = message.taskId;
+        activeTaskCancelled = false;
+        try {
+            await initializeLibrary();
+            const result = await processMultiStyleRenderTask(message);
+            const transfers = new Set(result.results.flatMap(entry => transferVisualizationResult(entry)));
+            postMessage(result, [...transfers]);
+        } catch (error) {
+            const failure: DeckMultiStyleRenderResult = {
+                type: "DeckMultiStyleRenderResult",
+                taskId: message.taskId,
+                results: message.styles.map(entry => ({
+                    type: "DeckTileRenderResult",
+                    taskId: entry.taskId,
+                    tileKey: message.tileKey,
+                    ...emptyResult(),
+                    error: toErrorMessage(error)
+                }))
+            };
+            postMessage(failure);
+        } finally {
+            activeTaskId = null;
+        }
+        return;
+    }
+
     const task = message as DeckTileRenderTask;
+    activeTaskId = task.taskId;
+    activeTaskCancelled = false;
     try {
         // `initializeLibrary()` is idempotent; awaiting it here keeps the worker bootstrap simple.
         await initializeLibrary();
-        const result = processTileRenderTask(task);
+        const result = await processTileRenderTask(task);
         postMessage(result, transferVisualizationResult(result));
     } catch (error) {
         const failure: DeckTileRenderResult = {
@@ -422,5 +845,7 @@ addEventListener("message", async ({data}) => {
             error: toErrorMessage(error)
         };
         postMessage(failure);
+    } finally {
+        activeTaskId = null;
     }
 });
@@ -26,9 +26,14 @@ import {
     DeckGltfBucketBuffers,
     DeckGltfPickProxyBucketBuffers,
     DeckGeometryBucketBuffers,
+    DECK_LABEL_FLAG_DEPTH_TEST,
+    DECK_LABEL_FLAG_PIXEL_OFFSET,
+    DeckFeatureAddressSubset,
+    DeckLabelBucket,
     DeckLabelDatum,
     DeckGeometryOutputMode,
     DeckLowFiBundleBuffers,
+    DeckMeshBucketBuffers,
     DeckPathBucketBuffers,
     DeckPointBucketBuffers,
     DeckSurfaceBucketBuffers,
@@ -54,6 +59,7 @@ interface StyleWithIsDeleted extends FeatureLayerStyle {
     isDeleted(): boolean;
     hasExplicitLowFidelityRules(): boolean;
     hasRelationRules(mode: HighlightMode): boolean;
+    optionAffectsHighlightMode?(optionId: string, mode: HighlightMode): boolean;
 }
 
 /** Deck-scene subset consumed by tile visualizations when they need the registry or scene mode. */
@@ -72,6 +78,13 @@ interface MergeCountProvider {
         level: number,
         mapViewLayerStyleRuleId: string
     ) => number;
+    countBatch: (
+        level: number,
+        mapViewLayerStyleRuleIds: string[],
+        ruleSlots: Uint32Array,
+        geoPositions: Float64Array,
+        cells: Float64Array
+    ) => Int32Array;
 }
 
 type DeckFeatureAddressBuffer = Uint32Array | Array<number | null>;
@@ -128,12 +141,16 @@ interface DeckPointLayerData {
 interface DeckSurfaceLayerData {
     length: number;
     depthTest: boolean;
+    /** Set for indexed meshes, which get their own layer next to the polygon surfaces. */
+    mesh?: boolean;
     coordinateOrigin: [number, number, number];
     startIndices: Uint32Array;
     featureAddresses: DeckFeatureAddressBuffer;
     attributes: {
         getPolygon: DeckBinaryAttribute<Float32Array>;
         fillColors: DeckBinaryAttribute<Uint8Array>;
+        /** Pre-computed triangulation; lets deck skip its own polygon tessellation. */
+        indices?: Uint32Array;
     };
 }
 
@@ -216,6 +233,8 @@ interface DeckSurfaceRawBuffers {
     colors: Uint8Array;
     depthTests?: Uint8Array;
     featureAddresses: Uint32Array;
+    indices?: Uint32Array;
+    indexStartIndices?: Uint32Array;
 }
 
 /** Raw GLTF-node buffers read back from wasm before they are regrouped for deck consumption. */
@@ -259,6 +278,9 @@ const MAX_DECK_SURFACE_COUNT = 1_000_000;
 const MAX_DECK_VERTEX_COUNT = 20_000_000;
 const MAX_DECK_POINT_COUNT = 10_000_000;
 const DECK_UNSELECTABLE_FEATURE_INDEX = 0xffffffff;
+/** Address-subset index selecting a whole feature or attribute (`kWholeSubsetEntry` in wasm). */
+const WHOLE_SUBSET_ENTRY = 0xffffffff;
+const DECK_LABEL_TEXT_DECODER = new TextDecoder();
 const RENDER_RANK_PRIORITY_SWITCH_ONLY = 0;
 const RENDER_RANK_PRIORITY_NEVER_RENDERED_WITH_DATA = 1;
 const RENDER_RANK_PRIORITY_DEFAULT = 2;
@@ -366,11 +388,13 @@ export class DeckTileVisualization implements ITileVisualization {
     private readonly highlightMode: HighlightMode;
     private readonly featureIdSubset: string[];
     private readonly options: Record<string, boolean | number | string>;
+    private readonly optionAffectsRenderCache = new Map<string, boolean>();
     private readonly styleHasExplicitLowFidelityRules: boolean;
     private readonly styleHasRelationRules: boolean;
     private readonly relationExternalTileLoader: (requests: RelationLocateRequest[]) => Promise<RelationLocateResult>;
     private renderQueued = false;
     private deleted = false;
+    private workerRenderAbort: AbortController | null = null;
     private rendered = false;
     private readonly surfaceLayerKeys = new Set<string>();
     private readonly pointLayerKeys = new Set<string>();
@@ -837,7 +861,12 @@ export class DeckTileVisualization implements ITileVisualization {
                     continue;
                 }
                 const layerKeys = this.resolveLayerKeys(
-                    this.composeGeometryVariant(entry.variantSuffix, "surface", undefined, surfaceLayerData.depthTest)
+                    this.composeGeometryVariant(
+                        entry.variantSuffix,
+                        surfaceLayerData.mesh ? "mesh" : "surface",
+                        undefined,
+                        surfaceLayerData.depthTest
+                    )
                 );
                 const surfaceLayer = new SolidPolygonLayer<DeckSurfaceLayerData, DeckPickLayerMetadata>({
                     id: layerKeys.surfaceLayerKey,
@@ -1437,6 +1466,7 @@ export class DeckTileVisualization implements ITileVisualization {
     /** Removes all deck layers and merged-point state owned by this visualization. */
     destroy(sceneHandle: IRenderSceneHandle): void {
         this.deleted = true;
+        this.workerRenderAbort?.abort();
         const registry = this.resolveRegistry(sceneHandle);
         for (const affectedCornerTile of this.pointMergeService.remove(
             this.tile.tileId,
@@ -1524,13 +1554,37 @@ export class DeckTileVisualization implements ITileVisualization {
         }
     }
 
-    /** Applies a style option change locally; deck renderers currently treat every option update as dirty. */
+    /**
+     * Applies a style option change locally. Returns false if the value is unchanged,
+     * or if no rule of this visualization's highlight pass reads the option.
+     */
     setStyleOption(optionId: string, value: string | number | boolean): boolean {
         if (this.options[optionId] === value) {
             return false;
         }
         this.options[optionId] = value;
-        return true;
+        return this.optionAffectsRender(optionId);
+    }
+
+    /** Returns whether a rule of this visualization's highlight pass reads the option, cached per option id. */
+    private optionAffectsRender(optionId: string): boolean {
+        let affects = this.optionAffectsRenderCache.get(optionId);
+        if (affects === undefined) {
+            affects = this.style.optionAffectsHighlightMode?.(optionId, this.highlightMode) ?? true;
+            this.optionAffectsRenderCache.set(optionId, affects);
+        }
+        return affects;
+    }
+
+    /** Returns the option values which can influence the rendered output. */
+    private renderRelevantOptions(): Record<string, boolean | number | string> {
+        const relevant: Record<string, boolean | number | string> = {};
+        for (const [optionId, value] of Object.entries(this.options)) {
+            if (this.optionAffectsRender(optionId)) {
+                relevant[optionId] = value;
+            }
+        }
+        return relevant;
     }
 
     /** Returns a compact highlight-mode label used in deck layer keys. */
@@ -1554,7 +1608,7 @@ export class DeckTileVisualization implements ITileVisualization {
             renderQueued: this.renderQueued,
             highlightMode: this.highlightMode.value,
             featureIdSubset: this.featureIdSubset,
-            styleOptions: this.options
+            styleOptions: this.renderRelevantOptions()
         });
     }
 
@@ -1583,6 +1637,10 @@ export class DeckTileVisualization implements ITileVisualization {
             const workerOutput = await this.renderWasmInWorker(fidelity, DECK_GEOMETRY_OUTPUT_ALL);
             return this.applyWasmRenderOutput(workerOutput);
         } catch (error) {
+            if (this.deleted) {
+                // The worker task was cancelled because this tile went away.
+                return [];
+            }
             console.error("Deck worker rendering failed; falling back to main thread rendering.", error);
             const fullMainThread = await this.renderWasmOnMainThread(fidelity, DECK_GEOMETRY_OUTPUT_ALL);
             return this.applyWasmRenderOutput(fullMainThread);
@@ -1625,6 +1683,8 @@ export class DeckTileVisualization implements ITileVisualization {
             throw new Error("Worker render requested without tile data blobs.");
         }
         const pool = deckRenderWorkerPool();
+        const abortController = new AbortController();
+        this.workerRenderAbort = abortController;
         const result = await pool.renderTile({
             viewIndex: this.viewIndex,
             tileKey: this.tile.mapTileKey,
@@ -1642,12 +1702,16 @@ export class DeckTileVisualization implements ITileVisualization {
             highFidelityStage: this.resolvedHighFidelityStage(),
             maxLowFiLod: this.resolveMaxLowFiLod(fidelity),
             outputMode,
-            featureIdSubset: [...this.featureIdSubset],
+            ...this.featureSubsetForRender(),
             mergeCountSnapshot: this.pointMergeService.makeMergeCountSnapshot(
                 this.tile.tileId,
                 this.mapViewLayerStyleId(),
                 this.tile.mapTileKey
             )
+        }, abortController.signal).finally(() => {
+            if (this.workerRenderAbort === abortController) {
+                this.workerRenderAbort = null;
+            }
         });
         const geometryLayerData = this.buildGeometryLayerData(result.coordinateOrigin, result);
         return {
@@ -1676,6 +1740,7 @@ export class DeckTileVisualization implements ITileVisualization {
         outputMode: DeckGeometryOutputMode
     ): DeckFeatureLayerVisualization {
         const deckCtor = deckFeatureLayerVisualizationCtor();
+        const {featureIdSubset, featureAddressSubset} = this.featureSubsetForRender();
         const mergeCountProvider: MergeCountProvider = {
             count: (geoPos, hashPos, level, mapViewLayerStyleRuleId) => this.pointMergeService.count(
                 geoPos,
@@ -1683,9 +1748,22 @@ export class DeckTileVisualization implements ITileVisualization {
                 level,
                 mapViewLayerStyleRuleId,
                 this.tile.mapTileKey
-            )
+            ),
+            countBatch: (level, mapViewLayerStyleRuleIds, ruleSlots, geoPositions, cells) => {
+                const counts = new Int32Array(ruleSlots.length);
+                for (let i = 0; i < ruleSlots.length; i++) {
+                    counts[i] = this.pointMergeService.count(
+                        {x: geoPositions[i * 3], y: geoPositions[i * 3 + 1], z: geoPositions[i * 3 + 2]},
+                        `${cells[i * 3]}:${cells[i * 3 + 1]}:${cells[i * 3 + 2]}`,
+                        level,
+                        mapViewLayerStyleRuleIds[ruleSlots[i]],
+                        this.tile.mapTileKey
+                    );
+                }
+                return counts;
+            }
         };
-        return new deckCtor(
+        const deckVisu = new deckCtor(
             this.viewIndex,
             this.tile.mapTileKey,
             this.style,
@@ -1696,8 +1774,49 @@ export class DeckTileVisualization implements ITileVisualization {
             this.resolvedHighFidelityStage(),
             this.resolveMaxLowFiLod(fidelity),
             this.mapGeometryOutputModeForWasm(outputMode),
-            this.featureIdSubset
+            featureIdSubset
         );
+        if (featureAddressSubset) {
+            deckVisu.setFeatureAddressSubset(
+                featureAddressSubset.featureAddresses,
+                featureAddressSubset.attributeIndices,
+                featureAddressSubset.validityIndices
+            );
+        }
+        return deckVisu;
+    }
+
+    /**
+     * Returns the highlight subset in the form the wasm renderer consumes. Ids are translated to
+     * tile addresses, which picked features already have cached, so the renderer skips id parsing.
+     * Address entries only describe whole features and attributes, so the ids are kept as they
+     * are if any of them is a relation hover id or does not resolve in this tile.
+     */
+    private featureSubsetForRender(): {featureIdSubset: string[], featureAddressSubset?: DeckFeatureAddressSubset} {
+        if (!this.featureIdSubset.length) {
+            return {featureIdSubset: []};
+        }
+        const addresses: number[] = [];
+        const attributeIndices: number[] = [];
+        const validityIndices: number[] = [];
+        for (const featureId of this.featureIdSubset) {
+            const address = featureId.includes(":relation#") ? null : this.tile.featureAddressById(featureId);
+            if (address === null) {
+                return {featureIdSubset: [...this.featureIdSubset]};
+            }
+            const attributeMatch = /:attribute#(\d+)(?::validity#(\d+))?$/.exec(featureId);
+            addresses.push(address);
+            attributeIndices.push(attributeMatch ? Number(attributeMatch[1]) : WHOLE_SUBSET_ENTRY);
+            validityIndices.push(attributeMatch?.[2] !== undefined ? Number(attributeMatch[2]) : WHOLE_SUBSET_ENTRY);
+        }
+        return {
+            featureIdSubset: [],
+            featureAddressSubset: {
+                featureAddresses: Uint32Array.from(addresses),
+                attributeIndices: Uint32Array.from(attributeIndices),
+                validityIndices: Uint32Array.from(validityIndices)
+            }
+        };
     }
 
     /** Adds the primary tile to a wasm visualization and runs it on the main thread. */
@@ -1818,10 +1937,13 @@ export class DeckTileVisualization implements ITileVisualization {
         | "gltfPickProxyLayerData"
     > {
         return {
-            surfaceLayerData: this.buildSurfaceLayerData({
-                coordinateOrigin,
-                ...geometry.surface
-            }),
+            surfaceLayerData: [
+                ...this.buildSurfaceLayerData({
+                    coordinateOrigin,
+                    ...geometry.surface
+                }),
+                ...this.buildMeshLayerData(coordinateOrigin, geometry.mesh)
+            ],
             pathLayerData: this.buildCombinedPathLayerData(
                 coordinateOrigin,
                 geometry.pathWorld,
@@ -2005,15 +2127,60 @@ export class DeckTileVisualization implements ITileVisualization {
     /** Builds label-layer data for both world-space and billboard label buckets. */
     private buildCombinedLabelLayerData(
         coordinateOrigin: Float64Array,
-        worldRaw: DeckLabelDatum[],
-        billboardRaw: DeckLabelDatum[]
+        worldRaw: DeckLabelBucket | undefined,
+        billboardRaw: DeckLabelBucket | undefined
     ): DeckLabelLayerData[] {
         return [
-            ...this.buildLabelLayerData(coordinateOrigin, worldRaw, false),
-            ...this.buildLabelLayerData(coordinateOrigin, billboardRaw, true)
+            ...this.buildLabelLayerData(coordinateOrigin, this.labelDatumsFromBucket(worldRaw, false), false),
+            ...this.buildLabelLayerData(coordinateOrigin, this.labelDatumsFromBucket(billboardRaw, true), true)
         ];
     }
 
+    /** Expands columnar ABI v2 label buffers into label datums; ABI v1 label arrays pass through. */
+    private labelDatumsFromBucket(raw: DeckLabelBucket | undefined, billboard: boolean): DeckLabelDatum[] {
+        if (!raw) {
+            return [];
+        }
+        if (Array.isArray(raw)) {
+            return raw;
+        }
+        const count = raw.featureAddresses.length;
+        if (raw.textOffsets.length < count + 1 || raw.positions.length < count * 3) {
+            return [];
+        }
+        const result: DeckLabelDatum[] = new Array(count);
+        for (let i = 0; i < count; i++) {
+            const flags = raw.flags[i];
+            const colorBase = i * 4;
+            const datum: DeckLabelDatum = {
+                featureAddress: raw.featureAddresses[i],
+                position: {x: raw.positions[i * 3], y: raw.positions[i * 3 + 1], z: raw.positions[i * 3 + 2]},
+                text: DECK_LABEL_TEXT_DECODER.decode(raw.text.subarray(raw.textOffsets[i], raw.textOffsets[i + 1])),
+                fillColor: [
+                    raw.fillColors[colorBase],
+                    raw.fillColors[colorBase + 1],
+                    raw.fillColors[colorBase + 2],
+                    raw.fillColors[colorBase + 3]
+                ],
+                outlineColor: [
+                    raw.outlineColors[colorBase],
+                    raw.outlineColors[colorBase + 1],
+                    raw.outlineColors[colorBase + 2],
+                    raw.outlineColors[colorBase + 3]
+                ],
+                outlineWidth: raw.outlineWidths[i],
+                scale: raw.scales[i],
+                billboard,
+                depthTest: (flags & DECK_LABEL_FLAG_DEPTH_TEST) !== 0
+            };
+            if (flags & DECK_LABEL_FLAG_PIXEL_OFFSET) {
+                datum.pixelOffset = [raw.pixelOffsets[i * 2], raw.pixelOffsets[i * 2 + 1]];
+            }
+            result[i] = datum;
+        }
+        return result;
+    }
+
     /** Extracts the meter-offset coordinate origin tuple from raw wasm output. */
     private coordinateOriginFromRaw(raw: Float64Array): [number, number, number] | null {
         if (raw.length < 3) {
@@ -2046,13 +2213,16 @@ export class DeckTileVisualization implements ITileVisualization {
         if (raw.positions.length < vertexCount * 3) {
             return [];
         }
-        if (raw.colors.length < vertexCount * 4 || raw.widths.length < vertexCount || raw.featureAddresses.length < pathCount) {
+        // Workers may store colors, widths and dashes once per path; expand them per vertex here.
+        const perPathAttributes = raw.colors.length === pathCount * 4 && raw.widths.length === pathCount;
+        const attributeCount = perPathAttributes ? pathCount : vertexCount;
+        if (raw.colors.length < attributeCount * 4 || raw.widths.length < attributeCount || raw.featureAddresses.length < pathCount) {
             return [];
         }
         if (raw.depthTests && raw.depthTests.length < pathCount) {
             return [];
         }
-        if (raw.dashArrays && raw.dashArrays.length < vertexCount * 2) {
+        if (raw.dashArrays && raw.dashArrays.length < attributeCount * 2) {
             return [];
         }
         if (raw.startIndices[0] !== 0) {
@@ -2075,7 +2245,7 @@ export class DeckTileVisualization implements ITileVisualization {
             featureAddresses: number[];
             dashArrays?: number[];
         }>();
-        const dashArraysPresent = !!raw.dashArrays && raw.dashArrays.length >= vertexCount * 2;
+        const dashArraysPresent = !!raw.dashArrays && raw.dashArrays.length >= attributeCount * 2;
 
         for (let pathIndex = 0; pathIndex < pathCount; pathIndex++) {
             const depthTest = !raw.depthTests || raw.depthTests[pathIndex] !== 0;
@@ -2102,16 +2272,17 @@ export class DeckTileVisualization implements ITileVisualization {
                     raw.positions[pathOffset + 1],
                     raw.positions[pathOffset + 2]
                 );
-                const colorOffset = vertexIndex * 4;
+                const attributeIndex = perPathAttributes ? pathIndex : vertexIndex;
+                const colorOffset = attributeIndex * 4;
                 group.colors.push(
                     raw.colors[colorOffset],
                     raw.colors[colorOffset + 1],
                     raw.colors[colorOffset + 2],
                     raw.colors[colorOffset + 3]
                 );
-                group.widths.push(raw.widths[vertexIndex]);
+                group.widths.push(raw.widths[attributeIndex]);
                 if (group.dashArrays && raw.dashArrays) {
-                    const dashOffset = vertexIndex * 2;
+                    const dashOffset = attributeIndex * 2;
                     group.dashArrays.push(raw.dashArrays[dashOffset], raw.dashArrays[dashOffset + 1]);
                 }
             }
@@ -2186,12 +2357,34 @@ export class DeckTileVisualization implements ITileVisualization {
             }
         }
 
+        // Surfaces triangulated in wasm carry local triangle indices. Malformed index
+        // buffers fall back to deck's own tessellation instead of dropping the surfaces.
+        const triangleIndices = raw.indices ?? new Uint32Array();
+        const indexStarts = raw.indexStartIndices ?? new Uint32Array();
+        let triangulated = indexStarts.length === surfaceCount + 1 && indexStarts[0] === 0;
+        for (let surfaceIndex = 0; triangulated && surfaceIndex < surfaceCount; surfaceIndex++) {
+            const surfaceVertexCount = raw.startIndices[surfaceIndex + 1] - raw.startIndices[surfaceIndex];
+            const indexStart = indexStarts[surfaceIndex];
+            const indexEnd = indexStarts[surfaceIndex + 1];
+            if (indexEnd < indexStart || indexEnd > triangleIndices.length || (indexEnd - indexStart) % 3 !== 0) {
+                triangulated = false;
+                break;
+            }
+            for (let index = indexStart; index < indexEnd; index++) {
+                if (triangleIndices[index] >= surfaceVertexCount) {
+                    triangulated = false;
+                    break;
+                }
+            }
+        }
+
         const groups = new Map<boolean, {
             positions: number[];
             startIndices: number[];
             colors: number[];
             depthTests: number[];
             featureAddresses: number[];
+            indices: number[];
         }>();
 
         for (let surfaceIndex = 0; surfaceIndex < surfaceCount; surfaceIndex++) {
@@ -2203,13 +2396,21 @@ export class DeckTileVisualization implements ITileVisualization {
                     startIndices: [0],
                     colors: [],
                     depthTests: [],
-                    featureAddresses: []
+                    featureAddresses: [],
+                    indices: []
                 };
                 groups.set(depthTest, group);
             }
 
             const startVertex = raw.startIndices[surfaceIndex];
             const endVertex = raw.startIndices[surfaceIndex + 1];
+            if (triangulated) {
+                // Deck expects indices into the whole group, so rebase onto the group's vertex count.
+                const groupVertexBase = group.positions.length / 3;
+                for (let index = indexStarts[surfaceIndex]; index < indexStarts[surfaceIndex + 1]; index++) {
+                    group.indices.push(groupVertexBase + triangleIndices[index]);
+                }
+            }
             for (let vertexIndex = startVertex; vertexIndex < endVertex; vertexIndex++) {
                 const positionOffset = vertexIndex * 3;
                 group.positions.push(
@@ -2243,7 +2444,118 @@ export class DeckTileVisualization implements ITileVisualization {
                 featureAddresses: new Uint32Array(group.featureAddresses),
                 attributes: {
                     getPolygon: {value: new Float32Array(group.positions), size: 3},
-                    fillColors: {value: new Uint8Array(group.colors), size: 4}
+                    fillColors: {value: new Uint8Array(group.colors), size: 4},
+                    ...(triangulated ? {indices: new Uint32Array(group.indices)} : {})
+                }
+            }];
+        });
+    }
+
+    /**
+     * Expands indexed mesh buffers into pre-triangulated polygon-layer payloads grouped by depth-test state.
+     * Per-mesh colors are widened to the per-vertex colors the surface layer expects.
+     */
+    private buildMeshLayerData(
+        coordinateOriginRaw: Float64Array,
+        raw: DeckMeshBucketBuffers | undefined
+    ): DeckSurfaceLayerData[] {
+        if (!raw || raw.startIndices.length < 2) {
+            return [];
+        }
+        const coordinateOrigin = this.coordinateOriginFromRaw(coordinateOriginRaw);
+        if (!coordinateOrigin) {
+            return [];
+        }
+
+        const meshCount = raw.startIndices.length - 1;
+        if (meshCount > MAX_DECK_SURFACE_COUNT || raw.indexStartIndices.length !== meshCount + 1) {
+            return [];
+        }
+        const vertexCount = raw.startIndices[meshCount];
+        if (vertexCount > MAX_DECK_VERTEX_COUNT
+            || raw.positions.length < vertexCount * 3
+            || raw.indices.length < raw.indexStartIndices[meshCount]
+            || raw.colors.length < meshCount * 4
+            || raw.featureAddresses.length < meshCount) {
+            return [];
+        }
+        if (raw.depthTests && raw.depthTests.length < meshCount) {
+            return [];
+        }
+
+        const groups = new Map<boolean, {
+            positions: number[];
+            startIndices: number[];
+            colors: number[];
+            featureAddresses: number[];
+            indices: number[];
+        }>();
+
+        for (let meshIndex = 0; meshIndex < meshCount; meshIndex++) {
+            const startVertex = raw.startIndices[meshIndex];
+            const endVertex = raw.startIndices[meshIndex + 1];
+            const startIndex = raw.indexStartIndices[meshIndex];
+            const endIndex = raw.indexStartIndices[meshIndex + 1];
+            if (endVertex < startVertex || endIndex < startIndex || (endIndex - startIndex) % 3 !== 0) {
+                continue;
+            }
+            let validIndices = true;
+            for (let index = startIndex; index < endIndex; index++) {
+                if (raw.indices[index] >= endVertex - startVertex) {
+                    validIndices = false;
+                    break;
+                }
+            }
+            if (!validIndices) {
+                continue;
+            }
+
+            const depthTest = !raw.depthTests || raw.depthTests[meshIndex] !== 0;
+            let group = groups.get(depthTest);
+            if (!group) {
+                group = {positions: [], startIndices: [0], colors: [], featureAddresses: [], indices: []};
+                groups.set(depthTest, group);
+            }
+
+            const groupVertexBase = group.positions.length / 3;
+            for (let index = startIndex; index < endIndex; index++) {
+                group.indices.push(groupVertexBase + raw.indices[index]);
+            }
+            const colorOffset = meshIndex * 4;
+            for (let vertexIndex = startVertex; vertexIndex < endVertex; vertexIndex++) {
+                const positionOffset = vertexIndex * 3;
+                group.positions.push(
+                    raw.positions[positionOffset],
+                    raw.positions[positionOffset + 1],
+                    raw.positions[positionOffset + 2]
+                );
+                group.colors.push(
+                    raw.colors[colorOffset],
+                    raw.colors[colorOffset + 1],
+                    raw.colors[colorOffset + 2],
+                    raw.colors[colorOffset + 3]
+                );
+            }
+            group.featureAddresses.push(raw.featureAddresses[meshIndex]);
+            group.startIndices.push(group.positions.length / 3);
+        }
+
+        return [true, false].flatMap((depthTest) => {
+            const group = groups.get(depthTest);
+            if (!group || group.featureAddresses.length <= 0) {
+                return [];
+            }
+            return [{
+                length: group.featureAddresses.length,
+                depthTest,
+                mesh: true,
+                coordinateOrigin,
+                startIndices: new Uint32Array(group.startIndices),
+                featureAddresses: new Uint32Array(group.featureAddresses),
+                attributes: {
+                    getPolygon: {value: new Float32Array(group.positions), size: 3},
+                    fillColors: {value: new Uint8Array(group.colors), size: 4},
+                    indices: new Uint32Array(group.indices)
                 }
             }];
         });
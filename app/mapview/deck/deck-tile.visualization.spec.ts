@@ -51,6 +51,15 @@ function emptyRenderResult(): any {
             colors: new Uint8Array(),
             featureAddresses: new Uint32Array()
         },
+        mesh: {
+            positions: new Float32Array(),
+            startIndices: new Uint32Array([0]),
+            indices: new Uint32Array(),
+            indexStartIndices: new Uint32Array([0]),
+            colors: new Uint8Array(),
+            depthTests: new Uint8Array(),
+            featureAddresses: new Uint32Array()
+        },
         pathWorld: {
             positions: new Float32Array(),
             startIndices: new Uint32Array([0]),
@@ -909,6 +918,57 @@ describe("DeckTileVisualization", () => {
         ]);
     });
 
+    it("expands per-path line style buffers to every vertex", () => {
+        const tile = {
+            mapTileKey: "Island-6-Local/Lane/42",
+            layerName: "Lane",
+            tileId: 42n,
+            hasData: () => true,
+            stats: new Map<string, number[]>()
+        } as any;
+        const visu = new DeckTileVisualization(
+            0,
+            tile,
+            new PointMergeService(),
+            makeStyle(),
+            "",
+            1,
+            true,
+            null,
+            {value: 0} as any
+        ) as any;
+
+        const pathData = visu.buildPathLayerData({
+            coordinateOrigin: new Float64Array([11, 48, 0]),
+            positions: new Float32Array([
+                11, 48, 0,
+                11.001, 48.001, 0,
+                11.002, 48.002, 0,
+                11.01, 48.01, 0,
+                11.02, 48.02, 0
+            ]),
+            startIndices: new Uint32Array([0, 3, 5]),
+            colors: new Uint8Array([255, 228, 181, 255, 1, 2, 3, 4]),
+            widths: new Float32Array([3, 7]),
+            featureAddresses: new Uint32Array([101, 202]),
+            dashArrays: new Float32Array([6, 2, 1, 0])
+        }, false);
+
+        expect(pathData).toHaveLength(1);
+        expect(Array.from(pathData[0].attributes.instanceColors.value)).toEqual([
+            255, 228, 181, 255,
+            255, 228, 181, 255,
+            255, 228, 181, 255,
+            1, 2, 3, 4,
+            1, 2, 3, 4
+        ]);
+        expect(Array.from(pathData[0].attributes.instanceStrokeWidths.value)).toEqual([3, 3, 3, 7, 7]);
+        expect(Array.from(pathData[0].attributes.instanceDashArrays.value)).toEqual([
+            6, 2, 6, 2, 6, 2,
+            1, 0, 1, 0
+        ]);
+    });
+
     it("derives screen-space arrow markers from arrow path data", () => {
         const tile = {
             mapTileKey: "Island-6-Local/Lane/42",
@@ -1051,6 +1111,111 @@ describe("DeckTileVisualization", () => {
         expect(visu.hasPendingLowFiSwitch()).toBe(true);
     });
 
+    it("sends highlight subsets as tile feature addresses", () => {
+        const addressesById: Record<string, number> = {"Lane.1": 4, "Lane.2": 7};
+        const tile = {
+            mapTileKey: "Island-6-Local/Lane/42",
+            layerName: "Lane",
+            tileId: 42n,
+            numFeatures: 8,
+            hasData: () => true,
+            highestLoadedStage: () => 0,
+            featureAddressById: vi.fn((featureId: string) =>
+                addressesById[featureId.split(/:attribute#|:relation#/)[0]] ?? null),
+            stats: new Map<string, number[]>()
+        } as any;
+        const makeVisu = (featureIdSubset: string[]) => new DeckTileVisualization(
+            0,
+            tile,
+            new PointMergeService(),
+            makeStyle(),
+            "",
+            0,
+            false,
+            null,
+            {value: 1} as any,
+            featureIdSubset
+        ) as any;
+
+        const subset = makeVisu(["Lane.1", "Lane.2:attribute#3:validity#1"]).featureSubsetForRender();
+        expect(subset.featureIdSubset).toEqual([]);
+        expect(Array.from(subset.featureAddressSubset.featureAddresses)).toEqual([4, 7]);
+        expect(Array.from(subset.featureAddressSubset.attributeIndices)).toEqual([0xffffffff, 3]);
+        expect(Array.from(subset.featureAddressSubset.validityIndices)).toEqual([0xffffffff, 1]);
+
+        // An unresolved id keeps all ids, so it is neither dropped nor widened to the whole tile.
+        expect(makeVisu(["Lane.1", "Lane.9"]).featureSubsetForRender())
+            .toEqual({featureIdSubset: ["Lane.1", "Lane.9"]});
+        expect(makeVisu(["Lane.9"]).featureSubsetForRender()).toEqual({featureIdSubset: ["Lane.9"]});
+    });
+
+    it("keeps relation hover ids on the id subset path", () => {
+        const tile = {
+            mapTileKey: "Island-6-Local/Lane/42",
+            layerName: "Lane",
+            tileId: 42n,
+            numFeatures: 8,
+            hasData: () => true,
+            highestLoadedStage: () => 0,
+            featureAddressById: vi.fn().mockReturnValue(4),
+            stats: new Map<string, number[]>()
+        } as any;
+        const visu = new DeckTileVisualization(
+            0,
+            tile,
+            new PointMergeService(),
+            makeStyle(),
+            "",
+            0,
+            false,
+            null,
+            {value: 1} as any,
+            ["Lane.1:relation#2"]
+        ) as any;
+
+        // A whole-feature address entry would highlight the host feature instead of the relation.
+        const subset = visu.featureSubsetForRender();
+        expect(subset).toEqual({featureIdSubset: ["Lane.1:relation#2"]});
+        expect(subset.featureAddressSubset).toBeUndefined();
+        expect(tile.featureAddressById).not.toHaveBeenCalled();
+    });
+
+    it("ignores style option changes which no rule of its highlight pass reads", () => {
+        const tile = {
+            mapTileKey: "Island-6-Local/Lane/42",
+            layerName: "Lane",
+            tileId: 42n,
+            numFeatures: 1,
+            hasData: () => true,
+            highestLoadedStage: () => 0,
+            stats: new Map<string, number[]>()
+        } as any;
+        const optionAffectsHighlightMode = vi.fn((optionId: string) => optionId === "showWays");
+        const style = makeStyle({optionAffectsHighlightMode});
+        const visu = new DeckTileVisualization(
+            0,
+            tile,
+            new PointMergeService(),
+            style,
+            "",
+            0,
+            false,
+            null,
+            {value: 0} as any,
+            [],
+            "",
+            false,
+            {showWays: true, showHoverLabels: false}
+        ) as any;
+        const signature = visu.renderSignature();
+
+        expect(visu.setStyleOption("showHoverLabels", true)).toBe(false);
+        expect(visu.renderSignature()).toBe(signature);
+        expect(visu.setStyleOption("showWays", false)).toBe(true);
+        expect(visu.renderSignature()).not.toBe(signature);
+        expect(optionAffectsHighlightMode).toHaveBeenCalledTimes(2);
+    });
+
     it("does not apply a cached low-fi switch when the requested selection is empty", async () => {
         const deck = new DeckStub();
         const registry = new DeckLayerRegistry(deck);
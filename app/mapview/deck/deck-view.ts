@@ -519,14 +519,29 @@ export abstract class DeckMapView implements IRenderView {
         const objectFeatureAddresses = pickedObject?.featureAddresses ?? pickedObject?.featureAddress;
         if (objectFeatureAddresses !== undefined && objectFeatureAddresses !== null) {
             if (Array.isArray(objectFeatureAddresses)) {
-                return objectFeatureAddresses
-                    .map((value, index) => {
-                        const featureTileKey = typeof objectFeatureTileKeys?.[index] === "string"
-                            ? objectFeatureTileKeys[index] as string
-                            : objectTileKey;
-                        return resolveFeatureAddress(featureTileKey, value);
-                    })
-                    .filter((value): value is TileFeatureId => value !== null);
+                // Merged points carry many addresses, so resolve them with one batch lookup per tile.
+                const resolved: (TileFeatureId | null)[] = new Array(objectFeatureAddresses.length).fill(null);
+                const slotsByTileKey = new Map<string, {slots: number[]; addresses: number[]}>();
+                objectFeatureAddresses.forEach((value, index) => {
+                    const featureTileKey = typeof objectFeatureTileKeys?.[index] === "string"
+                        ? objectFeatureTileKeys[index] as string
+                        : objectTileKey;
+                    if (!featureTileKey || !Number.isInteger(value)) {
+                        return;
+                    }
+                    let tileSlots = slotsByTileKey.get(featureTileKey);
+                    if (!tileSlots) {
+                        tileSlots = {slots: [], addresses: []};
+                        slotsByTileKey.set(featureTileKey, tileSlots);
+                    }
+                    tileSlots.slots.push(index);
+                    tileSlots.addresses.push(value as number);
+                });
+                for (const [featureTileKey, tileSlots] of slotsByTileKey) {
+                    this.mapService.resolveTileFeatureIdsByAddresses(featureTileKey, tileSlots.addresses)
+                        .forEach((tileFeatureId, i) => resolved[tileSlots.slots[i]] = tileFeatureId);
+                }
+                return resolved.filter((value): value is TileFeatureId => value !== null);
             }
             const resolved = resolveFeatureAddress(objectTileKey, objectFeatureAddresses);
             return resolved ? [resolved] : [];
@@ -36,6 +36,8 @@ const completionsList = [
     {label: 'offset', type: 'property'},
     {label: 'vertical-offset', type: 'property'},
     {label: 'offset-increment', type: 'property'},
+    {label: 'simplify-tolerance', type: 'property'},
+    {label: 'simplify-preserve-topology', type: 'property'},
     {label: 'arrow', type: 'property'},
     {label: 'dashed', type: 'property'},
     {label: 'gap-color', type: 'property'},
@@ -1,3 +1,5 @@
+#pragma once
+
 #include "mapget/model/featurelayer.h"
 #include "glm/glm.hpp"
 
@@ -39,6 +41,9 @@ m::Point geometryCenter(m::SelfContainedGeometry const& g);
  */
 m::Point boundingRadiusEndPoint(m::SelfContainedGeometry const& g);
 
+/** Same as above, for callers which already know the `geometryCenter()` of `g`. */
+m::Point boundingRadiusEndPoint(m::SelfContainedGeometry const& g, m::Point const& center);
+
 /**
  * Calculate a local WGS84 coordinate system for the geometry.
  * The axes are scaled, such that each represents approx. 1m
@@ -58,4 +63,25 @@ m::SelfContainedGeometry offsetGeometryLocally(
     mapget::SelfContainedGeometry const& g,
     glm::dvec3 const& localOffsetMeters);
 
+/**
+ * Simplify a projected polyline or polygon ring with Douglas-Peucker, measuring the
+ * deviation in the x/y plane in projected units. End points, and for closed rings the
+ * vertex furthest from the first one, are always kept. With `preserveTopology`, the
+ * tolerance is halved until the result has no self-intersections; the input is returned
+ * unchanged if no such result is found.
+ */
+std::vector<m::Point> simplifyProjectedPolyline(
+    std::vector<m::Point> const& points,
+    double tolerance,
+    bool closed,
+    bool preserveTopology);
+
+/**
+ * Triangulate a simple polygon ring by ear clipping. The ring is triangulated in the
+ * coordinate plane most perpendicular to its normal, so steep surfaces are supported.
+ * Returns three indices into `ring` per triangle; a repeated closing vertex is never
+ * referenced. Degenerate rings yield no triangles.
+ */
+std::vector<uint32_t> triangulatePolygon(std::vector<m::Point> const& ring);
+
 }  // namespace erdblick
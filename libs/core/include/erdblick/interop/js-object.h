@@ -28,9 +28,10 @@ struct always_false : std::false_type {};
  * or a mock object based on an nlohmann::json value 
  * for debugging or compiling without emscripten support.
  *
- * The mock object has two JSON fields:
+ * The mock object has the following JSON fields:
  * - `properties` is a dict recording all field accesses.
  * - `methodCalls` is a list containing dicts like {`methodName`: ..., `arguments`: [...]}.
+ * - `mockResults` is an optional dict of canned return values by method name.
  */
 struct JsValue
 {
@@ -132,7 +133,8 @@ struct JsValue
     /**
      * Templated method for making arbitrary method calls.
      * For EMSCRIPTEN, it will utilize the value_.call<ReturnType>(Args...) function.
-     * For the mock version, it will add the method call to `methodCalls` and return an empty Object.
+     * For the mock version, it will add the method call to `methodCalls` and return the
+     * method's entry in `mockResults`, or a default-constructed value.
      */
     template<typename ReturnType=NativeJsValue, typename... Args>
     ReturnType call(std::string const& methodName, Args... args);
@@ -180,6 +182,11 @@ struct JsValue
      */
     std::vector<std::uint8_t> toUint8Array() const;
 
+    /**
+     * Get this value (a Uint32Array or list of numbers) as vector<uint32_t>.
+     */
+    std::vector<std::uint32_t> toUint32Array() const;
+
     /**
      * Convert this JsValue to string representation.
      */
@@ -237,6 +244,12 @@ ReturnType JsValue::call(std::string const& methodName, Args... args)
         {"methodName", methodName},
         {"arguments", {UnpackNativeValue(args)...}} // This assumes Args are convertible to nlohmann::json
     });
+    if constexpr (!std::is_void_v<ReturnType>) {
+        auto const results = value_.find("mockResults");
+        if (results != value_.end() && results->is_object() && results->contains(methodName)) {
+            return (*results)[methodName].template get<ReturnType>();
+        }
+    }
     return ReturnType(); // default-constructed value
 #endif
 }
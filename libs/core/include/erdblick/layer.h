@@ -9,6 +9,22 @@
 namespace erdblick
 {
 
+/** Focus geometry facts of one feature, all in WGS84. */
+struct FeatureGeometrySummary
+{
+    /** Focus and search-result position of the feature. */
+    mapget::Point center;
+    /** Point furthest from `center`, used for bounding-sphere camera framing. */
+    mapget::Point boundingRadiusEndPoint;
+};
+
+/**
+ * Summarize the geometry focus and search helpers use for a feature: the first geometry at
+ * the preferred stage, or else the first geometry at all. AABB and GLTF-node geometries use
+ * their box center and far corner. Features without geometry yield a zero summary.
+ */
+FeatureGeometrySummary summarizeFeatureGeometry(mapget::model_ptr<mapget::Feature>& feature);
+
 /** Wrapper class around the mapget `TileFeatureLayer` smart pointer. */
 struct TileFeatureLayer
 {
@@ -89,6 +105,13 @@ struct TileFeatureLayer
      */
     int32_t findFeatureIndex(std::string type, NativeJsValue idParts) const;
 
+    /**
+     * Finds the tile-local address of a feature by its ID string.
+     * @param id The ID of the feature to find.
+     * @return The address of the feature, or `-1` if not found.
+     */
+    int32_t featureAddressById(std::string const& id) const;
+
     /**
      * Retrieves the feature ID string for a feature address.
      * @param address Tile-local address of the feature.
@@ -103,11 +126,40 @@ struct TileFeatureLayer
      */
     mapget::model_ptr<mapget::Feature> featureByAddress(uint32_t address) const;
 
+    /**
+     * Retrieves the feature ID strings for many feature addresses in one call.
+     * @param addresses Uint32Array (or number list) of tile-local feature addresses.
+     * @return List of feature ID strings, with empty strings for unknown addresses.
+     */
+    NativeJsValue featureIdsByAddresses(NativeJsValue const& addresses) const;
+
+    /**
+     * Retrieves the geometry summary of a feature. Summaries are computed on first request
+     * and cached in a per-tile table shared by all copies of this wrapper.
+     * @param address Tile-local address of the feature.
+     * @return Summary of the feature, or a zero summary if the address is out of range.
+     */
+    FeatureGeometrySummary const& geometrySummary(uint32_t address) const;
+
+    /** Retrieves the cached center of a feature, see `geometrySummary()`. */
+    mapget::Point featureCenter(uint32_t address) const;
+
+    /** Retrieves the cached bounding-radius end point of a feature, see `geometrySummary()`. */
+    mapget::Point featureBoundingRadiusEndPoint(uint32_t address) const;
+
     /** Release the wrapped smart pointer. */
     ~TileFeatureLayer();
 
     /** Shared pointer to the underlying `mapget::TileFeatureLayer`. */
     mapget::TileFeatureLayer::Ptr model_;
+
+    /** Lazily filled geometry summaries, indexed by feature address. */
+    struct GeometrySummaryTable
+    {
+        std::vector<FeatureGeometrySummary> summaries;
+        std::vector<bool> computed;
+    };
+    std::shared_ptr<GeometrySummaryTable> geometrySummaries_ = std::make_shared<GeometrySummaryTable>();
 };
 
 /** Wrapper class around the mapget `TileSourceDataLayer` smart pointer. */
@@ -70,10 +70,25 @@ public:
         DoubleArrow
     };
 
-    /** Return this rule when it matches the feature and current evaluation context. */
-    FeatureStyleRule const* match(mapget::Feature& feature, BoundEvalFun const& evalFun) const;
+    /**
+     * Return this rule (or the first matching `first-of` sub-rule) when it matches the
+     * feature and current evaluation context. If `typeMatches` is given, it must point to
+     * this rule's entry of a table built by `collectTypeMatches` for the feature's type,
+     * and the type regexes are not evaluated again.
+     */
+    FeatureStyleRule const* match(
+        mapget::Feature& feature,
+        BoundEvalFun const& evalFun,
+        uint8_t const* typeMatches = nullptr) const;
     /** Cheap type prefilter used before building a full evaluation context. */
     [[nodiscard]] bool maybeMatchesType(std::string_view typeId) const;
+    /**
+     * Append the type regex outcome of this rule and all nested `first-of` sub-rules
+     * (pre-order, one entry each) for the given feature type.
+     */
+    void collectTypeMatches(std::string_view typeId, std::vector<uint8_t>& typeMatches) const;
+    /** Number of entries `collectTypeMatches` appends for this rule. */
+    [[nodiscard]] uint32_t typeMatchCount() const;
     /** Return the rule's target aspect. */
     [[nodiscard]] Aspect aspect() const;
     /** Return the highlight pass this rule belongs to. */
@@ -127,6 +142,12 @@ public:
     [[nodiscard]] glm::dvec3 const& offsetIncrement() const;
     /** Return the optional point-merge grid cell size for feature aggregation. */
     [[nodiscard]] std::optional<glm::dvec3> const& pointMergeGridCellSize() const;
+    /** Report whether the rule or one of its first-of sub-rules merges points. */
+    [[nodiscard]] bool mergesPoints() const;
+    /** Return the low-fidelity line/polygon simplification tolerance in pixels; 0 disables it. */
+    [[nodiscard]] float simplifyTolerance() const;
+    /** Report whether low-fidelity simplification must not introduce self-intersections. */
+    [[nodiscard]] bool simplifyPreserveTopology() const;
 
     /** Report whether the rule can resolve an icon URL. */
     [[nodiscard]] bool hasIconUrl() const;
@@ -191,6 +212,15 @@ public:
     /** Return an optional eye-space XYZ offset for labels. */
     [[nodiscard]] std::optional<std::tuple<float, float, float>> const& labelEyeOffset() const;
 
+    /** Return the `first-of` sub-rules, empty if this is a plain rule. */
+    [[nodiscard]] std::vector<FeatureStyleRule> const& firstOfRules() const;
+
+    /**
+     * Visit every simfil expression this rule may evaluate, including those of
+     * its relation sub-styles and `first-of` sub-rules.
+     */
+    void forEachExpression(std::function<void(std::string const&)> const& callback) const;
+
     /** Return the stable index of this rule inside its style sheet. */
     [[nodiscard]] uint32_t const& index() const;
 
@@ -231,6 +261,8 @@ private:
     glm::dvec3 offset_{.0, .0, .0};
     glm::dvec3 offsetIncrement_{.0, .0, .0};
     std::optional<glm::dvec3> pointMergeGridCellSize_;
+    float simplifyTolerance_ = 1.;
+    bool simplifyPreserveTopology_ = false;
 
     // Labels' rules
     std::string labelFont_ = "24px Helvetica";
@@ -266,6 +298,7 @@ private:
     std::optional<std::regex> attributeLayerType_;
     std::optional<bool> attributeValidityGeometry_;
     std::vector<FeatureStyleRule> firstOfRules_;
+    uint32_t typeMatchCount_ = 1;
 
     // Index of the rule within the style sheet
     uint32_t index_ = 0;
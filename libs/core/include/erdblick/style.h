@@ -5,8 +5,13 @@
 #include "rule.h"
 #include "interop/js-object.h"
 #include "style-validation.h"
+#include "simfil/environment.h"
+#include "simfil/expression.h"
 
 #include <array>
+#include <list>
+#include <map>
+#include <memory>
 #include <string_view>
 #include <unordered_map>
 #include <regex>
@@ -61,6 +66,31 @@ struct FeatureStyleOption
     }
 };
 
+/**
+ * Compiled simfil expressions of one style, shared by all visualizations that render
+ * tiles with the same field dictionary and option values.
+ *
+ * Compiled ASTs embed string ids, so the visualizations of a scope also share one copy
+ * of the field dictionary. A scope is replaced once its source dictionary has grown past
+ * the snapshot it was copied from; visualizations holding the old scope keep using it.
+ */
+struct StyleExpressionScope
+{
+    /** Cached parsed simfil expression and its optional constant-folded result. */
+    struct CachedExpression {
+        simfil::ASTPtr ast_;
+        std::optional<simfil::Value> constantValue_;
+        bool constantResolved_ = false;
+        std::string compileError_;
+    };
+
+    std::weak_ptr<simfil::StringPool> sourceStrings_;
+    size_t sourceHighestStringId_ = 0;
+    std::shared_ptr<simfil::StringPool> strings_;
+    std::unique_ptr<simfil::Environment> environment_;
+    std::map<std::string, CachedExpression, std::less<>> expressions_;
+};
+
 /**
  * Parsed feature-layer style sheet containing rules, options, and quick lookup caches.
  *
@@ -96,6 +126,18 @@ public:
     [[nodiscard]] bool hasExplicitLowFidelityRules() const;
     /** Check whether any rule for the given highlight mode targets relations. */
     [[nodiscard]] bool hasRelationRules(FeatureStyleRule::HighlightMode mode) const;
+    /**
+     * Return the ids of the options which an expression looks up by name in its evaluation
+     * context (e.g. `_["option-id"]`). All other option reads compile into constants.
+     */
+    [[nodiscard]] std::vector<std::string> const& contextOptionIds() const;
+    /**
+     * Check whether any rule for the given highlight mode reads the option, i.e. whether
+     * changing its value may change the output of that render pass.
+     */
+    [[nodiscard]] bool optionAffectsHighlightMode(
+        std::string const& optionId,
+        FeatureStyleRule::HighlightMode mode) const;
     /**
      * Return the candidate rule indices for a feature type in the requested render pass.
      *
@@ -107,16 +149,63 @@ public:
         FeatureStyleRule::Fidelity fidelity,
         std::string_view featureTypeId) const;
 
+    /** Cached type regex outcomes of all rules and their `first-of` sub-rules for one feature type. */
+    struct RuleTypeMatches {
+        std::vector<uint8_t> decisions;
+        std::vector<uint32_t> offsetByRule;
+
+        /** Return the table entry of the rule at `ruleIndex`, as accepted by `FeatureStyleRule::match`. */
+        [[nodiscard]] uint8_t const* forRule(uint32_t ruleIndex) const {
+            return decisions.data() + offsetByRule[ruleIndex];
+        }
+    };
+
+    /**
+     * Return the type regex outcomes of every rule for a feature type, so that
+     * `FeatureStyleRule::match` does not need to evaluate them per feature. The
+     * reference stays valid for the lifetime of the style object.
+     */
+    [[nodiscard]] RuleTypeMatches const& ruleTypeMatches(std::string_view featureTypeId) const;
+
+    /**
+     * Return the shared expression scope for tiles using `sourceStrings` as field
+     * dictionary, rendered with the given option values. Creates or replaces the
+     * scope if there is none yet or the dictionary has grown since.
+     *
+     * Only the `kMaxExpressionScopes` most recently used scopes are cached, and scopes
+     * of expired field dictionaries are dropped, so option edits do not accumulate copies.
+     */
+    [[nodiscard]] std::shared_ptr<StyleExpressionScope> expressionScope(
+        std::shared_ptr<simfil::StringPool> const& sourceStrings,
+        std::map<std::string, simfil::Value> const& optionValues) const;
+    /**
+     * Return a new expression scope which compiles into `strings` itself rather than into a
+     * copy. Several styles rendering one tile jointly use this to share one field dictionary.
+     * The scope is not cached, as its dictionary belongs to the caller.
+     */
+    [[nodiscard]] std::shared_ptr<StyleExpressionScope> expressionScopeForPool(
+        std::shared_ptr<simfil::StringPool> const& strings,
+        std::map<std::string, simfil::Value> const& optionValues) const;
+    /** Return the number of cached expression scopes. */
+    [[nodiscard]] size_t numExpressionScopes() const;
+
+    /** Upper bound of cached expression scopes per style. */
+    static constexpr size_t kMaxExpressionScopes = 8;
+
 private:
     static constexpr size_t kHighlightModeCount = 3;
     static constexpr size_t kFidelityCount = 2;
     using RuleIndexList = std::vector<uint32_t>;
 
-    /** Cached rule-index tables for one concrete feature type. */
+    /** Cached rule-index tables and type decisions for one concrete feature type. */
     struct RuleIndexCacheEntry {
         std::array<std::array<RuleIndexList, kFidelityCount>, kHighlightModeCount> byModeAndFidelity{};
+        RuleTypeMatches typeMatches;
     };
 
+    /** Look up or build the cache entry for one feature type. */
+    RuleIndexCacheEntry const& typeCacheEntry(std::string_view featureTypeId) const;
+
     /** Heterogeneous hash for the feature-type cache. */
     struct TransparentStringHash {
         using is_transparent = void;
@@ -156,8 +245,17 @@ private:
     std::array<std::array<RuleIndexList, kFidelityCount>, kHighlightModeCount> ruleIndicesByModeAndFidelity_{};
     uint32_t highlightModeMask_ = 0;
     bool hasExplicitLowFidelityRules_ = false;
+    std::vector<std::vector<std::string>> optionDependenciesByRule_;
+    std::vector<std::string> contextOptionIds_;
     mutable std::unordered_map<std::string, RuleIndexCacheEntry, TransparentStringHash, TransparentStringEqual>
         ruleIndicesByTypeCache_;
+    /** One cached expression scope and the option values fingerprint it was compiled with. */
+    struct ExpressionScopeEntry {
+        std::string optionsKey_;
+        std::shared_ptr<StyleExpressionScope> scope_;
+    };
+    /** Cached expression scopes, most recently used first. */
+    mutable std::list<ExpressionScopeEntry> expressionScopes_;
 };
 
 }
@@ -120,14 +120,58 @@ public:
         tileLayerParser.setFallbackLayerInfo(layerInfo_);
     }
 
+    /**
+     * Knobs for the synthetic tile generator. The defaults reproduce the small
+     * demo tile; benchmarks scale the counts up to stress specific render paths.
+     */
+    struct SyntheticTileParams
+    {
+        /** Number of `Way` line features, each with a `lane` attribute layer. */
+        uint32_t numWays = 2;
+        /** Number of `Sign` polygon features. */
+        uint32_t numSigns = 2;
+        /** Number of `PointOfInterest` point features. */
+        uint32_t numPois = 5;
+        /** Number of `PointOfNoInterest` point features. */
+        uint32_t numPonis = 5;
+        /** Number of `Diamond` mesh features. The first one sits in the tile center. */
+        uint32_t numDiamonds = 1;
+        /** Inclusive vertex-count range for generated lines. */
+        uint32_t minLinePoints = 2;
+        uint32_t maxLinePoints = 8;
+        /** Inclusive vertex-count range for generated polygons. */
+        uint32_t minPolygonPoints = 2;
+        uint32_t maxPolygonPoints = 6;
+        /** Number of attribute layers added to each `Way`. */
+        uint32_t attributeLayersPerWay = 1;
+        /** Number of attributes added to each of those attribute layers. */
+        uint32_t attributesPerLayer = 1;
+        /** Number of `hasPoi` relations added to each `Diamond`. */
+        uint32_t relationsPerDiamond = 1;
+        /** Random seed; zero seeds from the current time like the demo tile always did. */
+        uint32_t seed = 0;
+        /** Print one line per generated feature. */
+        bool verbose = true;
+    };
+
     /** Generate one synthetic feature tile around the given camera position and tile level. */
     std::shared_ptr<mapget::TileFeatureLayer> getTestLayer(double camX, double camY, uint16_t level)
+    {
+        return getTestLayer(camX, camY, level, SyntheticTileParams{});
+    }
+
+    /** Generate one synthetic feature tile with explicit feature counts and densities. */
+    std::shared_ptr<mapget::TileFeatureLayer> getTestLayer(
+        double camX,
+        double camY,
+        uint16_t level,
+        SyntheticTileParams const& params)
     {
         static const std::vector<std::string> signTypes{"Stop", "Yield", "Parking", "No Entry", "Speed Limit"};
         static const std::vector<std::string> wayTypes{"Bike", "Pedestrian", "Any", "Vehicle"};
 
         // Seed the random number generator for consistency
-        srand(time(nullptr));
+        srand(params.seed ? params.seed : time(nullptr));
 
         auto tileId = mapget::TileId::fromWgs84(camX, camY, level);
 
@@ -150,10 +194,13 @@ public:
         };
 
         // Helper function to generate a random number of points with a given base height
-        auto generateRandomPoints = [&](int minPoints, int maxPoints, const auto& ne, const auto& sw) {
+        auto generateRandomPoints = [&](uint32_t minPoints, uint32_t maxPoints, const auto& ne, const auto& sw) {
             double baseHeight = 1000.0;
             std::vector<mapget::Point> points;
-            int numPoints = minPoints + rand() % (maxPoints - minPoints + 1); // Random number of points between min and max
+            if (maxPoints < minPoints) {
+                maxPoints = minPoints;
+            }
+            uint32_t numPoints = minPoints + rand() % (maxPoints - minPoints + 1); // Random number of points between min and max
             points.reserve(numPoints);
             while (numPoints --> 0) {
                 points.push_back(randomPointBetween(ne, sw, baseHeight));
@@ -161,32 +208,42 @@ public:
             return points;
         };
 
-        // Create 10 random Way features inside the bounding box defined by NE and SW
-        for (int i = 0; i < 2; i++) {
-            std::cout << "Generated Way " << i << std::endl;
+        // Create random Way features inside the bounding box defined by NE and SW
+        for (uint32_t i = 0; i < params.numWays; i++) {
+            if (params.verbose) {
+                std::cout << "Generated Way " << i << std::endl;
+            }
             // Create a feature with line geometry
-            auto feature = result->newFeature("Way", {{"wayId", 42 + i}});
-            auto linePoints = generateRandomPoints(2, 8, tileId.ne(), tileId.sw());
+            auto feature = result->newFeature("Way", {{"wayId", static_cast<int64_t>(42 + i)}});
+            auto linePoints = generateRandomPoints(params.minLinePoints, params.maxLinePoints, tileId.ne(), tileId.sw());
             feature->addLine(linePoints);
 
             // Add a random wayType attribute
             int randomIndex = rand() % wayTypes.size();
             feature->attributes()->addField("wayType", wayTypes[randomIndex]);
 
-            // Add an attribute layer
-            auto attrLayer = feature->attributeLayers()->newLayer("lane");
-            auto attr = attrLayer->newAttribute("numLanes");
-            attr->validity()->newDirection(mapget::Validity::Positive);
-            attr->addField("count", (int64_t)rand());
+            // Add attribute layers. The first one keeps the historic `lane`/`numLanes` shape.
+            for (uint32_t layerIndex = 0; layerIndex < params.attributeLayersPerWay; ++layerIndex) {
+                auto attrLayer = feature->attributeLayers()->newLayer(
+                    layerIndex == 0 ? std::string("lane") : "lane" + std::to_string(layerIndex));
+                for (uint32_t attrIndex = 0; attrIndex < params.attributesPerLayer; ++attrIndex) {
+                    auto attr = attrLayer->newAttribute(
+                        attrIndex == 0 ? std::string("numLanes") : "numLanes" + std::to_string(attrIndex));
+                    attr->validity()->newDirection(mapget::Validity::Positive);
+                    attr->addField("count", (int64_t)rand());
+                }
+            }
         }
 
-        // Create 10 random Sign features inside the bounding box defined by NE and SW
-        for (int i = 0; i < 2; i++) {
-            std::cout << "Generated Sign " << i << std::endl;
+        // Create random Sign features inside the bounding box defined by NE and SW
+        for (uint32_t i = 0; i < params.numSigns; i++) {
+            if (params.verbose) {
+                std::cout << "Generated Sign " << i << std::endl;
+            }
 
             // Create a feature with polygon geometry
-            auto feature = result->newFeature("Sign", {{"signId", 100 + i}});
-            auto polyPoints = generateRandomPoints(2, 6, tileId.ne(), tileId.sw());
+            auto feature = result->newFeature("Sign", {{"signId", static_cast<int64_t>(100 + i)}});
+            auto polyPoints = generateRandomPoints(params.minPolygonPoints, params.maxPolygonPoints, tileId.ne(), tileId.sw());
             feature->addPoly(polyPoints);
 
             // Add a random signType attribute
@@ -195,53 +252,69 @@ public:
         }
 
         // Add some points of interest...
-        for (int i = 0; i < 5; i++) {
-            std::cout << "Generated POI " << i << std::endl;
+        for (uint32_t i = 0; i < params.numPois; i++) {
+            if (params.verbose) {
+                std::cout << "Generated POI " << i << std::endl;
+            }
 
-            auto feature = result->newFeature("PointOfInterest", {{"pointId", 200 + i}});
+            auto feature = result->newFeature("PointOfInterest", {{"pointId", static_cast<int64_t>(200 + i)}});
             auto points = generateRandomPoints(1, 1, tileId.ne(), tileId.sw());
             feature->addPoints(points);
         }
 
         // ...and points of no interest.
-        for (int i = 0; i < 5; i++) {
-            std::cout << "Generated PONI " << i << std::endl;
+        for (uint32_t i = 0; i < params.numPonis; i++) {
+            if (params.verbose) {
+                std::cout << "Generated PONI " << i << std::endl;
+            }
 
-            auto feature = result->newFeature("PointOfNoInterest", {{"pointId", 300 + i}});
+            auto feature = result->newFeature("PointOfNoInterest", {{"pointId", static_cast<int64_t>(300 + i)}});
             auto points = generateRandomPoints(1, 1, tileId.ne(), tileId.sw());
             feature->addPoints(points);
         }
 
-        // Add a diamond mesh in the center of the tile.
-        auto diamondMeshFeature = result->newFeature("Diamond", {{"diamondId", 999}});
-        auto center = tileId.center();
-        auto size = tileId.size();
-        size.x *= .25;
-        size.y *= .25;
-        size.z = 1000.;
-        double baseHeight = 1600.0; // Base height from previous code
-        // Define the vertices of the diamond
-        std::vector<mapget::Point> diamondVertices = {
-            {center.x, center.y - size.y, baseHeight}, // Top front vertex
-            {center.x - size.x, center.y, baseHeight}, // Left vertex
-            {center.x, center.y + size.y, baseHeight}, // Bottom front vertex
-            {center.x + size.x, center.y, baseHeight}, // Right vertex
-            {center.x, center.y, baseHeight + size.z}, // Top apex (center top vertex)
-            {center.x, center.y, baseHeight - size.z}  // Bottom apex (center bottom vertex)
-        };
-        // Form triangles for the 3D diamond
-        std::vector<mapget::Point> diamondTriangles = {
-            diamondVertices[4], diamondVertices[0], diamondVertices[1], // Top front-left triangle
-            diamondVertices[4], diamondVertices[1], diamondVertices[2], // Top left-right triangle
-            diamondVertices[4], diamondVertices[2], diamondVertices[3], // Top right-bottom triangle
-            diamondVertices[4], diamondVertices[3], diamondVertices[0], // Top bottom-front triangle
-            diamondVertices[5], diamondVertices[1], diamondVertices[0], // Bottom left-front triangle
-            diamondVertices[5], diamondVertices[2], diamondVertices[1], // Bottom right-left triangle
-            diamondVertices[5], diamondVertices[3], diamondVertices[2], // Bottom bottom-right triangle
-            diamondVertices[5], diamondVertices[0], diamondVertices[3]  // Bottom front-bottom triangle
-        };
-        diamondMeshFeature->addMesh(diamondTriangles);
-        diamondMeshFeature->addRelation("hasPoi", "PointOfInterest", {{"areaId", "TheBestArea"}, {"pointId", 200}});
+        // Add diamond meshes. The first one sits in the center of the tile,
+        // additional ones are scattered across the tile at a smaller size.
+        for (uint32_t i = 0; i < params.numDiamonds; i++) {
+            auto diamondMeshFeature = result->newFeature("Diamond", {{"diamondId", static_cast<int64_t>(999 + i)}});
+            auto center = i == 0 ? tileId.center() : randomPointBetween(tileId.ne(), tileId.sw(), 0.);
+            auto size = tileId.size();
+            auto const sizeFactor = i == 0 ? .25 : .025;
+            size.x *= sizeFactor;
+            size.y *= sizeFactor;
+            size.z = 1000.;
+            double baseHeight = 1600.0; // Base height from previous code
+            // Define the vertices of the diamond
+            std::vector<mapget::Point> diamondVertices = {
+                {center.x, center.y - size.y, baseHeight}, // Top front vertex
+                {center.x - size.x, center.y, baseHeight}, // Left vertex
+                {center.x, center.y + size.y, baseHeight}, // Bottom front vertex
+                {center.x + size.x, center.y, baseHeight}, // Right vertex
+                {center.x, center.y, baseHeight + size.z}, // Top apex (center top vertex)
+                {center.x, center.y, baseHeight - size.z}  // Bottom apex (center bottom vertex)
+            };
+            // Form triangles for the 3D diamond
+            std::vector<mapget::Point> diamondTriangles = {
+                diamondVertices[4], diamondVertices[0], diamondVertices[1], // Top front-left triangle
+                diamondVertices[4], diamondVertices[1], diamondVertices[2], // Top left-right triangle
+                diamondVertices[4], diamondVertices[2], diamondVertices[3], // Top right-bottom triangle
+                diamondVertices[4], diamondVertices[3], diamondVertices[0], // Top bottom-front triangle
+                diamondVertices[5], diamondVertices[1], diamondVertices[0], // Bottom left-front triangle
+                diamondVertices[5], diamondVertices[2], diamondVertices[1], // Bottom right-left triangle
+                diamondVertices[5], diamondVertices[3], diamondVertices[2], // Bottom bottom-right triangle
+                diamondVertices[5], diamondVertices[0], diamondVertices[3]  // Bottom front-bottom triangle
+            };
+            diamondMeshFeature->addMesh(diamondTriangles);
+
+            // Relations point at POIs round-robin, so targets exist as long as POIs were generated.
+            for (uint32_t r = 0; r < params.relationsPerDiamond; ++r) {
+                auto const targetPoiId = 200 + (params.numPois ? (i + r) % params.numPois : r);
+                diamondMeshFeature->addRelation(
+                    "hasPoi",
+                    "PointOfInterest",
+                    {{"areaId", "TheBestArea"}, {"pointId", static_cast<int64_t>(targetPoiId)}});
+            }
+        }
 
         return result;
     }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <functional>
 #include <cstdint>
 #include <deque>
@@ -8,6 +9,7 @@
 #include <memory>
 #include <optional>
 #include <set>
+#include <span>
 #include <string>
 #include <string_view>
 #include <unordered_map>
@@ -56,14 +58,66 @@ public:
         NativeJsValue const& rawFeatureMergeService = {});
     /** Release cached evaluation state and deferred relation bookkeeping. */
     virtual ~FeatureLayerVisualizationBase();
+    /** Parallel-array entry selecting a whole feature or attribute in an address subset. */
+    static constexpr uint32_t kWholeSubsetEntry = 0xffffffffu;
+
     /** Add one parsed tile to the visualization input set. */
     void addTileFeatureLayer(TileFeatureLayer const& tile);
+    /**
+     * Use `strings` as field dictionary instead of a private copy of the first tile's one.
+     * Visualizations rendering the same tile jointly must share it, as the tile model can
+     * only point at one dictionary. Takes effect when the next first tile is added.
+     */
+    void setSharedStringPool(std::shared_ptr<simfil::StringPool> strings);
+    /**
+     * Restrict rendering to features addressed by their tile address instead of by id.
+     * Attribute and validity indices are optional parallel Uint32Arrays, where
+     * kWholeSubsetEntry selects the whole feature or attribute. Replaces any
+     * feature id subset passed to the constructor.
+     */
+    void setFeatureAddressSubset(
+        NativeJsValue const& featureAddresses,
+        NativeJsValue const& attributeIndices = {},
+        NativeJsValue const& validityIndices = {});
+    /**
+     * Restrict a full-tile run to the root features with addresses in [begin, end). Used to
+     * split one tile into shards which are rendered independently; subsets take precedence.
+     */
+    void setFeatureAddressRange(uint32_t begin, uint32_t end);
     /** Execute the style sheet against all queued tiles and emit renderer-specific geometry. */
     virtual void run();
+    /**
+     * Time-sliced variant of `run()`: start a pass unless one is pending, then render features
+     * until about `budgetMicros` have elapsed. Returns true while features remain; the next call
+     * resumes after the last rendered feature, keeping relation and merged-point state.
+     */
+    bool runFor(double budgetMicros);
+    /**
+     * Run several visualizations of the same tile, typically with different styles, in one
+     * feature traversal: each feature is looked up once and the candidate rules of every
+     * visualization are dispatched on it, sharing the feature's geometry type mask. Each
+     * visualization keeps its own evaluation context, as contexts carry the style's options.
+     * Visualizations with a feature subset, another tile or another address range, or with a
+     * pending `runFor()` pass fall back to their own `run()`.
+     */
+    static void runJointly(std::vector<FeatureLayerVisualizationBase*> const& visualizations);
+    /** Abandon a pending `runFor()` pass and release everything emitted so far. */
+    virtual void cancel();
+    /**
+     * Forget all added tiles and their results, so that the next `addTileFeatureLayer()`
+     * starts another tile. Parsed options, feature subsets, the shared expression scope and
+     * the rule-id table are kept, which makes rendering a batch of tiles with one style
+     * configuration cheaper than constructing a visualization per tile.
+     */
+    virtual void resetForNextTile();
+    /** Replace the point-merge count provider, e.g. with the snapshot of the next batch tile. */
+    void setFeatureMergeService(NativeJsValue const& rawFeatureMergeService);
     /** Return unresolved cross-tile relation references for frontend-assisted resolution. */
     [[nodiscard]] NativeJsValue externalRelationReferences() const;
     /** Feed resolved external relation targets back into pending relation visualizations. */
     void processResolvedExternalReferences(NativeJsValue const& resolvedReferences);
+    /** Return how many relation-target lookups since the last tile needed the per-tile fallback. */
+    [[nodiscard]] size_t numFeatureIdLookupFallbacks() const;
     /** Return structured runtime style evaluation issues collected during rendering. */
     [[nodiscard]] NativeJsValue runtimeStyleIssues() const;
 
@@ -133,20 +187,86 @@ protected:
         std::unordered_map<uint32_t, std::unordered_set<uint32_t>> hoveredValidityIndicesByAttribute_;
     };
 
+    /**
+     * Packed grid cell of a merged point. The x/y/z cell indices are wrapped into
+     * 22/22/20 bits, which is collision-free as long as a tile spans fewer than
+     * 2^20 cells per axis.
+     */
+    using GridCellKey = uint64_t;
+
+    /** One grid cell of point-merged features for a single style rule. */
+    struct MergedPointCell {
+        std::array<int64_t, 3> cell_{0, 0, 0};
+        mapget::Point position_;
+        std::vector<uint32_t> featureAddresses_;
+        std::optional<int32_t> externalCount_;
+        JsValue parameters_;
+    };
+
+    /** All merged-point cells of one style rule, in first-seen order. */
+    struct MergedPointRule {
+        std::vector<MergedPointCell> cells_;
+        std::unordered_map<GridCellKey, uint32_t> cellIndexByKey_;
+        std::unordered_map<GridCellKey, int32_t> prefetchedCounts_;
+    };
+
+    /** String ids of the synthetic fields set on evaluation contexts. */
+    struct ContextFieldIds {
+        simfil::StringId mergeCount_ = 0;
+        simfil::StringId name_ = 0;
+        simfil::StringId feature_ = 0;
+        simfil::StringId layer_ = 0;
+        simfil::StringId validityIndex_ = 0;
+        simfil::StringId validityCount_ = 0;
+        simfil::StringId source_ = 0;
+        simfil::StringId target_ = 0;
+        simfil::StringId twoway_ = 0;
+    };
+
+    /**
+     * Which rules a pass renders when a tile is split into shards (see `runShards()`).
+     * Relation rules and merged points depend on the features rendered before, so one
+     * sequential pass over the whole tile renders them, and the shards render the rest.
+     */
+    enum class SequentialRules : uint8_t {
+        Render = 0,
+        Skip = 1,
+        Only = 2,
+    };
+
     static constexpr uint32_t kUnselectableFeatureId = std::numeric_limits<uint32_t>::max();
 
     /** Convert a WGS84 point into the coordinate space expected by the concrete renderer. */
     virtual mapget::Point projectWgsPoint(
         mapget::Point const& wgsPoint) const = 0;
+    /**
+     * Convert a run of WGS84 points, appending the results to `projected`. The default
+     * projects point by point; renderers override it to hoist per-tile constants.
+     */
+    virtual void projectWgsPoints(
+        std::span<mapget::Point const> wgsPoints,
+        std::vector<mapget::Point>& projected) const;
+    /**
+     * Size of one screen pixel in projected units at the tile's native zoom level.
+     * Low-fidelity line and polygon simplification is disabled while this is 0.
+     */
+    [[nodiscard]] virtual double projectedUnitsPerPixel() const;
+    /** Simplify projected line or polygon vertices of a low-fidelity pass by the rule's tolerance. */
+    void simplifyForLowFidelity(
+        std::vector<mapget::Point>& vertsProjected,
+        FeatureStyleRule const& rule,
+        bool closed) const;
 
     /** Build the stable frontend id for geometry emitted by one style rule. */
     virtual std::string makeMapLayerStyleRuleId(uint32_t ruleIndex) const;
+    /** Look up the rule id precomputed for the first tile; empty for unknown indices. */
+    [[nodiscard]] std::string_view mapLayerStyleRuleId(uint32_t ruleIndex) const;
     /** Entry point for relation-style rules before relation traversal begins. */
     virtual void onRelationStyle(
         mapget::model_ptr<mapget::Feature>& feature,
         BoundEvalFun& evalFun,
         FeatureStyleRule const& rule,
-        std::string const& mapLayerStyleRuleId);
+        std::string_view mapLayerStyleRuleId);
     /** Called once per feature before any style-rule evaluation for that feature. */
     virtual void onFeatureForRendering(mapget::Feature const& feature);
     /** Allow derived visualizations to bypass the shared low-fi LOD suppression. */
@@ -198,6 +318,29 @@ protected:
         FeatureStyleRule const& rule,
         uint32_t tileFeatureId,
         BoundEvalFun& evalFun);
+    /**
+     * Typed counterparts of `emitPoint`/`emitIcon`/`emitLabel` which receive the
+     * projected position natively. The base implementations wrap the position as
+     * JsValue and forward to the overloads above; native backends override these.
+     */
+    virtual void emitPoint(
+        mapget::Point const& xyzPos,
+        FeatureStyleRule const& rule,
+        uint32_t tileFeatureId,
+        BoundEvalFun& evalFun);
+    /** Emit one icon anchor from a native projected position. */
+    virtual void emitIcon(
+        mapget::Point const& xyzPos,
+        FeatureStyleRule const& rule,
+        uint32_t tileFeatureId,
+        BoundEvalFun& evalFun);
+    /** Emit one label from a native projected position. */
+    virtual void emitLabel(
+        mapget::Point const& xyzPos,
+        std::string const& text,
+        FeatureStyleRule const& rule,
+        uint32_t tileFeatureId,
+        BoundEvalFun& evalFun);
     /** Emit one solid polyline in renderer-specific form. */
     virtual void emitSolidPolyLine(
         JsValue const& jsVerts,
@@ -240,8 +383,7 @@ protected:
     void addFeature(
         mapget::model_ptr<mapget::Feature>& feature,
         BoundEvalFun& evalFun,
-        FeatureStyleRule const& rule,
-        std::string const& mapLayerStyleRuleId);
+        FeatureStyleRule const& rule);
     /** Evaluate one attribute-style rule against a matched attribute instance. */
     void addAttribute(
         mapget::model_ptr<mapget::Feature> const& feature,
@@ -249,7 +391,6 @@ protected:
         mapget::model_ptr<mapget::Attribute> const& attr,
         uint32_t tileFeatureId,
         const FeatureStyleRule& rule,
-        std::string const& mapLayerStyleRuleId,
         uint32_t& offsetSlot,
         std::unordered_set<uint32_t> const* hoveredValidityIndices = nullptr);
     /** Emit an already materialized geometry if it passes all render filters. */
@@ -258,7 +399,6 @@ protected:
         std::optional<uint32_t> geometryStage,
         uint32_t tileFeatureId,
         FeatureStyleRule const& rule,
-        std::string const& mapLayerStyleRuleId,
         BoundEvalFun& evalFun,
         glm::dvec3 const& offset = {.0, .0, .0});
     /** Resolve and emit a geometry model node if it passes all render filters. */
@@ -266,7 +406,6 @@ protected:
         mapget::model_ptr<mapget::Geometry> const& geom,
         uint32_t tileFeatureId,
         FeatureStyleRule const& rule,
-        std::string const& mapLayerStyleRuleId,
         BoundEvalFun& evalFun,
         glm::dvec3 const& offset = {.0, .0, .0});
     /** Expand one WGS84 AABB into a mesh-style render primitive. */
@@ -312,15 +451,60 @@ protected:
     [[nodiscard]] virtual bool includesPointLikeGeometry() const;
     /** Report whether this visualization wants line or surface geometry for the current pass. */
     [[nodiscard]] virtual bool includesNonPointGeometry() const;
-    /** Route point-like geometry either to merged-point aggregation or direct emission. */
+    /** Add point-like geometry to the merged-point grid cell of its rule. */
     void addMergedPointGeometry(
         uint32_t tileFeatureId,
-        const std::string& mapLayerStyleRuleId,
-        const std::optional<glm::dvec3>& gridCellSize,
+        FeatureStyleRule const& rule,
         mapget::Point const& pointCartographic,
         const char* geomField,
         BoundEvalFun& evalFun,
         std::function<JsValue(BoundEvalFun&)> const& makeGeomParams);
+    /** Return the merged-point state of a rule, creating it on first use. */
+    MergedPointRule& mergedPointRule(uint32_t ruleIndex);
+    /**
+     * Resolve the external merge counts of all grid cells the current tile may touch
+     * with one `countBatch` call on the merge service. Cells are collected per
+     * candidate rule before any filter is evaluated, so the set may be a superset.
+     */
+    void prefetchMergedPointCounts();
+    /** Traversal and evaluation state of a pass which carries over between `runFor()` slices. */
+    struct PendingRun {
+        explicit PendingRun(simfil::model_ptr<simfil::OverlayNode> placeholderContext);
+
+        /** Root addresses to visit; empty if the pass walks `[position_, end_)` directly. */
+        std::vector<uint32_t> featureAddresses_;
+        size_t position_ = 0;
+        size_t end_ = 0;
+        mapget::Feature const* currentFeature_ = nullptr;
+        std::optional<simfil::model_ptr<simfil::OverlayNode>> evaluationContext_;
+        simfil::model_ptr<simfil::OverlayNode> placeholderContext_;
+        BoundEvalFun boundEvalFun_;
+    };
+    /** Reset relation state, prefetch merge counts and set up the traversal of a new pass. */
+    void beginRun();
+    /**
+     * Evaluate all candidate rules of one feature within the pending pass. The feature's
+     * geometry type mask is computed on demand and left in `featureGeomMask` for reuse.
+     */
+    void renderFeature(
+        mapget::model_ptr<mapget::Feature>& feature,
+        std::optional<uint32_t>& featureGeomMask);
+    /** Report whether rendering is restricted to a feature id or address subset. */
+    [[nodiscard]] bool hasFeatureSubset() const;
+    /** Visit every feature of the tile, or only those of the active feature subset. */
+    void forEachFeatureInSubset(std::function<void(mapget::model_ptr<mapget::Feature>&)> const& fn);
+    /** Return the hovered attribute filter of a feature, or nullptr if it has none. */
+    [[nodiscard]] HoveredAttributeSubset const* hoveredAttributeSubset(
+        uint32_t featureAddress,
+        std::function<std::string const&()> const& resolveFeatureId) const;
+    /** Return the external merge count of a cell, asking the merge service if needed. */
+    int32_t externalMergedPointCount(
+        uint32_t ruleIndex,
+        MergedPointRule& mergedRule,
+        GridCellKey key,
+        MergedPointCell& cell);
+    /** Format a merged-point cell as the `x:y:z` hash used by the merge service. */
+    [[nodiscard]] static std::string mergedPointCellHash(MergedPointCell const& cell);
     /** Evaluate a simfil expression against one context node. */
     simfil::Value evaluateExpression(
         std::string const& expression,
@@ -332,21 +516,21 @@ protected:
         std::string const& expression,
         bool anyMode,
         bool autoWildcard);
-    /** Cached parsed simfil expression and its optional constant-folded result. */
-    struct CachedExpression {
-        simfil::ASTPtr ast_;
-        std::optional<simfil::Value> constantValue_;
-        bool constantResolved_ = false;
-    };
-    /** Lazily construct the shared simfil evaluation environment. */
-    void ensureEvaluationEnvironment();
-    /** Look up or compile an expression in the per-visualization cache. */
+    /** Compiled expression entry of the shared style expression scope. */
+    using CachedExpression = StyleExpressionScope::CachedExpression;
+    /** Look up or compile an expression in the style's shared expression scope. */
     CachedExpression* getOrCompileExpression(
         std::string const& expression,
         bool anyMode,
         bool autoWildcard);
     /** Resolve and memoize the constant value of a cached expression, if any. */
     void resolveCachedConstant(CachedExpression& cached);
+    /**
+     * Fold the runtime issues of a shard which rendered a later address range of the same
+     * tile into this visualization. Shards have no merged points or relation state, since
+     * the sequential pass of this visualization renders those.
+     */
+    void mergeShardState(FeatureLayerVisualizationBase const& shard);
     /** Record one bounded runtime style evaluation issue. */
     void recordRuntimeStyleIssue(
         std::string property,
@@ -354,8 +538,20 @@ protected:
         std::string message,
         std::optional<uint32_t> ruleIndex = std::nullopt,
         std::string impact = "property-fallback");
-    /** Inject current option values into the simfil overlay context. */
-    void addOptionsToSimfilContext(simfil::model_ptr<simfil::OverlayNode>& context);
+    /** Intern the `$` field names and context-read option keys once for the shared string pool. */
+    void resolveContextFieldIds();
+    /** Create an evaluation overlay for one model value with the context-read options applied. */
+    [[nodiscard]] simfil::model_ptr<simfil::OverlayNode> makeEvaluationContext(simfil::Value const& value) const;
+    /**
+     * Find a feature by type and id parts in any tile added via `addTileFeatureLayer()`.
+     * The hash index over all added tiles is built on first use and extended when more
+     * tiles arrive. A miss falls back to a per-tile lookup only if no indexed feature has an
+     * id of the same form (type, part names and kinds), so ids which only match through
+     * mapget's lookup rules are still found without rescanning for every absent target.
+     */
+    [[nodiscard]] mapget::model_ptr<mapget::Feature> findFeatureInAddedTiles(
+        std::string_view typeId,
+        mapget::KeyValueViewPairs const& featureId);
     /** Remember a relation target that lives in another tile for frontend-assisted resolution. */
     void rememberExternalRelationReference(
         RelationStyleState& state,
@@ -386,6 +582,14 @@ protected:
     std::set<std::string> featureIdSubset_;
     std::set<std::string> featureIdBaseSubset_;
     std::unordered_map<std::string, HoveredAttributeSubset> hoveredAttributeSubsetsByFeatureId_;
+    std::vector<uint32_t> featureAddressSubset_;
+    uint32_t featureAddressRangeBegin_ = 0;
+    uint32_t featureAddressRangeEnd_ = std::numeric_limits<uint32_t>::max();
+    SequentialRules sequentialRules_ = SequentialRules::Render;
+    /** Set while a `SequentialRules::Only` pass renders a merging rule, see `renderFeature()`. */
+    bool skipUnmergedGeometry_ = false;
+    std::unordered_set<uint32_t> wholeFeatureAddressSubset_;
+    std::unordered_map<uint32_t, HoveredAttributeSubset> hoveredAttributeSubsetsByAddress_;
     std::map<std::string, simfil::Value> optionValues_;
     FeatureStyleRule::HighlightMode highlightMode_;
     FeatureStyleRule::Fidelity fidelity_;
@@ -393,19 +597,30 @@ protected:
     int maxLowFiLod_ = -1;
     GeometryOutputMode geometryOutputMode_ = GeometryOutputMode::All;
     JsValue featureMergeService_;
-    std::map<std::string,
-        std::map<std::string,
-            std::pair<std::unordered_set<uint32_t>, std::optional<JsValue>>>> mergedPointsPerStyleRuleId_;
+    std::map<uint32_t, MergedPointRule> mergedPointsPerRuleIndex_;
+    std::vector<std::string> mapLayerStyleRuleIds_;
+    /** Map and layer id which `mapLayerStyleRuleIds_` were formatted for. */
+    std::pair<std::string, std::string> mapLayerStyleRuleIdsSource_;
     mapget::TileFeatureLayer::Ptr tile_;
     std::vector<mapget::TileFeatureLayer::Ptr> allTiles_;
+    /** (index into `allTiles_`, feature address) by feature id key, see `findFeatureInAddedTiles()`. */
+    std::unordered_map<std::string, std::pair<uint32_t, uint32_t>> featureIdIndex_;
+    /** Id forms present in `featureIdIndex_`, keyed without part values. */
+    std::unordered_set<std::string> featureIdIndexForms_;
+    size_t numFeatureIdLookupFallbacks_ = 0;
+    size_t numFeatureIdIndexedTiles_ = 0;
     std::shared_ptr<simfil::StringPool> internalStringPoolCopy_;
-    std::unique_ptr<simfil::Environment> evalEnvironment_;
-    std::map<std::string, CachedExpression, std::less<>> expressionCache_;
+    std::shared_ptr<simfil::StringPool> sharedStringPool_;
+    std::shared_ptr<StyleExpressionScope> expressionScope_;
+    ContextFieldIds contextFieldIds_;
+    /** Values of the options in `FeatureLayerStyle::contextOptionIds()`, keyed by interned id. */
+    std::vector<std::pair<simfil::StringId, simfil::Value>> optionFields_;
     std::unordered_map<uint32_t, uint32_t> featureOffsetSlotsByRuleIndex_;
     std::deque<RelationStyleState> relationStyleStates_;
     JsValue externalRelationReferences_;
     std::vector<PendingExternalRelation> externalRelationVisualizations_;
     std::vector<StyleValidationIssue> runtimeStyleIssues_;
+    std::unique_ptr<PendingRun> pendingRun_;
 };
 
 }  // namespace erdblick
@@ -2,6 +2,7 @@
 
 #include <array>
 #include <cstdint>
+#include <memory>
 #include <vector>
 
 #include "visualization-base.h"
@@ -10,8 +11,10 @@ namespace erdblick
 {
 
 /**
- * Deck ABI v1 visualization scaffold.
+ * Deck ABI v2 visualization scaffold.
  * This class exposes raw SharedUint8Array accessors used by the deck renderer path.
+ * ABI v2 emits labels as columnar typed buffers; ABI v1 (per-label objects) can
+ * still be requested via `setAbiVersion` while consumers migrate.
  */
 class DeckFeatureLayerVisualization : public FeatureLayerVisualizationBase
 {
@@ -34,16 +37,70 @@ public:
     /** Finalize and release any accumulated geometry buffers. */
     ~DeckFeatureLayerVisualization() override;
 
-    /** Return the deck renderer ABI version expected by the frontend worker. */
+    /** Deck ABI version which emits labels as per-label JS objects. */
+    static constexpr uint32_t kLabelObjectsAbiVersion = 1u;
+    /** Deck ABI version which emits labels as columnar typed buffers. */
+    static constexpr uint32_t kColumnarLabelsAbiVersion = 2u;
+
+    /** Return the deck renderer ABI version of the render result layout. */
     [[nodiscard]] uint32_t abiVersion() const;
+    /** Select the render result layout; unsupported versions fall back to the latest one. */
+    void setAbiVersion(uint32_t version);
     /** Switch between full, point-only, and non-point-only emission modes. */
     void setGeometryOutputMode(int mode);
     /** Return the currently configured geometry-output mode. */
     [[nodiscard]] int geometryOutputMode() const;
+    /**
+     * Triangulate polygons during `run()` and emit per-surface triangle indices, so the
+     * consumer can skip its own tessellation. Disabled by default.
+     */
+    void setTriangulateSurfaces(bool enabled);
+    /** Report whether surfaces are emitted with triangle indices. */
+    [[nodiscard]] bool triangulateSurfaces() const;
+    /**
+     * Store path and arrow colors, widths and dash arrays once per path instead of once per
+     * vertex. Consumers tell the layouts apart by column length. Disabled by default.
+     */
+    void setPerPathAttributes(bool enabled);
+    /** Report whether path attributes are emitted once per path. */
+    [[nodiscard]] bool perPathAttributes() const;
+    /** Abandon a pending `runFor()` pass and free all geometry buffers and the render arena. */
+    void cancel() override;
+    /** Also drop the coordinate origin, which is derived from the tile. */
+    void resetForNextTile() override;
+    /**
+     * Batch entry point: render each tile in turn with this visualization's configuration and
+     * return one `renderResult()` per tile. Options, the expression scope and the rule-id table
+     * are set up once for the whole batch. Afterwards the visualization holds the last tile.
+     */
+    [[nodiscard]] NativeJsValue renderTiles(std::vector<TileFeatureLayer const*> const& tiles);
     /** Add a parsed tile layer and seed any deck-specific aggregation state. */
     void addTileFeatureLayer(TileFeatureLayer const& tile);
+    /**
+     * Run shard visualizations in parallel (sequentially under Emscripten) and append their
+     * buffers to this visualization in shard order, followed by a reduction of the shards'
+     * runtime issues. Each shard must render a consecutive address range
+     * (see `setFeatureAddressRange()`) of the same tile as this visualization, over its own
+     * parsed tile and style instance, since evaluation caches are not shared across threads.
+     * Shards need the same options as this visualization. Relation rules and merged points
+     * are rendered by this visualization in one pass over the whole tile, so relations,
+     * external relation references, `$mergeCount` and merged point parameters match a
+     * sequential `run()`; their geometry precedes the shards' geometry in the buffers.
+     * The shards' coordinate origin, which must be the same for all of them, is adopted.
+     * Memory grows with the shard count: N shards hold N parsed copies of the tile and N
+     * style instances with their own string pools, on top of this visualization's own.
+     */
+    void runShards(std::vector<DeckFeatureLayerVisualization*> const& shards);
     /** Materialize all accumulated buffers as the JS payload consumed by the deck worker. */
     [[nodiscard]] NativeJsValue renderResult() const;
+    /**
+     * Pack every typed buffer into one contiguous arena owned by this visualization and
+     * return a descriptor table (lod, bucket, field, type, byteOffset, length) plus the
+     * arena address and size. The arena stays valid until the next call or destruction.
+     */
+    [[nodiscard]] NativeJsValue renderResultArena() const;
+    /** Return the arena bytes written by the last `renderResultArena()` call. */
+    [[nodiscard]] std::vector<uint8_t> const& renderArena() const;
     /** Return the merge-service payload for point aggregation. */
     [[nodiscard]] NativeJsValue mergedPointFeatures() const;
     /** Return unresolved external relation references collected during rendering. */
@@ -55,15 +112,27 @@ private:
     /** Convert WGS84 positions to the point format expected by deck geometry buffers. */
     mapget::Point projectWgsPoint(
         mapget::Point const& wgsPoint) const override;
+    /** Batch variant of `projectWgsPoint()` running one tight loop over the cached origin scales. */
+    void projectWgsPoints(
+        std::span<mapget::Point const> wgsPoints,
+        std::vector<mapget::Point>& projected) const override;
+    /** Pin the coordinate origin on first use and cache its mercator position and distance scales. */
+    void ensureProjectionOrigin(mapget::Point const& firstWgsPoint) const;
+    /** Meters per pixel at the tile's native zoom, where a tile spans one mercator tile. */
+    [[nodiscard]] double projectedUnitsPerPixel() const override;
     /** Track per-feature LOD state before the base class emits geometry. */
     void onFeatureForRendering(mapget::Feature const& feature) override;
     /** Keep low-fi bundle generation alive even when the base class would normally cull it. */
     [[nodiscard]] bool bypassLowFiMaxLodFilter() const override;
     /** Prefix rule ids with deck-specific render-pass information. */
     std::string makeMapLayerStyleRuleId(uint32_t ruleIndex) const override;
+    using FeatureLayerVisualizationBase::emitPoint;
+    using FeatureLayerVisualizationBase::emitIcon;
+    using FeatureLayerVisualizationBase::emitLabel;
+
     /** Append one point primitive to the appropriate point buffer. */
     void emitPoint(
-        JsValue const& xyzPos,
+        mapget::Point const& xyzPos,
         FeatureStyleRule const& rule,
         uint32_t tileFeatureId,
         BoundEvalFun& evalFun) override;
@@ -73,7 +142,7 @@ private:
         FeatureStyleRule const& rule,
         uint32_t tileFeatureId,
         BoundEvalFun& evalFun) override;
-    /** Append one mesh primitive to the surface buffers. */
+    /** Append one mesh primitive to the indexed mesh buffers. */
     void emitMesh(
         std::vector<mapget::Point> const& vertsCartesian,
         FeatureStyleRule const& rule,
@@ -89,13 +158,13 @@ private:
         BoundEvalFun& evalFun) override;
     /** Append one icon descriptor to the point/icon buffers. */
     void emitIcon(
-        JsValue const& xyzPos,
+        mapget::Point const& xyzPos,
         FeatureStyleRule const& rule,
         uint32_t tileFeatureId,
         BoundEvalFun& evalFun) override;
-    /** Append one label descriptor to the label buffers. */
+    /** Append one label to the columnar label buffers. */
     void emitLabel(
-        JsValue const& xyzPos,
+        mapget::Point const& xyzPos,
         std::string const& text,
         FeatureStyleRule const& rule,
         uint32_t tileFeatureId,
@@ -176,8 +245,6 @@ private:
     static std::uint8_t toColorByte(float value);
     /** Report whether low-fi bundle generation is enabled for this render pass. */
     [[nodiscard]] bool lowFiBundleModeEnabled() const;
-    /** Report whether geometry should be emitted into the aggregate buffers right now. */
-    [[nodiscard]] bool emitToAggregateForCurrentFeatureLod() const;
     /** Return the active low-fi LOD bucket for the feature currently being emitted. */
     [[nodiscard]] uint8_t activeLodBucket() const;
 public:
@@ -196,8 +263,29 @@ public:
         std::vector<uint8_t> surfaceColors;
         std::vector<uint8_t> depthTests;
         std::vector<uint32_t> surfaceFeatureAddresses;
+        /** Triangle vertex indices, relative to the first vertex of their surface. */
+        std::vector<uint32_t> surfaceIndices;
+        /** Offsets into `surfaceIndices` per surface; only filled when triangulating. */
+        std::vector<uint32_t> surfaceIndexStartIndices;
+    };
+    /**
+     * Raw deck buffers for indexed triangle meshes. Vertices are deduplicated per mesh
+     * and indices are relative to the mesh's first vertex; color, depth test and
+     * feature address are stored once per mesh.
+     */
+    struct MeshBuffers {
+        std::vector<float> positions;
+        std::vector<uint32_t> startIndices;
+        std::vector<uint32_t> indices;
+        std::vector<uint32_t> indexStartIndices;
+        std::vector<uint8_t> colors;
+        std::vector<uint8_t> depthTests;
+        std::vector<uint32_t> featureAddresses;
     };
-    /** Raw deck buffers for path-like primitives. */
+    /**
+     * Raw deck buffers for path-like primitives. `colors`, `widths` and `dashArray` hold one
+     * entry per vertex, or one per path if `perPathAttributes()` is set.
+     */
     struct PathBuffers {
         std::vector<float> positions;
         std::vector<uint32_t> startIndices;
@@ -207,6 +295,23 @@ public:
         std::vector<uint32_t> featureAddresses;
         std::vector<float> dashArray;
     };
+    /** Flag bit in `LabelBuffers::flags`: the label is depth-tested. */
+    static constexpr uint8_t kLabelFlagDepthTest = 1u << 0;
+    /** Flag bit in `LabelBuffers::flags`: the label has a pixel offset. */
+    static constexpr uint8_t kLabelFlagPixelOffset = 1u << 1;
+    /** Raw deck buffers for labels, stored column-wise with one text blob. */
+    struct LabelBuffers {
+        std::vector<float> positions;
+        std::vector<uint8_t> text;
+        std::vector<uint32_t> textOffsets;
+        std::vector<uint8_t> fillColors;
+        std::vector<uint8_t> outlineColors;
+        std::vector<float> outlineWidths;
+        std::vector<float> scales;
+        std::vector<float> pixelOffsets;
+        std::vector<uint8_t> flags;
+        std::vector<uint32_t> featureAddresses;
+    };
     /** Raw deck buffers for GLTF-backed node references. */
     struct GltfBuffers {
         std::vector<uint32_t> nodeIndices;
@@ -225,9 +330,10 @@ public:
     struct GeometryBuffers {
         PointBuffers pointWorld;
         PointBuffers pointBillboard;
-        std::vector<JsValue> labelWorld;
-        std::vector<JsValue> labelBillboard;
+        LabelBuffers labelWorld;
+        LabelBuffers labelBillboard;
         SurfaceBuffers surfaces;
+        MeshBuffers meshes;
         PathBuffers pathWorld;
         PathBuffers pathBillboard;
         PathBuffers arrowWorld;
@@ -238,8 +344,12 @@ public:
 private:
     /** Check whether any point geometry has been appended. */
     [[nodiscard]] static bool hasGeometry(PointBuffers const& buffers);
+    /** Check whether any labels have been appended. */
+    [[nodiscard]] static bool hasGeometry(LabelBuffers const& buffers);
     /** Check whether any surface geometry has been appended. */
     [[nodiscard]] static bool hasGeometry(SurfaceBuffers const& buffers);
+    /** Check whether any mesh geometry has been appended. */
+    [[nodiscard]] static bool hasGeometry(MeshBuffers const& buffers);
     /** Check whether any path geometry has been appended. */
     [[nodiscard]] static bool hasGeometry(PathBuffers const& buffers);
     /** Check whether any GLTF node references have been appended. */
@@ -252,10 +362,23 @@ private:
     [[nodiscard]] bool hasLowFiGeometryForLod(size_t lod) const;
     /** Return the mutable low-fi buffer set for a specific LOD bucket. */
     GeometryBuffers& lowFiBuffersForLod(size_t lod);
+    /** Number of leading low-fi LOD buckets which form the aggregate of a low-fi pass. */
+    [[nodiscard]] size_t aggregateLodCount() const;
+    /**
+     * Return the buffer set receiving primitives of the feature currently being emitted:
+     * the aggregate buffers, or the feature's LOD bucket in low-fi bundle mode.
+     */
+    GeometryBuffers& emitBuffers();
     /** Convert point buffers into the JS object expected by the deck worker. */
     [[nodiscard]] static JsValue pointBuffersToJs(PointBuffers const& buffers);
+    /** Convert label buffers into the columnar JS object of deck ABI v2. */
+    [[nodiscard]] static JsValue labelBuffersToJs(LabelBuffers const& buffers);
+    /** Expand label buffers into the per-label JS objects of deck ABI v1. */
+    [[nodiscard]] static JsValue labelObjectsToJs(LabelBuffers const& buffers, bool billboard);
     /** Convert surface buffers into the JS object expected by the deck worker. */
     [[nodiscard]] static JsValue surfaceBuffersToJs(SurfaceBuffers const& buffers);
+    /** Convert indexed mesh buffers into the JS object expected by the deck worker. */
+    [[nodiscard]] static JsValue meshBuffersToJs(MeshBuffers const& buffers);
     /** Convert path buffers into the JS object expected by the deck worker. */
     [[nodiscard]] static JsValue pathBuffersToJs(PathBuffers const& buffers, bool withDashArrays);
     /** Convert GLTF node buffers into the JS object expected by the deck worker. */
@@ -263,17 +386,71 @@ private:
     /** Convert GLTF picking-proxy buffers into the JS object expected by the deck worker. */
     [[nodiscard]] static JsValue gltfPickProxyBuffersToJs(GltfPickProxyBuffers const& buffers);
     /** Convert a full geometry buffer set into the JS object expected by the deck worker. */
-    [[nodiscard]] static JsValue geometryBuffersToJs(GeometryBuffers const& buffers);
+    [[nodiscard]] JsValue geometryBuffersToJs(GeometryBuffers const& buffers) const;
     /** Return the coordinate origin used for path precision-preserving deck buffers. */
     [[nodiscard]] JsValue coordinateOriginToJs() const;
     /** Materialize all low-fi bundle results for deferred frontend use. */
     [[nodiscard]] JsValue lowFiBundleResultsToJs() const;
+    /** Concatenate the LOD buckets which make up the aggregate of a low-fi pass. */
+    [[nodiscard]] GeometryBuffers lowFiAggregateBuffers() const;
+
+    /** Number of low-fi LOD buckets. */
+    static constexpr size_t kLowFiLodCount = 8;
 
     GeometryBuffers aggregateBuffers_;
-    std::array<GeometryBuffers, 8> lowFiLodBuffers_;
+    std::array<GeometryBuffers, kLowFiLodCount> lowFiLodBuffers_;
     uint8_t activeFeatureLod_ = 0;
+    uint32_t abiVersion_ = kColumnarLabelsAbiVersion;
+    bool triangulateSurfaces_ = false;
+    bool perPathAttributes_ = false;
+    mutable std::vector<uint8_t> renderArena_;
     mutable bool hasPathCoordinateOriginWgs_ = false;
     mutable mapget::Point pathCoordinateOriginWgs_ = {.0, .0, .0};
+    mutable bool hasOriginDistanceScales_ = false;
+    mutable double originWorldY_ = 0.;
+    mutable double originUnitsPerMeter_ = 0.;
+    mutable double originUnitsPerMeter2_ = 0.;
+};
+
+/**
+ * Deck visualizations of one tile for several styles, rendered in a single traversal of the
+ * tile's features (see `FeatureLayerVisualizationBase::runJointly()`). Each style keeps its
+ * own buffer set, which is read through `visualization()`.
+ */
+class DeckMultiStyleVisualization
+{
+public:
+    /**
+     * Create one deck visualization per style. `rawOptionValuesPerStyle` is a list with the
+     * option values dict of each style, in the order of `styles`.
+     */
+    DeckMultiStyleVisualization(
+        int viewIndex,
+        std::string const& mapTileKey,
+        std::vector<FeatureLayerStyle const*> const& styles,
+        NativeJsValue const& rawOptionValuesPerStyle,
+        NativeJsValue const& rawFeatureMergeService,
+        FeatureStyleRule::HighlightMode const& highlightMode = FeatureStyleRule::NoHighlight,
+        FeatureStyleRule::Fidelity fidelity = FeatureStyleRule::AnyFidelity,
+        int highFidelityStage = 0,
+        int maxLowFiLod = -1,
+        int geometryOutputMode = 0);
+
+    /**
+     * Add a parsed tile layer to the visualization of every style. The styles compile their
+     * expressions into one copy of the first tile's field dictionary, which the tile uses.
+     */
+    void addTileFeatureLayer(TileFeatureLayer const& tile);
+    /** Render all styles in one traversal of the tile. */
+    void run();
+    /** Return the number of styles. */
+    [[nodiscard]] uint32_t size() const;
+    /** Return the visualization holding the results of the style at `index` < `size()`. */
+    [[nodiscard]] DeckFeatureLayerVisualization& visualization(uint32_t index);
+
+private:
+    std::vector<std::unique_ptr<DeckFeatureLayerVisualization>> visualizations_;
+    std::shared_ptr<simfil::StringPool> strings_;
 };
 
 }  // namespace erdblick
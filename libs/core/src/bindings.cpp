@@ -122,6 +122,38 @@ int deckGeometryOutputNonPointsOnly()
     return static_cast<int>(DeckFeatureLayerVisualization::GeometryOutputMode::NonPointsOnly);
 }
 
+/** Construct a multi-style deck visualization from a JS array of parsed styles. */
+DeckMultiStyleVisualization* makeDeckMultiStyleVisualization(
+    int viewIndex,
+    std::string const& mapTileKey,
+    em::val styles,
+    em::val optionValuesPerStyle,
+    em::val featureMergeService,
+    FeatureStyleRule::HighlightMode highlightMode,
+    FeatureStyleRule::Fidelity fidelity,
+    int highFidelityStage,
+    int maxLowFiLod,
+    int geometryOutputMode)
+{
+    std::vector<FeatureLayerStyle const*> stylePointers;
+    auto const numStyles = styles["length"].as<uint32_t>();
+    stylePointers.reserve(numStyles);
+    for (uint32_t i = 0; i < numStyles; ++i) {
+        stylePointers.push_back(styles[i].as<FeatureLayerStyle*>(em::allow_raw_pointers()));
+    }
+    return new DeckMultiStyleVisualization(
+        viewIndex,
+        mapTileKey,
+        stylePointers,
+        optionValuesPerStyle,
+        featureMergeService,
+        highlightMode,
+        fidelity,
+        highFidelityStage,
+        maxLowFiLod,
+        geometryOutputMode);
+}
+
 /** Report whether the parsed tile exposes a tile-level GLB attachment. */
 bool tileFeatureLayerHasGlbAttachment(TileFeatureLayer const& tile)
 {
@@ -355,78 +387,6 @@ em::val getCornerTileBox(uint64_t tileIdValue) {
     });
 }
 
-/** Resolve the geometry feature focus helpers should use for one feature. */
-mapget::model_ptr<mapget::Geometry> preferredFeatureGeometry(mapget::model_ptr<mapget::Feature>& feature)
-{
-    mapget::model_ptr<mapget::Geometry> result;
-    if (auto geometryCollection = feature->geomOrNull()) {
-        geometryCollection->forEachGeometryAtPreferredStage(
-            std::nullopt,
-            [&result](auto&& geometry)
-            {
-                result = geometry;
-                return false;
-            });
-        if (!result) {
-            geometryCollection->forEachGeometry(
-                [&result](auto&& geometry)
-                {
-                    result = geometry;
-                    return false;
-                });
-        }
-    }
-    return result;
-}
-
-/** Compute the WGS84 center of one feature, including AABB/GLTF bounds geometries. */
-mapget::Point preferredFeatureCenter(mapget::model_ptr<mapget::Feature>& feature)
-{
-    auto geometry = preferredFeatureGeometry(feature);
-    if (!geometry) {
-        return {};
-    }
-
-    switch (geometry->geomType()) {
-    case mapget::GeomType::AABB: {
-        auto const origin = geometry->aabbOrigin();
-        auto const size = geometry->aabbSize();
-        return {origin.x + size.x * 0.5, origin.y + size.y * 0.5, origin.z + size.z * 0.5};
-    }
-    case mapget::GeomType::GltfNodeIndex: {
-        auto const origin = geometry->gltfNodeAabbOrigin();
-        auto const size = geometry->gltfNodeAabbSize();
-        return {origin.x + size.x * 0.5, origin.y + size.y * 0.5, origin.z + size.z * 0.5};
-    }
-    default:
-        return geometryCenter(geometry->toSelfContained());
-    }
-}
-
-/** Return one corner of the feature bounds for bounding-sphere style camera framing. */
-mapget::Point preferredFeatureBoundingRadiusEndPoint(mapget::model_ptr<mapget::Feature>& feature)
-{
-    auto geometry = preferredFeatureGeometry(feature);
-    if (!geometry) {
-        return {};
-    }
-
-    switch (geometry->geomType()) {
-    case mapget::GeomType::AABB: {
-        auto const origin = geometry->aabbOrigin();
-        auto const size = geometry->aabbSize();
-        return {origin.x + size.x, origin.y + size.y, origin.z + size.z};
-    }
-    case mapget::GeomType::GltfNodeIndex: {
-        auto const origin = geometry->gltfNodeAabbOrigin();
-        auto const size = geometry->gltfNodeAabbSize();
-        return {origin.x + size.x, origin.y + size.y, origin.z + size.z};
-    }
-    default:
-        return boundingRadiusEndPoint(geometry->toSelfContained());
-    }
-}
-
 /**
  * Get the neighbor for a mapget tile id. Tile row will be clamped to [0, maxForLevel],
  * so a positive/negative wraparound is not possible. The tile id column will wrap at the
@@ -631,6 +591,7 @@ EMSCRIPTEN_BINDINGS(erdblick)
         .function("minimumStage", &FeatureLayerStyle::minimumStage)
         .function("hasExplicitLowFidelityRules", &FeatureLayerStyle::hasExplicitLowFidelityRules)
         .function("hasRelationRules", &FeatureLayerStyle::hasRelationRules)
+        .function("optionAffectsHighlightMode", &FeatureLayerStyle::optionAffectsHighlightMode)
         .function("supportsHighlightMode", &FeatureLayerStyle::supportsHighlightMode);
 
     ////////// SourceDataAddressFormat
@@ -656,6 +617,10 @@ EMSCRIPTEN_BINDINGS(erdblick)
             "id",
             std::function<std::string(FeaturePtr&)>(
                 [](FeaturePtr& self) { return self->id()->toString(); }))
+        .function(
+            "address",
+            std::function<uint32_t(FeaturePtr&)>(
+                [](FeaturePtr& self) { return self->addr().index(); }))
         .function(
             "geojson",
             std::function<std::string(FeaturePtr&)>(
@@ -670,13 +635,13 @@ EMSCRIPTEN_BINDINGS(erdblick)
             "center",
             std::function<mapget::Point(FeaturePtr&)>(
                 [](FeaturePtr& self){
-                    return preferredFeatureCenter(self);
+                    return summarizeFeatureGeometry(self).center;
                 }))
         .function(
             "boundingRadiusEndPoint",
             std::function<mapget::Point(FeaturePtr&)>(
                 [](FeaturePtr& self){
-                    return preferredFeatureBoundingRadiusEndPoint(self);
+                    return summarizeFeatureGeometry(self).boundingRadiusEndPoint;
                 }))
         .function(
             "getGeometryType",
@@ -707,8 +672,12 @@ EMSCRIPTEN_BINDINGS(erdblick)
         .function("hasGlbAttachment", &tileFeatureLayerHasGlbAttachment)
         .function("glbAttachmentName", &tileFeatureLayerGlbAttachmentName)
         .function("copyGlbAttachment", &copyTileFeatureLayerGlbAttachment)
+        .function("featureAddressById", &TileFeatureLayer::featureAddressById)
         .function("featureIdByAddress", &TileFeatureLayer::featureIdByAddress)
         .function("featureByAddress", &TileFeatureLayer::featureByAddress)
+        .function("featureIdsByAddresses", &TileFeatureLayer::featureIdsByAddresses)
+        .function("featureCenter", &TileFeatureLayer::featureCenter)
+        .function("featureBoundingRadiusEndPoint", &TileFeatureLayer::featureBoundingRadiusEndPoint)
         .function("findFeatureIndex", &TileFeatureLayer::findFeatureIndex);
 
     ////////// Highlight Modes
@@ -730,6 +699,10 @@ EMSCRIPTEN_BINDINGS(erdblick)
         .class_function("GEOMETRY_OUTPUT_NON_POINTS_ONLY", &deckGeometryOutputNonPointsOnly)
         .function("setGeometryOutputMode", &DeckFeatureLayerVisualization::setGeometryOutputMode)
         .function("geometryOutputMode", &DeckFeatureLayerVisualization::geometryOutputMode)
+        .function("setTriangulateSurfaces", &DeckFeatureLayerVisualization::setTriangulateSurfaces)
+        .function("triangulateSurfaces", &DeckFeatureLayerVisualization::triangulateSurfaces)
+        .function("setPerPathAttributes", &DeckFeatureLayerVisualization::setPerPathAttributes)
+        .function("perPathAttributes", &DeckFeatureLayerVisualization::perPathAttributes)
         .function(
             "addTileFeatureLayer",
             std::function<void(DeckFeatureLayerVisualization&, TileFeatureLayer const&)>(
@@ -744,8 +717,46 @@ EMSCRIPTEN_BINDINGS(erdblick)
                 {
                     self.FeatureLayerVisualizationBase::run();
                 }))
+        .function(
+            "runFor",
+            std::function<bool(DeckFeatureLayerVisualization&, double)>(
+                [](DeckFeatureLayerVisualization& self, double budgetMicros)
+                {
+                    return self.runFor(budgetMicros);
+                }))
+        .function("cancel", &DeckFeatureLayerVisualization::cancel)
+        .function("resetForNextTile", &DeckFeatureLayerVisualization::resetForNextTile)
+        .function(
+            "setFeatureMergeService",
+            std::function<void(DeckFeatureLayerVisualization&, em::val)>(
+                [](DeckFeatureLayerVisualization& self, em::val mergeService)
+                {
+                    self.setFeatureMergeService(mergeService);
+                }))
+        .function(
+            "renderTiles",
+            std::function<em::val(DeckFeatureLayerVisualization&, em::val)>(
+                [](DeckFeatureLayerVisualization& self, em::val tiles)
+                {
+                    std::vector<TileFeatureLayer const*> tilePointers;
+                    auto const numTiles = tiles["length"].as<uint32_t>();
+                    tilePointers.reserve(numTiles);
+                    for (uint32_t i = 0; i < numTiles; ++i) {
+                        tilePointers.push_back(tiles[i].as<TileFeatureLayer*>(em::allow_raw_pointers()));
+                    }
+                    return self.renderTiles(tilePointers);
+                }))
+        .function(
+            "setFeatureAddressSubset",
+            std::function<void(DeckFeatureLayerVisualization&, em::val, em::val, em::val)>(
+                [](DeckFeatureLayerVisualization& self, em::val addresses, em::val attributes, em::val validities)
+                {
+                    self.setFeatureAddressSubset(addresses, attributes, validities);
+                }))
         .function("abiVersion", &DeckFeatureLayerVisualization::abiVersion)
+        .function("setAbiVersion", &DeckFeatureLayerVisualization::setAbiVersion)
         .function("renderResult", &DeckFeatureLayerVisualization::renderResult)
+        .function("renderResultArena", &DeckFeatureLayerVisualization::renderResultArena)
         .function(
             "runtimeStyleIssues",
             std::function<NativeJsValue(DeckFeatureLayerVisualization const&)>(
@@ -759,6 +770,21 @@ EMSCRIPTEN_BINDINGS(erdblick)
             "processResolvedExternalReferences",
             &DeckFeatureLayerVisualization::processResolvedExternalReferences);
 
+    ////////// DeckMultiStyleVisualization
+    em::class_<DeckMultiStyleVisualization>("DeckMultiStyleVisualization")
+        .constructor(&makeDeckMultiStyleVisualization, em::allow_raw_pointers())
+        .function("addTileFeatureLayer", &DeckMultiStyleVisualization::addTileFeatureLayer)
+        .function("run", &DeckMultiStyleVisualization::run)
+        .function("size", &DeckMultiStyleVisualization::size)
+        .function(
+            "visualization",
+            std::function<DeckFeatureLayerVisualization*(DeckMultiStyleVisualization&, uint32_t)>(
+                [](DeckMultiStyleVisualization& self, uint32_t index)
+                {
+                    return &self.visualization(index);
+                }),
+            em::allow_raw_pointers());
+
     ////////// FeatureLayerSearch
     em::class_<FeatureLayerSearch>("FeatureLayerSearch")
         .constructor<TileFeatureLayer&>()
@@ -1,4 +1,6 @@
 #include <algorithm>
+#include <utility>
+#include <vector>
 
 #include "glm/glm.hpp"
 
@@ -162,6 +164,184 @@ Point applyLocalOffsetToPoint(
     return {adjustedWgs.x, adjustedWgs.y, adjustedWgs.z};
 }
 
+/** Squared x/y distance of `p` to the segment `a`-`b`. */
+double squaredSegmentDistance2d(Point const& p, Point const& a, Point const& b)
+{
+    auto const dx = b.x - a.x;
+    auto const dy = b.y - a.y;
+    auto const lengthSquared = dx * dx + dy * dy;
+    auto t = 0.0;
+    if (lengthSquared > 0.0) {
+        t = std::clamp(((p.x - a.x) * dx + (p.y - a.y) * dy) / lengthSquared, 0.0, 1.0);
+    }
+    auto const ex = a.x + t * dx - p.x;
+    auto const ey = a.y + t * dy - p.y;
+    return ex * ex + ey * ey;
+}
+
+/** Mark the Douglas-Peucker vertices of `points[first..last]` that deviate by more than the tolerance. */
+void markDouglasPeucker(
+    std::vector<Point> const& points,
+    size_t first,
+    size_t last,
+    double toleranceSquared,
+    std::vector<uint8_t>& keep)
+{
+    keep[first] = 1;
+    keep[last] = 1;
+    std::vector<std::pair<size_t, size_t>> ranges{{first, last}};
+    while (!ranges.empty()) {
+        auto const [from, to] = ranges.back();
+        ranges.pop_back();
+        auto maxDistance = 0.0;
+        auto maxIndex = from;
+        for (auto i = from + 1; i < to; ++i) {
+            auto const distance = squaredSegmentDistance2d(points[i], points[from], points[to]);
+            if (distance > maxDistance) {
+                maxDistance = distance;
+                maxIndex = i;
+            }
+        }
+        if (maxDistance <= toleranceSquared) {
+            continue;
+        }
+        keep[maxIndex] = 1;
+        ranges.emplace_back(from, maxIndex);
+        ranges.emplace_back(maxIndex, to);
+    }
+}
+
+/** Signed x/y area orientation of the triangle `a`, `b`, `c`. */
+double orientation2d(Point const& a, Point const& b, Point const& c)
+{
+    return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+}
+
+/** Report whether the x/y segments `a`-`b` and `c`-`d` touch or cross. */
+bool segmentsIntersect2d(Point const& a, Point const& b, Point const& c, Point const& d)
+{
+    auto const o1 = orientation2d(a, b, c);
+    auto const o2 = orientation2d(a, b, d);
+    auto const o3 = orientation2d(c, d, a);
+    auto const o4 = orientation2d(c, d, b);
+    if (((o1 > 0 && o2 < 0) || (o1 < 0 && o2 > 0)) && ((o3 > 0 && o4 < 0) || (o3 < 0 && o4 > 0))) {
+        return true;
+    }
+    auto const onSegment = [](Point const& p, Point const& q, Point const& r) {
+        return std::min(p.x, q.x) <= r.x && r.x <= std::max(p.x, q.x) &&
+            std::min(p.y, q.y) <= r.y && r.y <= std::max(p.y, q.y);
+    };
+    return (o1 == 0 && onSegment(a, b, c)) || (o2 == 0 && onSegment(a, b, d)) ||
+        (o3 == 0 && onSegment(c, d, a)) || (o4 == 0 && onSegment(c, d, b));
+}
+
+/** Report whether any two non-adjacent segments of a polyline or ring intersect. */
+bool hasSelfIntersection2d(std::vector<Point> const& points, bool closed)
+{
+    auto numPoints = points.size();
+    if (closed && numPoints > 1 && points.front().x == points.back().x && points.front().y == points.back().y) {
+        // Explicitly closed rings repeat their first vertex; the closing edge is implied.
+        --numPoints;
+    }
+    auto const numSegments = closed ? numPoints : numPoints - 1;
+    auto const segmentEnd = [&points, numPoints](size_t segment) -> Point const& {
+        return points[(segment + 1) % numPoints];
+    };
+    for (size_t i = 0; i < numSegments; ++i) {
+        for (size_t j = i + 2; j < numSegments; ++j) {
+            if (closed && i == 0 && j == numSegments - 1) {
+                continue;
+            }
+            if (segmentsIntersect2d(points[i], segmentEnd(i), points[j], segmentEnd(j))) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/** One Douglas-Peucker pass; closed rings are split at the vertex furthest from the first one. */
+std::vector<Point> douglasPeucker(std::vector<Point> const& points, double tolerance, bool closed)
+{
+    std::vector<uint8_t> keep(points.size(), 0);
+    auto const toleranceSquared = tolerance * tolerance;
+    auto const last = points.size() - 1;
+    if (closed) {
+        size_t split = 1;
+        auto maxDistance = 0.0;
+        for (size_t i = 1; i < points.size(); ++i) {
+            auto const dx = points[i].x - points[0].x;
+            auto const dy = points[i].y - points[0].y;
+            if (dx * dx + dy * dy > maxDistance) {
+                maxDistance = dx * dx + dy * dy;
+                split = i;
+            }
+        }
+        markDouglasPeucker(points, 0, split, toleranceSquared, keep);
+        markDouglasPeucker(points, split, last, toleranceSquared, keep);
+    }
+    else {
+        markDouglasPeucker(points, 0, last, toleranceSquared, keep);
+    }
+
+    std::vector<Point> result;
+    for (size_t i = 0; i < points.size(); ++i) {
+        if (keep[i]) {
+            result.push_back(points[i]);
+        }
+    }
+    return result;
+}
+
+/**
+ * Project a ring onto the coordinate plane which is most perpendicular to its
+ * Newell normal, so vertical surfaces do not collapse when triangulated in 2D.
+ * Returns an empty vector if the ring has no area.
+ */
+std::vector<Point> projectRingToDominantPlane(std::vector<Point> const& ring, size_t numPoints)
+{
+    glm::dvec3 normal{0., 0., 0.};
+    for (size_t i = 0; i < numPoints; ++i) {
+        auto const& a = ring[i];
+        auto const& b = ring[(i + 1) % numPoints];
+        normal.x += (a.y - b.y) * (a.z + b.z);
+        normal.y += (a.z - b.z) * (a.x + b.x);
+        normal.z += (a.x - b.x) * (a.y + b.y);
+    }
+    auto const absNormal = glm::abs(normal);
+    if (absNormal.x + absNormal.y + absNormal.z <= 0.) {
+        return {};
+    }
+
+    std::vector<Point> projected;
+    projected.reserve(numPoints);
+    for (size_t i = 0; i < numPoints; ++i) {
+        auto const& p = ring[i];
+        if (absNormal.z >= absNormal.x && absNormal.z >= absNormal.y) {
+            projected.push_back({p.x, p.y, 0.});
+        }
+        else if (absNormal.y >= absNormal.x) {
+            projected.push_back({p.z, p.x, 0.});
+        }
+        else {
+            projected.push_back({p.y, p.z, 0.});
+        }
+    }
+    return projected;
+}
+
+/** Report whether two points share their x/y position. */
+bool isSamePoint2d(Point const& a, Point const& b)
+{
+    return a.x == b.x && a.y == b.y;
+}
+
+/** Report whether `p` lies inside or on the counter-clockwise 2d triangle `a`, `b`, `c`. */
+bool isPointInCcwTriangle2d(Point const& p, Point const& a, Point const& b, Point const& c)
+{
+    return orientation2d(a, b, p) >= 0. && orientation2d(b, c, p) >= 0. && orientation2d(c, a, p) >= 0.;
+}
+
 }
 
 Point erdblick::geometryCenter(const SelfContainedGeometry& g)
@@ -267,7 +447,11 @@ Point erdblick::geometryCenter(const SelfContainedGeometry& g)
 
 Point erdblick::boundingRadiusEndPoint(const SelfContainedGeometry& g)
 {
-    const Point center = geometryCenter(g);
+    return boundingRadiusEndPoint(g, geometryCenter(g));
+}
+
+Point erdblick::boundingRadiusEndPoint(const SelfContainedGeometry& g, const Point& center)
+{
     if (g.points_.empty()) {
         std::cerr << "Cannot obtain bounding radius vector end point of null geometry." << std::endl;
         return center;
@@ -413,3 +597,142 @@ SelfContainedGeometry erdblick::offsetGeometryLocally(
     }
     return result;
 }
+
+std::vector<Point> erdblick::simplifyProjectedPolyline(
+    std::vector<Point> const& points,
+    double tolerance,
+    bool closed,
+    bool preserveTopology)
+{
+    // Rings need at least a triangle, lines at least one segment.
+    auto const minPoints = closed ? size_t(3) : size_t(2);
+    if (tolerance <= 0.0 || points.size() <= minPoints) {
+        return points;
+    }
+
+    auto simplified = douglasPeucker(points, tolerance, closed);
+    if (!preserveTopology) {
+        return simplified.size() >= minPoints ? simplified : points;
+    }
+
+    // Shrink the tolerance until simplification no longer introduces a self-intersection.
+    constexpr int kMaxTopologyAttempts = 4;
+    for (int attempt = 0; attempt < kMaxTopologyAttempts; ++attempt) {
+        if (simplified.size() >= minPoints && !hasSelfIntersection2d(simplified, closed)) {
+            return simplified;
+        }
+        tolerance *= .5;
+        simplified = douglasPeucker(points, tolerance, closed);
+    }
+    return points;
+}
+
+std::vector<uint32_t> erdblick::triangulatePolygon(std::vector<Point> const& ring)
+{
+    auto numPoints = ring.size();
+    if (numPoints > 1 && ring.front().x == ring.back().x && ring.front().y == ring.back().y &&
+        ring.front().z == ring.back().z) {
+        // Explicitly closed rings repeat their first vertex; the duplicate is never referenced.
+        --numPoints;
+    }
+    if (numPoints < 3) {
+        return {};
+    }
+
+    auto const projected = projectRingToDominantPlane(ring, numPoints);
+    if (projected.empty()) {
+        return {};
+    }
+
+    // Ear tests below assume a counter-clockwise ring in the projected plane.
+    auto doubleArea = 0.;
+    for (size_t i = 0; i < numPoints; ++i) {
+        auto const& a = projected[i];
+        auto const& b = projected[(i + 1) % numPoints];
+        doubleArea += a.x * b.y - b.x * a.y;
+    }
+    auto const sign = doubleArea < 0. ? -1. : 1.;
+    auto const convexity = [&](size_t a, size_t b, size_t c) {
+        return sign * orientation2d(projected[a], projected[b], projected[c]);
+    };
+
+    std::vector<uint32_t> prev(numPoints);
+    std::vector<uint32_t> next(numPoints);
+    for (size_t i = 0; i < numPoints; ++i) {
+        prev[i] = static_cast<uint32_t>((i + numPoints - 1) % numPoints);
+        next[i] = static_cast<uint32_t>((i + 1) % numPoints);
+    }
+
+    // Only reflex vertices can lie inside a candidate ear of a simple ring.
+    auto const isEar = [&](uint32_t ear) {
+        auto const a = prev[ear];
+        auto const c = next[ear];
+        if (convexity(a, ear, c) <= 0.) {
+            return false;
+        }
+        auto const& pa = projected[sign > 0. ? a : c];
+        auto const& pb = projected[ear];
+        auto const& pc = projected[sign > 0. ? c : a];
+        for (auto v = next[c]; v != a; v = next[v]) {
+            auto const& p = projected[v];
+            if (convexity(prev[v], v, next[v]) > 0. || isSamePoint2d(p, pa) || isSamePoint2d(p, pb) ||
+                isSamePoint2d(p, pc)) {
+                continue;
+            }
+            if (isPointInCcwTriangle2d(p, pa, pb, pc)) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    std::vector<uint32_t> indices;
+    indices.reserve((numPoints - 2) * 3);
+    auto const clip = [&](uint32_t ear) {
+        indices.insert(indices.end(), {prev[ear], ear, next[ear]});
+        next[prev[ear]] = next[ear];
+        prev[next[ear]] = prev[ear];
+    };
+
+    auto remaining = numPoints;
+    uint32_t current = 0;
+    size_t stalled = 0;
+    while (remaining > 3) {
+        if (isEar(current)) {
+            auto const following = next[current];
+            clip(current);
+            current = following;
+            --remaining;
+            stalled = 0;
+            continue;
+        }
+        current = next[current];
+        if (++stalled < remaining) {
+            continue;
+        }
+        // A full lap without an ear: the ring is self-intersecting or has collinear
+        // spikes. Drop a zero-area vertex if there is one, otherwise clip anyway so
+        // the surface is still covered.
+        auto degenerate = current;
+        for (size_t i = 0; i < remaining; ++i, degenerate = next[degenerate]) {
+            if (convexity(prev[degenerate], degenerate, next[degenerate]) == 0.) {
+                break;
+            }
+        }
+        if (convexity(prev[degenerate], degenerate, next[degenerate]) == 0.) {
+            next[prev[degenerate]] = next[degenerate];
+            prev[next[degenerate]] = prev[degenerate];
+            current = next[degenerate];
+        }
+        else {
+            current = next[current];
+            clip(prev[current]);
+        }
+        --remaining;
+        stalled = 0;
+    }
+    if (convexity(prev[current], current, next[current]) != 0.) {
+        clip(current);
+    }
+    return indices;
+}
@@ -232,6 +232,25 @@ std::vector<std::uint8_t> JsValue::toUint8Array() const
 #endif
 }
 
+std::vector<std::uint32_t> JsValue::toUint32Array() const
+{
+#ifdef EMSCRIPTEN
+    return emscripten::convertJSArrayToNumberVector<std::uint32_t>(value_);
+#else
+    std::vector<std::uint32_t> vec;
+    if (value_.is_array()) {
+        vec.reserve(value_.size());
+        for (const auto& element : value_) {
+            if (!element.is_number_unsigned()) {
+                throw std::range_error("Expected unsigned value");
+            }
+            vec.push_back(element.get<std::uint32_t>());
+        }
+    }
+    return vec;
+#endif
+}
+
 std::string JsValue::toString() const {
     switch(type()) {
         case Type::Null:
@@ -1,7 +1,9 @@
 #include "layer.h"
+#include "geometry.h"
 
 #include "mapget/log.h"
 #include "mapget/model/feature.h"
+#include <algorithm>
 #include <iostream>
 
 namespace
@@ -29,11 +31,70 @@ auto findGlbAttachment(std::shared_ptr<mapget::TileFeatureLayer> const& layer) -
     return attachment;
 }
 
+/** Resolve the geometry feature focus helpers should use for one feature. */
+mapget::model_ptr<mapget::Geometry> preferredFeatureGeometry(mapget::model_ptr<mapget::Feature>& feature)
+{
+    mapget::model_ptr<mapget::Geometry> result;
+    if (auto geometryCollection = feature->geomOrNull()) {
+        geometryCollection->forEachGeometryAtPreferredStage(
+            std::nullopt,
+            [&result](auto&& geometry)
+            {
+                result = geometry;
+                return false;
+            });
+        if (!result) {
+            geometryCollection->forEachGeometry(
+                [&result](auto&& geometry)
+                {
+                    result = geometry;
+                    return false;
+                });
+        }
+    }
+    return result;
+}
+
 }
 
 namespace erdblick
 {
 
+FeatureGeometrySummary summarizeFeatureGeometry(mapget::model_ptr<mapget::Feature>& feature)
+{
+    FeatureGeometrySummary result;
+    auto geometry = preferredFeatureGeometry(feature);
+    if (!geometry) {
+        return result;
+    }
+
+    auto const summarizeBox = [&result](mapget::Point const& origin, mapget::Point const& size)
+    {
+        auto const corner = mapget::Point{origin.x + size.x, origin.y + size.y, origin.z + size.z};
+        result.center = {origin.x + size.x * 0.5, origin.y + size.y * 0.5, origin.z + size.z * 0.5};
+        result.boundingRadiusEndPoint = corner;
+    };
+
+    switch (geometry->geomType()) {
+    case mapget::GeomType::AABB:
+        summarizeBox(geometry->aabbOrigin(), geometry->aabbSize());
+        break;
+    case mapget::GeomType::GltfNodeIndex:
+        summarizeBox(geometry->gltfNodeAabbOrigin(), geometry->gltfNodeAabbSize());
+        break;
+    default: {
+        auto const selfContained = geometry->toSelfContained();
+        if (selfContained.points_.empty()) {
+            break;
+        }
+        result.center = geometryCenter(selfContained);
+        result.boundingRadiusEndPoint = boundingRadiusEndPoint(selfContained, result.center);
+        break;
+    }
+    }
+    return result;
+}
+
 /**
  * Constructor accepting a shared pointer to the original `TileFeatureLayer` class.
  * @param self Shared pointer to `mapget::TileFeatureLayer`.
@@ -114,6 +175,8 @@ void TileFeatureLayer::attachOverlay(TileFeatureLayer const& overlay)
         return;
     }
     model_->attachOverlay(overlay.model_);
+    // Overlays may add geometry stages, which changes the preferred geometry of features.
+    *geometrySummaries_ = {};
 }
 
 bool TileFeatureLayer::hasGlbAttachment() const
@@ -155,36 +218,68 @@ int32_t TileFeatureLayer::findFeatureIndex(std::string type, NativeJsValue idPar
     return -1;
 }
 
+int32_t TileFeatureLayer::featureAddressById(std::string const& id) const
+{
+    if (auto result = model_->find(id))
+        return result->addr().index();
+    return -1;
+}
+
 std::string TileFeatureLayer::featureIdByAddress(uint32_t address) const
 {
-    if (address >= model_->numRoots()) {
-        return {};
-    }
-    uint32_t currentIndex = 0;
-    for (auto&& feature : *model_) {
-        if (currentIndex++ != address) {
-            continue;
-        }
+    if (auto feature = featureByAddress(address)) {
         if (auto featureId = feature->id()) {
             return featureId->toString();
         }
-        return {};
     }
     return {};
 }
 
 mapget::model_ptr<mapget::Feature> TileFeatureLayer::featureByAddress(uint32_t address) const
 {
+    // Feature addresses are root indices, so the feature can be addressed directly.
     if (address >= model_->numRoots()) {
         return {};
     }
-    uint32_t currentIndex = 0;
-    for (auto&& feature : *model_) {
-        if (currentIndex++ == address) {
-            return feature;
-        }
+    return model_->at(address);
+}
+
+FeatureGeometrySummary const& TileFeatureLayer::geometrySummary(uint32_t address) const
+{
+    static FeatureGeometrySummary const emptySummary{};
+    if (!model_ || address >= model_->numRoots()) {
+        return emptySummary;
     }
-    return {};
+    auto& table = *geometrySummaries_;
+    if (table.summaries.size() != model_->numRoots()) {
+        table.summaries.resize(model_->numRoots());
+        table.computed.resize(model_->numRoots(), false);
+    }
+    if (!table.computed[address]) {
+        auto feature = model_->at(address);
+        table.summaries[address] = feature ? summarizeFeatureGeometry(feature) : emptySummary;
+        table.computed[address] = true;
+    }
+    return table.summaries[address];
+}
+
+mapget::Point TileFeatureLayer::featureCenter(uint32_t address) const
+{
+    return geometrySummary(address).center;
+}
+
+mapget::Point TileFeatureLayer::featureBoundingRadiusEndPoint(uint32_t address) const
+{
+    return geometrySummary(address).boundingRadiusEndPoint;
+}
+
+NativeJsValue TileFeatureLayer::featureIdsByAddresses(NativeJsValue const& addresses) const
+{
+    auto result = JsValue::List();
+    for (auto const address : JsValue(addresses).toUint32Array()) {
+        result.push(JsValue(featureIdByAddress(address)));
+    }
+    return *result;
 }
 
 TileFeatureLayer::~TileFeatureLayer() = default;
@@ -1,4 +1,5 @@
 #include "rule.h"
+#include <algorithm>
 #include <iostream>
 #include "simfil/value.h"
 #include "search.h"
@@ -65,6 +66,7 @@ FeatureStyleRule::FeatureStyleRule(const FeatureStyleRule& other, bool resetNonI
         type_.reset();
         filter_.clear();
         firstOfRules_.clear();
+        typeMatchCount_ = 1;
     }
 }
 
@@ -226,6 +228,13 @@ void FeatureStyleRule::parse(const YAML::Node& yaml)
         pointMergeGridCellSize_->y = yaml["point-merge-grid-cell"][1].as<double>();
         pointMergeGridCellSize_->z = yaml["point-merge-grid-cell"][2].as<double>();
     }
+    if (yaml["simplify-tolerance"].IsDefined()) {
+        // Maximum screen-space deviation of simplified low-fidelity lines and polygons.
+        simplifyTolerance_ = std::max(0.f, yaml["simplify-tolerance"].as<float>());
+    }
+    if (yaml["simplify-preserve-topology"].IsDefined()) {
+        simplifyPreserveTopology_ = yaml["simplify-preserve-topology"].as<bool>();
+    }
     if (yaml["icon-url"].IsDefined()) {
         iconUrl_ = yaml["icon-url"].as<std::string>();
     }
@@ -402,11 +411,15 @@ void FeatureStyleRule::parse(const YAML::Node& yaml)
             // The sub-rule adopts all attributes except type and filter
             auto& subRule = firstOfRules_.emplace_back(*this, true);
             subRule.parse(yamlSubRule);
+            typeMatchCount_ += subRule.typeMatchCount_;
         }
     }
 }
 
-FeatureStyleRule const* FeatureStyleRule::match(mapget::Feature& feature, BoundEvalFun const& evalFun) const
+FeatureStyleRule const* FeatureStyleRule::match(
+    mapget::Feature& feature,
+    BoundEvalFun const& evalFun,
+    uint8_t const* typeMatches) const
 {
     if (lod_) {
         auto const featureLod = static_cast<uint8_t>(feature.lod());
@@ -415,8 +428,13 @@ FeatureStyleRule const* FeatureStyleRule::match(mapget::Feature& feature, BoundE
         }
     }
 
-    // Filter by feature type regular expression.
-    if (type_) {
+    // Filter by feature type regular expression, unless the outcome is already known.
+    if (typeMatches) {
+        if (!*typeMatches) {
+            return nullptr;
+        }
+    }
+    else if (type_) {
         auto typeId = feature.typeId();
         if (!std::regex_match(typeId.begin(), typeId.end(), *type_)) {
             return nullptr;
@@ -443,10 +461,14 @@ FeatureStyleRule const* FeatureStyleRule::match(mapget::Feature& feature, BoundE
 
     // Return matching sub-rule or this.
     if (!firstOfRules_.empty()) {
+        auto const* subRuleTypeMatches = typeMatches ? typeMatches + 1 : nullptr;
         for (auto const& rule : firstOfRules_) {
-            if (auto matchingRule = rule.match(feature, evalFun)) {
+            if (auto matchingRule = rule.match(feature, evalFun, subRuleTypeMatches)) {
                 return matchingRule;
             }
+            if (subRuleTypeMatches) {
+                subRuleTypeMatches += rule.typeMatchCount_;
+            }
         }
         return nullptr;
     }
@@ -474,6 +496,19 @@ bool FeatureStyleRule::maybeMatchesType(std::string_view typeId) const
     return true;
 }
 
+void FeatureStyleRule::collectTypeMatches(std::string_view typeId, std::vector<uint8_t>& typeMatches) const
+{
+    typeMatches.push_back(!type_ || std::regex_match(typeId.begin(), typeId.end(), *type_));
+    for (auto const& rule : firstOfRules_) {
+        rule.collectTypeMatches(typeId, typeMatches);
+    }
+}
+
+uint32_t FeatureStyleRule::typeMatchCount() const
+{
+    return typeMatchCount_;
+}
+
 uint32_t FeatureStyleRule::geometryTypesMask() const
 {
     return geometryTypes_;
@@ -787,6 +822,26 @@ std::optional<glm::dvec3> const& FeatureStyleRule::pointMergeGridCellSize() cons
     return pointMergeGridCellSize_;
 }
 
+bool FeatureStyleRule::mergesPoints() const
+{
+    if (pointMergeGridCellSize_) {
+        return true;
+    }
+    return std::ranges::any_of(firstOfRules_, [](auto const& subRule) {
+        return subRule.pointMergeGridCellSize().has_value();
+    });
+}
+
+float FeatureStyleRule::simplifyTolerance() const
+{
+    return simplifyTolerance_;
+}
+
+bool FeatureStyleRule::simplifyPreserveTopology() const
+{
+    return simplifyPreserveTopology_;
+}
+
 bool FeatureStyleRule::hasIconUrl() const
 {
     return !iconUrl_.empty() || !iconUrlExpression_.empty();
@@ -832,6 +887,32 @@ std::optional<bool> const& FeatureStyleRule::attributeValidityGeometry() const
     return attributeValidityGeometry_;
 }
 
+std::vector<FeatureStyleRule> const& FeatureStyleRule::firstOfRules() const
+{
+    return firstOfRules_;
+}
+
+void FeatureStyleRule::forEachExpression(std::function<void(std::string const&)> const& callback) const
+{
+    for (auto const* expression : {
+             &filter_, &colorExpression_, &arrowExpression_, &labelTextExpression_, &iconUrlExpression_}) {
+        if (!expression->empty()) {
+            callback(*expression);
+        }
+    }
+    if (attributeFilter_ && !attributeFilter_->empty()) {
+        callback(*attributeFilter_);
+    }
+    for (auto const& subStyle : {relationLineEndMarkerStyle_, relationSourceStyle_, relationTargetStyle_}) {
+        if (subStyle) {
+            subStyle->forEachExpression(callback);
+        }
+    }
+    for (auto const& subRule : firstOfRules_) {
+        subRule.forEachExpression(callback);
+    }
+}
+
 uint32_t const& FeatureStyleRule::index() const
 {
     return index_;
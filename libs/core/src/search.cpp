@@ -55,7 +55,7 @@ erdblick::NativeJsValue erdblick::FeatureLayerSearch::filter(const std::string&
         auto jsResultForFeature = JsValue::List();
         jsResultForFeature.push(JsValue(mapTileKey));
         jsResultForFeature.push(JsValue(feature->id()->toString()));
-        auto geometryCenterPoint = geometryCenter(feature->preferredGeometry());
+        auto geometryCenterPoint = tfl_.featureCenter(feature->addr().index());
         jsResultForFeature.push(JsValue::Dict({
             {"cartesian", JsValue(wgsToCartesian<mapget::Point>(geometryCenterPoint))},
             {"cartographic", JsValue(geometryCenterPoint)}
@@ -623,6 +623,7 @@ bool validateStyleRuleYaml(
     }
 
     markInvalid(validateNumericRange(ruleYaml, "opacity", 0.0, 1.0, rulePath, report, sourceRuleIndex));
+    markInvalid(validateNumericRange(ruleYaml, "simplify-tolerance", 0.0, 64.0, rulePath, report, sourceRuleIndex));
     markInvalid(validateRegexValue(ruleYaml, "type", rulePath, report, sourceRuleIndex));
     markInvalid(validateRegexValue(ruleYaml, "relation-type", rulePath, report, sourceRuleIndex));
     markInvalid(validateRegexValue(ruleYaml, "attribute-type", rulePath, report, sourceRuleIndex));
@@ -3,6 +3,7 @@
 #include <regex>
 
 #include "yaml-cpp/yaml.h"
+#include "mapget/model/simfilutil.h"
 #include "simfil/simfil.h"
 #include "simfil/model/nodes.h"
 
@@ -24,6 +25,61 @@ constexpr size_t fidelityIndex(FeatureStyleRule::Fidelity fidelity) {
 
 /** Shared empty vector returned when no rule candidates apply. */
 const std::vector<uint32_t> kEmptyRuleIndices{};
+
+/**
+ * Append the ids of all options read by a simfil expression to `result`. The expression is
+ * compiled in `environment`, which starts without option constants. Options are environment
+ * constants at render time, so the expression reads an option if binding it as a constant
+ * changes the compiled expression, or if the compiled expression looks it up by a string
+ * literal (e.g. `_["option-id"]`). This may over-report, e.g. for string comparisons with an
+ * option id, but never misses a read. Ids looked up by a string literal are also appended
+ * to `contextReads`, since only the evaluation context can answer such lookups.
+ */
+void collectOptionReferences(
+    std::string const& expression,
+    std::vector<FeatureStyleOption> const& options,
+    simfil::Environment& environment,
+    std::vector<std::string>& result,
+    std::vector<std::string>& contextReads)
+{
+    auto compiledForm = [&]() -> std::optional<std::string> {
+        auto ast = simfil::compile(environment, expression, false, false);
+        if (!ast) {
+            return std::nullopt;
+        }
+        return (*ast)->expr().toString();
+    };
+    auto const unbound = compiledForm();
+    if (!unbound) {
+        // Expressions which do not compile are never evaluated.
+        return;
+    }
+
+    // The probe value does not matter: a bound option compiles into a constant or is folded.
+    auto const probe = simfil::Value::make(false);
+    auto addOnce = [](std::vector<std::string>& ids, std::string const& id) {
+        if (std::ranges::find(ids, id) == ids.end()) {
+            ids.push_back(id);
+        }
+    };
+    for (auto const& option : options) {
+        if (unbound->find('"' + option.id_ + '"') != std::string::npos ||
+            unbound->find('\'' + option.id_ + '\'') != std::string::npos) {
+            addOnce(result, option.id_);
+            addOnce(contextReads, option.id_);
+            continue;
+        }
+        if (std::ranges::find(result, option.id_) != result.end()) {
+            continue;
+        }
+        environment.constants.insert_or_assign(option.id_, probe);
+        auto const bound = compiledForm();
+        environment.constants.erase(option.id_);
+        if (bound != unbound) {
+            result.push_back(option.id_);
+        }
+    }
+}
 }
 
 FeatureLayerStyle::FeatureLayerStyle(SharedUint8Array const& yamlArray)
@@ -206,8 +262,21 @@ FeatureLayerStyle::FeatureLayerStyle(SharedUint8Array const& yamlArray)
         return;
     }
 
+    optionDependenciesByRule_.resize(rules_.size());
+    auto const dependencyEnvironment = options_.empty() ?
+        nullptr : mapget::makeEnvironment(simfil::Environment::WithNewStringCache);
     for (uint32_t runtimeRuleIndex = 0; runtimeRuleIndex < rules_.size(); ++runtimeRuleIndex) {
         auto const& rule = rules_[runtimeRuleIndex];
+        if (dependencyEnvironment) {
+            rule.forEachExpression([&](std::string const& expression) {
+                collectOptionReferences(
+                    expression,
+                    options_,
+                    *dependencyEnvironment,
+                    optionDependenciesByRule_[runtimeRuleIndex],
+                    contextOptionIds_);
+            });
+        }
         auto modeIndex = highlightModeIndex(rule.mode());
         auto const highFidelityIndex = fidelityIndex(FeatureStyleRule::HighFidelity);
         auto const lowFidelityIndex = fidelityIndex(FeatureStyleRule::LowFidelity);
@@ -294,6 +363,25 @@ bool FeatureLayerStyle::hasRelationRules(FeatureStyleRule::HighlightMode mode) c
     });
 }
 
+std::vector<std::string> const& FeatureLayerStyle::contextOptionIds() const
+{
+    return contextOptionIds_;
+}
+
+bool FeatureLayerStyle::optionAffectsHighlightMode(
+    std::string const& optionId,
+    FeatureStyleRule::HighlightMode mode) const
+{
+    for (uint32_t ruleIndex = 0; ruleIndex < rules_.size(); ++ruleIndex) {
+        if (rules_[ruleIndex].mode() == mode &&
+            std::ranges::find(optionDependenciesByRule_[ruleIndex], optionId) !=
+                optionDependenciesByRule_[ruleIndex].end()) {
+            return true;
+        }
+    }
+    return false;
+}
+
 std::vector<uint32_t> const& FeatureLayerStyle::candidateRuleIndices(
     FeatureStyleRule::HighlightMode mode,
     FeatureStyleRule::Fidelity fidelity,
@@ -307,27 +395,104 @@ std::vector<uint32_t> const& FeatureLayerStyle::candidateRuleIndices(
     if (featureTypeId.empty()) {
         return ruleIndicesByModeAndFidelity_[modeIndex][fidelityIdx];
     }
+    return typeCacheEntry(featureTypeId).byModeAndFidelity[modeIndex][fidelityIdx];
+}
 
+FeatureLayerStyle::RuleTypeMatches const& FeatureLayerStyle::ruleTypeMatches(std::string_view featureTypeId) const
+{
+    return typeCacheEntry(featureTypeId).typeMatches;
+}
+
+FeatureLayerStyle::RuleIndexCacheEntry const& FeatureLayerStyle::typeCacheEntry(std::string_view featureTypeId) const
+{
     auto cacheIt = ruleIndicesByTypeCache_.find(featureTypeId);
-    if (cacheIt == ruleIndicesByTypeCache_.end()) {
-        RuleIndexCacheEntry entry{};
-        for (size_t cacheModeIndex = 0; cacheModeIndex < kHighlightModeCount; ++cacheModeIndex) {
-            for (size_t cacheFidelityIndex = 0; cacheFidelityIndex < kFidelityCount; ++cacheFidelityIndex) {
-                auto const& ruleIndices = ruleIndicesByModeAndFidelity_[cacheModeIndex][cacheFidelityIndex];
-                auto& filtered = entry.byModeAndFidelity[cacheModeIndex][cacheFidelityIndex];
-                filtered.reserve(ruleIndices.size());
-                for (auto ruleIndex : ruleIndices) {
-                    if (rules_[ruleIndex].maybeMatchesType(featureTypeId)) {
-                        filtered.push_back(ruleIndex);
-                    }
+    if (cacheIt != ruleIndicesByTypeCache_.end()) {
+        return cacheIt->second;
+    }
+
+    RuleIndexCacheEntry entry{};
+    // Evaluate each type regex once per feature type; match() reads the outcome from here.
+    entry.typeMatches.offsetByRule.reserve(rules_.size());
+    for (auto const& rule : rules_) {
+        entry.typeMatches.offsetByRule.push_back(static_cast<uint32_t>(entry.typeMatches.decisions.size()));
+        rule.collectTypeMatches(featureTypeId, entry.typeMatches.decisions);
+    }
+    for (size_t cacheModeIndex = 0; cacheModeIndex < kHighlightModeCount; ++cacheModeIndex) {
+        for (size_t cacheFidelityIndex = 0; cacheFidelityIndex < kFidelityCount; ++cacheFidelityIndex) {
+            auto const& ruleIndices = ruleIndicesByModeAndFidelity_[cacheModeIndex][cacheFidelityIndex];
+            auto& filtered = entry.byModeAndFidelity[cacheModeIndex][cacheFidelityIndex];
+            filtered.reserve(ruleIndices.size());
+            for (auto ruleIndex : ruleIndices) {
+                if (rules_[ruleIndex].maybeMatchesType(featureTypeId)) {
+                    filtered.push_back(ruleIndex);
                 }
             }
         }
-        auto [insertIt, _] = ruleIndicesByTypeCache_.emplace(std::string(featureTypeId), std::move(entry));
-        cacheIt = insertIt;
     }
+    auto [insertIt, _] = ruleIndicesByTypeCache_.emplace(std::string(featureTypeId), std::move(entry));
+    return insertIt->second;
+}
+
+std::shared_ptr<StyleExpressionScope> FeatureLayerStyle::expressionScope(
+    std::shared_ptr<simfil::StringPool> const& sourceStrings,
+    std::map<std::string, simfil::Value> const& optionValues) const
+{
+    if (!sourceStrings) {
+        return {};
+    }
+
+    // Option values become environment constants, which the compiler may fold into the AST.
+    // Keys and values are length-prefixed, so no value content can make two fingerprints equal.
+    std::string optionsKey;
+    for (auto const& [key, value] : optionValues) {
+        auto const valueString = value.toString();
+        optionsKey.append(std::to_string(key.size())).append(":").append(key);
+        optionsKey.append(std::to_string(valueString.size())).append(":").append(valueString);
+    }
+
+    // Scopes of dead dictionaries can never be used again.
+    expressionScopes_.remove_if([](auto const& entry) { return entry.scope_->sourceStrings_.expired(); });
 
-    return cacheIt->second.byModeAndFidelity[modeIndex][fidelityIdx];
+    auto const sourceHighestStringId = static_cast<size_t>(sourceStrings->highest());
+    auto entry = std::ranges::find_if(expressionScopes_, [&](auto const& candidate) {
+        return candidate.optionsKey_ == optionsKey && candidate.scope_->sourceStrings_.lock() == sourceStrings;
+    });
+    if (entry != expressionScopes_.end()) {
+        expressionScopes_.splice(expressionScopes_.begin(), expressionScopes_, entry);
+        auto const& cached = expressionScopes_.front().scope_;
+        if (cached->sourceHighestStringId_ >= sourceHighestStringId) {
+            return cached;
+        }
+        // The dictionary has grown past the snapshot; the fresh scope supersedes this one.
+        expressionScopes_.pop_front();
+    }
+
+    auto scope = expressionScopeForPool(std::make_shared<simfil::StringPool>(*sourceStrings), optionValues);
+    scope->sourceStrings_ = sourceStrings;
+    scope->sourceHighestStringId_ = sourceHighestStringId;
+    expressionScopes_.push_front({std::move(optionsKey), scope});
+    if (expressionScopes_.size() > kMaxExpressionScopes) {
+        expressionScopes_.pop_back();
+    }
+    return scope;
+}
+
+std::shared_ptr<StyleExpressionScope> FeatureLayerStyle::expressionScopeForPool(
+    std::shared_ptr<simfil::StringPool> const& strings,
+    std::map<std::string, simfil::Value> const& optionValues) const
+{
+    auto scope = std::make_shared<StyleExpressionScope>();
+    scope->strings_ = strings;
+    scope->environment_ = mapget::makeEnvironment(scope->strings_);
+    for (auto const& [key, value] : optionValues) {
+        scope->environment_->constants.insert_or_assign(key, value);
+    }
+    return scope;
+}
+
+size_t FeatureLayerStyle::numExpressionScopes() const
+{
+    return expressionScopes_.size();
 }
 
 FeatureStyleOption::FeatureStyleOption(const YAML::Node& yaml)
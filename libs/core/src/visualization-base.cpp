@@ -6,11 +6,13 @@
 #include <algorithm>
 #include <charconv>
 #include <chrono>
+#include <cmath>
 #include <deque>
 #include <iostream>
 #include <regex>
 #include <type_traits>
 #include <unordered_map>
+#include <variant>
 
 using namespace mapget;
 
@@ -43,6 +45,26 @@ mapget::Point offsetAabbOriginLocally(
     return shiftedOrigin.points_.front();
 }
 
+/** Grid cell containing a cartographic point for the given merge cell size. */
+std::array<int64_t, 3> mergeGridCell(mapget::Point const& pointCartographic, glm::dvec3 const& gridCellSize)
+{
+    auto const gridPosition = pointCartographic / gridCellSize;
+    return {
+        static_cast<int64_t>(glm::floor(gridPosition.x)),
+        static_cast<int64_t>(glm::floor(gridPosition.y)),
+        static_cast<int64_t>(glm::floor(gridPosition.z))};
+}
+
+/** Pack a merge grid cell into a 64-bit key (22 bits x, 22 bits y, 20 bits z). */
+uint64_t packMergeGridCell(std::array<int64_t, 3> const& cell)
+{
+    constexpr uint64_t xyMask = (1ull << 22) - 1;
+    constexpr uint64_t zMask = (1ull << 20) - 1;
+    return ((static_cast<uint64_t>(cell[0]) & xyMask) << 42) |
+           ((static_cast<uint64_t>(cell[1]) & xyMask) << 20) |
+           (static_cast<uint64_t>(cell[2]) & zMask);
+}
+
 /** Parsed hover id broken down into the base feature and optional attribute/validity indices. */
 struct ParsedHoverAttributeId {
     std::string_view baseFeatureId_;
@@ -140,13 +162,31 @@ model_ptr<Feature> findFeatureAcrossTiles(
     return {};
 }
 
-/** Convenience overload for callers that currently hold owned id-part strings. */
-model_ptr<Feature> findFeatureAcrossTiles(
-    std::vector<mapget::TileFeatureLayer::Ptr> const& tiles,
-    std::string_view typeId,
-    KeyValuePairs const& featureId)
+/**
+ * Build the hash-index key of a feature id: type id plus id parts, with each value tagged by
+ * kind. Without values, the key only describes the id form: type id, part names and kinds.
+ */
+std::string featureIdIndexKey(std::string_view typeId, KeyValueViewPairs const& idParts, bool withValues = true)
 {
-    return findFeatureAcrossTiles(tiles, typeId, castToKeyValueView(featureId));
+    std::string key(typeId);
+    for (auto const& [partName, partValue] : idParts) {
+        key.push_back('\0');
+        key.append(partName);
+        std::visit([&key, withValues](auto const& value) {
+            if constexpr (std::is_arithmetic_v<std::decay_t<decltype(value)>>) {
+                key.push_back('\1');
+                if (withValues) {
+                    key.append(std::to_string(value));
+                }
+            } else {
+                key.push_back('\2');
+                if (withValues) {
+                    key.append(value);
+                }
+            }
+        }, partValue);
+    }
+    return key;
 }
 
 uint64_t runtimeIssueNowMillis()
@@ -218,8 +258,7 @@ void FeatureLayerVisualizationBase::RelationStyleState::addRelation(
     }
 
     auto targetFeature =
-        findFeatureAcrossTiles(
-            visualization_.allTiles_,
+        visualization_.findFeatureInAddedTiles(
             targetRef->typeId(),
             targetRef->keyValuePairs());
 
@@ -370,18 +409,11 @@ void FeatureLayerVisualizationBase::RelationStyleState::render(RelationToVisuali
     auto const& source = static_cast<mapget::Feature const&>(*relationToRender.sourceFeature_);
     auto const& target = static_cast<mapget::Feature const&>(*relationToRender.targetFeature_);
 
-    auto relationContext =
-        simfil::model_ptr<simfil::OverlayNode>::make(simfil::Value::field(relation));
-    visualization_.addOptionsToSimfilContext(relationContext);
-    relationContext->set(
-        visualization_.internalStringPoolCopy_->emplace("$source").value(),
-        simfil::Value::field(source));
-    relationContext->set(
-        visualization_.internalStringPoolCopy_->emplace("$target").value(),
-        simfil::Value::field(target));
-    relationContext->set(
-        visualization_.internalStringPoolCopy_->emplace("$twoway").value(),
-        simfil::Value(relationToRender.twoway_));
+    auto const& fieldIds = visualization_.contextFieldIds_;
+    auto relationContext = visualization_.makeEvaluationContext(simfil::Value::field(relation));
+    relationContext->set(fieldIds.source_, simfil::Value::field(source));
+    relationContext->set(fieldIds.target_, simfil::Value::field(target));
+    relationContext->set(fieldIds.twoway_, simfil::Value(relationToRender.twoway_));
 
     auto boundEvalFun = BoundEvalFun{
         relationContext,
@@ -465,7 +497,6 @@ void FeatureLayerVisualizationBase::RelationStyleState::render(RelationToVisuali
                 sourceGeometry.stage_,
                 FeatureLayerVisualizationBase::kUnselectableFeatureId,
                 *sourceStyle,
-                "",
                 boundEvalFun,
                 sourceStyle->offset());
         }
@@ -482,7 +513,6 @@ void FeatureLayerVisualizationBase::RelationStyleState::render(RelationToVisuali
                 targetGeometry.stage_,
                 FeatureLayerVisualizationBase::kUnselectableFeatureId,
                 *targetStyle,
-                "",
                 boundEvalFun,
                 targetStyle->offset());
         }
@@ -551,6 +581,116 @@ FeatureLayerVisualizationBase::FeatureLayerVisualizationBase(
 
 FeatureLayerVisualizationBase::~FeatureLayerVisualizationBase() = default;
 
+void FeatureLayerVisualizationBase::setFeatureAddressSubset(
+    NativeJsValue const& featureAddresses,
+    NativeJsValue const& attributeIndices,
+    NativeJsValue const& validityIndices)
+{
+    auto readIndices = [](NativeJsValue const& rawIndices) {
+        auto indices = JsValue(rawIndices);
+        if (indices.type() != JsValue::Type::ObjectOrList) {
+            return std::vector<uint32_t>{};
+        }
+        return indices.toUint32Array();
+    };
+    auto const addresses = readIndices(featureAddresses);
+    auto const attributes = readIndices(attributeIndices);
+    auto const validities = readIndices(validityIndices);
+
+    // The address subset supersedes the id subset, so drop any id-based filters.
+    featureIdSubset_.clear();
+    featureIdBaseSubset_.clear();
+    hoveredAttributeSubsetsByFeatureId_.clear();
+    featureAddressSubset_.clear();
+    wholeFeatureAddressSubset_.clear();
+    hoveredAttributeSubsetsByAddress_.clear();
+
+    featureAddressSubset_.reserve(addresses.size());
+    for (size_t i = 0; i < addresses.size(); ++i) {
+        auto const address = addresses[i];
+        featureAddressSubset_.push_back(address);
+        auto const attributeIndex = i < attributes.size() ? attributes[i] : kWholeSubsetEntry;
+        if (attributeIndex == kWholeSubsetEntry) {
+            wholeFeatureAddressSubset_.insert(address);
+            continue;
+        }
+        auto& hoveredAttributes = hoveredAttributeSubsetsByAddress_[address];
+        auto const validityIndex = i < validities.size() ? validities[i] : kWholeSubsetEntry;
+        if (validityIndex == kWholeSubsetEntry) {
+            hoveredAttributes.hoveredAttributeIndices_.insert(attributeIndex);
+        }
+        else {
+            hoveredAttributes.hoveredValidityIndicesByAttribute_[attributeIndex].insert(validityIndex);
+        }
+    }
+    std::sort(featureAddressSubset_.begin(), featureAddressSubset_.end());
+    featureAddressSubset_.erase(
+        std::unique(featureAddressSubset_.begin(), featureAddressSubset_.end()),
+        featureAddressSubset_.end());
+}
+
+void FeatureLayerVisualizationBase::setFeatureAddressRange(uint32_t begin, uint32_t end)
+{
+    featureAddressRangeBegin_ = begin;
+    featureAddressRangeEnd_ = std::max(begin, end);
+}
+
+bool FeatureLayerVisualizationBase::hasFeatureSubset() const
+{
+    return !featureIdBaseSubset_.empty() || !featureAddressSubset_.empty();
+}
+
+void FeatureLayerVisualizationBase::forEachFeatureInSubset(
+    std::function<void(mapget::model_ptr<mapget::Feature>&)> const& fn)
+{
+    if (!featureAddressSubset_.empty()) {
+        auto const numRoots = tile_->numRoots();
+        for (auto const address : featureAddressSubset_) {
+            if (address >= numRoots) {
+                continue;
+            }
+            if (auto feature = tile_->at(address)) {
+                fn(feature);
+            }
+        }
+        return;
+    }
+    if (!featureIdBaseSubset_.empty()) {
+        for (auto const& featureId : featureIdBaseSubset_) {
+            if (auto feature = tile_->find(featureId)) {
+                fn(feature);
+            }
+        }
+        return;
+    }
+    auto const numRoots = static_cast<uint32_t>(tile_->numRoots());
+    if (featureAddressRangeBegin_ == 0 && featureAddressRangeEnd_ >= numRoots) {
+        for (auto&& feature : *tile_) {
+            fn(feature);
+        }
+        return;
+    }
+    auto const end = std::min(featureAddressRangeEnd_, numRoots);
+    for (auto address = featureAddressRangeBegin_; address < end; ++address) {
+        if (auto feature = tile_->at(address)) {
+            fn(feature);
+        }
+    }
+}
+
+FeatureLayerVisualizationBase::HoveredAttributeSubset const*
+FeatureLayerVisualizationBase::hoveredAttributeSubset(
+    uint32_t featureAddress,
+    std::function<std::string const&()> const& resolveFeatureId) const
+{
+    if (!featureAddressSubset_.empty()) {
+        auto const found = hoveredAttributeSubsetsByAddress_.find(featureAddress);
+        return found != hoveredAttributeSubsetsByAddress_.end() ? &found->second : nullptr;
+    }
+    auto const found = hoveredAttributeSubsetsByFeatureId_.find(resolveFeatureId());
+    return found != hoveredAttributeSubsetsByFeatureId_.end() ? &found->second : nullptr;
+}
+
 NativeJsValue FeatureLayerVisualizationBase::externalRelationReferences() const
 {
     return *externalRelationReferences_;
@@ -601,7 +741,7 @@ void FeatureLayerVisualizationBase::processResolvedExternalReferences(
         auto const featureId = JsValue(firstResolution["featureId"]).toKeyValuePairs();
         #endif
 
-        auto targetFeature = findFeatureAcrossTiles(allTiles_, typeId, featureId);
+        auto targetFeature = findFeatureInAddedTiles(typeId, castToKeyValueView(featureId));
         if (!targetFeature) {
             std::cout << "Resolved target feature was not found in aux tiles!" << std::endl;
             continue;
@@ -643,11 +783,19 @@ std::string FeatureLayerVisualizationBase::makeMapLayerStyleRuleId(uint32_t rule
     return {};
 }
 
+std::string_view FeatureLayerVisualizationBase::mapLayerStyleRuleId(uint32_t ruleIndex) const
+{
+    if (ruleIndex < mapLayerStyleRuleIds_.size()) {
+        return mapLayerStyleRuleIds_[ruleIndex];
+    }
+    return {};
+}
+
 void FeatureLayerVisualizationBase::onRelationStyle(
     model_ptr<Feature>& feature,
     BoundEvalFun& evalFun,
     FeatureStyleRule const& rule,
-    std::string const& mapLayerStyleRuleId)
+    std::string_view mapLayerStyleRuleId)
 {
     (void) evalFun;
     (void) mapLayerStyleRuleId;
@@ -664,6 +812,40 @@ bool FeatureLayerVisualizationBase::bypassLowFiMaxLodFilter() const
     return false;
 }
 
+double FeatureLayerVisualizationBase::projectedUnitsPerPixel() const
+{
+    return 0.;
+}
+
+void FeatureLayerVisualizationBase::projectWgsPoints(
+    std::span<mapget::Point const> wgsPoints,
+    std::vector<mapget::Point>& projected) const
+{
+    projected.reserve(projected.size() + wgsPoints.size());
+    for (auto const& wgsPoint : wgsPoints) {
+        projected.emplace_back(projectWgsPoint(wgsPoint));
+    }
+}
+
+void FeatureLayerVisualizationBase::simplifyForLowFidelity(
+    std::vector<mapget::Point>& vertsProjected,
+    FeatureStyleRule const& rule,
+    bool closed) const
+{
+    if (fidelity_ != FeatureStyleRule::LowFidelity || rule.simplifyTolerance() <= 0.f) {
+        return;
+    }
+    auto const unitsPerPixel = projectedUnitsPerPixel();
+    if (unitsPerPixel <= 0.) {
+        return;
+    }
+    vertsProjected = simplifyProjectedPolyline(
+        vertsProjected,
+        static_cast<double>(rule.simplifyTolerance()) * unitsPerPixel,
+        closed,
+        rule.simplifyPreserveTopology());
+}
+
 void FeatureLayerVisualizationBase::emitPolygon(
     std::vector<mapget::Point> const& vertsCartesian,
     FeatureStyleRule const& rule,
@@ -702,48 +884,23 @@ void FeatureLayerVisualizationBase::emitAabb(
     auto const maxY = originWgs.y + sizeWgs.y;
     auto const maxZ = originWgs.z + sizeWgs.z;
 
-    auto const p000 = mapget::Point{minX, minY, minZ};
-    auto const p001 = mapget::Point{minX, minY, maxZ};
-    auto const p010 = mapget::Point{minX, maxY, minZ};
-    auto const p011 = mapget::Point{minX, maxY, maxZ};
-    auto const p100 = mapget::Point{maxX, minY, minZ};
-    auto const p101 = mapget::Point{maxX, minY, maxZ};
-    auto const p110 = mapget::Point{maxX, maxY, minZ};
-    auto const p111 = mapget::Point{maxX, maxY, maxZ};
+    auto const p000 = projectWgsPoint({minX, minY, minZ});
+    auto const p001 = projectWgsPoint({minX, minY, maxZ});
+    auto const p010 = projectWgsPoint({minX, maxY, minZ});
+    auto const p011 = projectWgsPoint({minX, maxY, maxZ});
+    auto const p100 = projectWgsPoint({maxX, minY, minZ});
+    auto const p101 = projectWgsPoint({maxX, minY, maxZ});
+    auto const p110 = projectWgsPoint({maxX, maxY, minZ});
+    auto const p111 = projectWgsPoint({maxX, maxY, maxZ});
 
+    // One mesh for all six faces, so indexed mesh buffers can share the eight corners.
     emitMesh(
-        {projectWgsPoint(p000), projectWgsPoint(p100), projectWgsPoint(p110),
-         projectWgsPoint(p000), projectWgsPoint(p110), projectWgsPoint(p010)},
-        rule,
-        tileFeatureId,
-        evalFun);
-    emitMesh(
-        {projectWgsPoint(p001), projectWgsPoint(p011), projectWgsPoint(p111),
-         projectWgsPoint(p001), projectWgsPoint(p111), projectWgsPoint(p101)},
-        rule,
-        tileFeatureId,
-        evalFun);
-    emitMesh(
-        {projectWgsPoint(p000), projectWgsPoint(p001), projectWgsPoint(p101),
-         projectWgsPoint(p000), projectWgsPoint(p101), projectWgsPoint(p100)},
-        rule,
-        tileFeatureId,
-        evalFun);
-    emitMesh(
-        {projectWgsPoint(p010), projectWgsPoint(p110), projectWgsPoint(p111),
-         projectWgsPoint(p010), projectWgsPoint(p111), projectWgsPoint(p011)},
-        rule,
-        tileFeatureId,
-        evalFun);
-    emitMesh(
-        {projectWgsPoint(p000), projectWgsPoint(p010), projectWgsPoint(p011),
-         projectWgsPoint(p000), projectWgsPoint(p011), projectWgsPoint(p001)},
-        rule,
-        tileFeatureId,
-        evalFun);
-    emitMesh(
-        {projectWgsPoint(p100), projectWgsPoint(p101), projectWgsPoint(p111),
-         projectWgsPoint(p100), projectWgsPoint(p111), projectWgsPoint(p110)},
+        {p000, p100, p110, p000, p110, p010,
+         p001, p011, p111, p001, p111, p101,
+         p000, p001, p101, p000, p101, p100,
+         p010, p110, p111, p010, p111, p011,
+         p000, p010, p011, p000, p011, p001,
+         p100, p101, p111, p100, p111, p110},
         rule,
         tileFeatureId,
         evalFun);
@@ -803,6 +960,34 @@ void FeatureLayerVisualizationBase::emitLabel(
     (void) evalFun;
 }
 
+void FeatureLayerVisualizationBase::emitPoint(
+    mapget::Point const& xyzPos,
+    FeatureStyleRule const& rule,
+    uint32_t tileFeatureId,
+    BoundEvalFun& evalFun)
+{
+    emitPoint(JsValue(xyzPos), rule, tileFeatureId, evalFun);
+}
+
+void FeatureLayerVisualizationBase::emitIcon(
+    mapget::Point const& xyzPos,
+    FeatureStyleRule const& rule,
+    uint32_t tileFeatureId,
+    BoundEvalFun& evalFun)
+{
+    emitIcon(JsValue(xyzPos), rule, tileFeatureId, evalFun);
+}
+
+void FeatureLayerVisualizationBase::emitLabel(
+    mapget::Point const& xyzPos,
+    std::string const& text,
+    FeatureStyleRule const& rule,
+    uint32_t tileFeatureId,
+    BoundEvalFun& evalFun)
+{
+    emitLabel(JsValue(xyzPos), text, rule, tileFeatureId, evalFun);
+}
+
 void FeatureLayerVisualizationBase::emitSolidPolyLine(
     JsValue const& jsVerts,
     FeatureStyleRule const& rule,
@@ -884,7 +1069,34 @@ void FeatureLayerVisualizationBase::addTileFeatureLayer(TileFeatureLayer const&
 {
     if (!tile_) {
         tile_ = tile.model_;
-        internalStringPoolCopy_ = std::make_shared<simfil::StringPool>(*tile.model_->strings());
+        if (sharedStringPool_) {
+            expressionScope_ = style_.expressionScopeForPool(sharedStringPool_, optionValues_);
+            internalStringPoolCopy_ = sharedStringPool_;
+        }
+        else {
+            // Visualizations of the same style and field dictionary share one dictionary copy,
+            // so that they can also share compiled expressions.
+            expressionScope_ = style_.expressionScope(tile.model_->strings(), optionValues_);
+            internalStringPoolCopy_ = expressionScope_
+                ? expressionScope_->strings_
+                : std::make_shared<simfil::StringPool>(*tile.model_->strings());
+        }
+        resolveContextFieldIds();
+
+        // Rule ids only depend on the first tile's map/layer, so format them once up front.
+        // The table is indexed by source rule index, which skips rules that failed to parse.
+        // Batches keep the table as long as the tiles belong to the same map layer.
+        auto ruleIdsSource = std::pair(tile_->mapId(), tile_->layerInfo()->layerId_);
+        if (mapLayerStyleRuleIds_.empty() || ruleIdsSource != mapLayerStyleRuleIdsSource_) {
+            mapLayerStyleRuleIds_.clear();
+            if (!style_.rules().empty()) {
+                mapLayerStyleRuleIds_.resize(style_.rules().back().index() + 1U);
+            }
+            for (auto const& rule : style_.rules()) {
+                mapLayerStyleRuleIds_[rule.index()] = makeMapLayerStyleRuleId(rule.index());
+            }
+            mapLayerStyleRuleIdsSource_ = std::move(ruleIdsSource);
+        }
     }
 
     // Ensure that the added aux tile and the primary tile use the same field name encoding.
@@ -892,102 +1104,246 @@ void FeatureLayerVisualizationBase::addTileFeatureLayer(TileFeatureLayer const&
     allTiles_.emplace_back(tile.model_);
 }
 
+void FeatureLayerVisualizationBase::setSharedStringPool(std::shared_ptr<simfil::StringPool> strings)
+{
+    sharedStringPool_ = std::move(strings);
+}
+
+FeatureLayerVisualizationBase::PendingRun::PendingRun(
+    simfil::model_ptr<simfil::OverlayNode> placeholderContext)
+    : placeholderContext_(placeholderContext), boundEvalFun_{std::move(placeholderContext), {}, {}}
+{
+}
+
 void FeatureLayerVisualizationBase::run()
+{
+    runFor(std::numeric_limits<double>::infinity());
+}
+
+bool FeatureLayerVisualizationBase::runFor(double budgetMicros)
 {
     if (!tile_) {
+        return false;
+    }
+    if (!pendingRun_) {
+        beginRun();
+    }
+
+    std::optional<std::chrono::steady_clock::time_point> deadline;
+    if (std::isfinite(budgetMicros)) {
+        deadline = std::chrono::steady_clock::now()
+            + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double, std::micro>(std::max(budgetMicros, 0.)));
+    }
+    auto& pending = *pendingRun_;
+    auto const numRoots = tile_->numRoots();
+    while (pending.position_ < pending.end_) {
+        auto const address = pending.featureAddresses_.empty()
+            ? static_cast<uint32_t>(pending.position_)
+            : pending.featureAddresses_[pending.position_];
+        ++pending.position_;
+        if (address >= numRoots) {
+            continue;
+        }
+        if (auto feature = tile_->at(address)) {
+            std::optional<uint32_t> featureGeomMask;
+            renderFeature(feature, featureGeomMask);
+        }
+        // At least one feature is rendered per slice, so every call makes progress.
+        if (deadline && std::chrono::steady_clock::now() >= *deadline) {
+            break;
+        }
+    }
+    if (pending.position_ < pending.end_) {
+        return true;
+    }
+    pendingRun_.reset();
+    return false;
+}
+
+void FeatureLayerVisualizationBase::runJointly(std::vector<FeatureLayerVisualizationBase*> const& visualizations)
+{
+    // Only full-tile passes over the same tile and address range can share a traversal.
+    std::vector<FeatureLayerVisualizationBase*> joint;
+    for (auto* visualization : visualizations) {
+        auto const& first = joint.empty() ? *visualization : *joint.front();
+        if (!visualization->tile_
+            || visualization->pendingRun_
+            || visualization->hasFeatureSubset()
+            || visualization->tile_ != first.tile_
+            || visualization->featureAddressRangeBegin_ != first.featureAddressRangeBegin_
+            || visualization->featureAddressRangeEnd_ != first.featureAddressRangeEnd_) {
+            visualization->run();
+            continue;
+        }
+        joint.push_back(visualization);
+    }
+    if (joint.empty()) {
         return;
     }
 
+    for (auto* visualization : joint) {
+        visualization->beginRun();
+    }
+    auto const& tile = joint.front()->tile_;
+    auto const& traversal = *joint.front()->pendingRun_;
+    for (auto address = traversal.position_; address < traversal.end_; ++address) {
+        auto feature = tile->at(static_cast<uint32_t>(address));
+        if (!feature) {
+            continue;
+        }
+        std::optional<uint32_t> featureGeomMask;
+        for (auto* visualization : joint) {
+            visualization->renderFeature(feature, featureGeomMask);
+        }
+    }
+    for (auto* visualization : joint) {
+        visualization->pendingRun_.reset();
+    }
+}
+
+void FeatureLayerVisualizationBase::cancel()
+{
+    pendingRun_.reset();
     relationStyleStates_.clear();
     externalRelationReferences_ = JsValue::List();
     externalRelationVisualizations_.clear();
+    for (auto& [ruleIndex, mergedRule] : mergedPointsPerRuleIndex_) {
+        mergedRule = MergedPointRule{};
+    }
+    featureOffsetSlotsByRuleIndex_.clear();
+    featuresAdded_ = false;
+}
 
-    auto processFeature = [this](mapget::model_ptr<mapget::Feature>& feature)
-    {
-        if (fidelity_ == FeatureStyleRule::LowFidelity
-            && maxLowFiLod_ >= 0
-            && !bypassLowFiMaxLodFilter()) {
-            if (static_cast<int>(feature->lod()) > maxLowFiLod_) {
-                return;
-            }
-        }
-        onFeatureForRendering(static_cast<mapget::Feature const&>(*feature));
-        auto const& constFeature = static_cast<mapget::Feature const&>(*feature);
-        std::optional<simfil::model_ptr<simfil::OverlayNode>> evaluationContext;
-        auto ensureEvaluationContext = [this, &constFeature, &evaluationContext]()
-            -> simfil::model_ptr<simfil::OverlayNode>&
-        {
-            if (!evaluationContext.has_value()) {
-                evaluationContext =
-                    simfil::model_ptr<simfil::OverlayNode>::make(simfil::Value::field(constFeature));
-                addOptionsToSimfilContext(*evaluationContext);
-            }
-            return *evaluationContext;
-        };
-        auto boundEvalFun = BoundEvalFun{
-            simfil::model_ptr<simfil::OverlayNode>::make(simfil::Value::null()),
-            {},
-            [this](auto const& property, auto const& expression, auto const& message, auto ruleIndex)
-            {
-                recordRuntimeStyleIssue(property, expression, message, ruleIndex);
-            }
-        };
-        boundEvalFun.eval_ = [this, &ensureEvaluationContext, &boundEvalFun](auto&& str)
+void FeatureLayerVisualizationBase::resetForNextTile()
+{
+    cancel();
+    mergedPointsPerRuleIndex_.clear();
+    runtimeStyleIssues_.clear();
+    tile_.reset();
+    allTiles_.clear();
+    featureIdIndex_.clear();
+    featureIdIndexForms_.clear();
+    numFeatureIdIndexedTiles_ = 0;
+    numFeatureIdLookupFallbacks_ = 0;
+}
+
+void FeatureLayerVisualizationBase::setFeatureMergeService(NativeJsValue const& rawFeatureMergeService)
+{
+    featureMergeService_ = JsValue(rawFeatureMergeService);
+}
+
+void FeatureLayerVisualizationBase::beginRun()
+{
+    relationStyleStates_.clear();
+    externalRelationReferences_ = JsValue::List();
+    externalRelationVisualizations_.clear();
+    prefetchMergedPointCounts();
+
+    // The bound evaluation function and its placeholder context are shared by all
+    // features; only the lazily created feature context is rebound per feature.
+    pendingRun_ = std::make_unique<PendingRun>(
+        simfil::model_ptr<simfil::OverlayNode>::make(simfil::Value::null()));
+    auto& pending = *pendingRun_;
+    pending.boundEvalFun_.reportIssue_ =
+        [this](auto const& property, auto const& expression, auto const& message, auto ruleIndex)
         {
-            if (auto constantValue = evaluateConstantExpression(str, false, false)) {
-                return std::move(*constantValue);
-            }
-            auto& context = ensureEvaluationContext();
-            boundEvalFun.context_ = context;
-            return evaluateExpression(str, *context, false, false);
+            recordRuntimeStyleIssue(property, expression, message, ruleIndex);
         };
-
-        auto const& candidateRuleIndices =
-            style_.candidateRuleIndices(highlightMode_, fidelity_, constFeature.typeId());
-        uint32_t featureGeomMask = 0;
-        bool needsFeatureGeomMask = false;
-        for (auto ruleIndex : candidateRuleIndices) {
-            if (style_.rules()[ruleIndex].aspect() == FeatureStyleRule::Feature) {
-                needsFeatureGeomMask = true;
-                break;
-            }
-        }
-        if (needsFeatureGeomMask) {
-            if (auto geom = feature->geomOrNull()) {
-                geom->forEachGeometry([&featureGeomMask](auto&& geomEntry) {
-                    featureGeomMask |= geomTypeBit(geomEntry->geomType());
-                    return true;
-                });
-            }
+    pending.boundEvalFun_.eval_ = [this, &pending](auto&& str)
+    {
+        if (auto constantValue = evaluateConstantExpression(str, false, false)) {
+            return std::move(*constantValue);
         }
-        for (auto ruleIndex : candidateRuleIndices) {
-            auto const& rule = style_.rules()[ruleIndex];
-            if (rule.aspect() == FeatureStyleRule::Feature) {
-                if ((featureGeomMask & rule.geometryTypesMask()) == 0) {
-                    continue;
-                }
-            }
-            auto mapLayerStyleRuleId = makeMapLayerStyleRuleId(rule.index());
-            if (auto* matchingSubRule = rule.match(*feature, boundEvalFun)) {
-                if (matchingSubRule->pointMergeGridCellSize()) {
-                    boundEvalFun.context_ = ensureEvaluationContext();
-                }
-                addFeature(feature, boundEvalFun, *matchingSubRule, mapLayerStyleRuleId);
-                featuresAdded_ = true;
-            }
+        if (!pending.evaluationContext_.has_value()) {
+            pending.evaluationContext_ = makeEvaluationContext(simfil::Value::field(*pending.currentFeature_));
         }
+        auto& context = *pending.evaluationContext_;
+        pending.boundEvalFun_.context_ = context;
+        return evaluateExpression(str, *context, false, false);
     };
 
-    if (featureIdBaseSubset_.empty()) {
-        for (auto&& feature : *tile_) {
-            processFeature(feature);
-        }
+    if (hasFeatureSubset()) {
+        forEachFeatureInSubset([&pending](auto& feature) {
+            pending.featureAddresses_.push_back(static_cast<uint32_t>(feature->addr().index()));
+        });
+        pending.end_ = pending.featureAddresses_.size();
         return;
     }
+    // Full passes walk the address range directly instead of materializing it.
+    auto const numRoots = static_cast<uint32_t>(tile_->numRoots());
+    pending.position_ = std::min(featureAddressRangeBegin_, numRoots);
+    pending.end_ = std::min(featureAddressRangeEnd_, numRoots);
+}
 
-    for (auto const& featureId : featureIdBaseSubset_) {
-        if (auto feature = tile_->find(featureId)) {
-            processFeature(feature);
+void FeatureLayerVisualizationBase::renderFeature(
+    mapget::model_ptr<mapget::Feature>& feature,
+    std::optional<uint32_t>& featureGeomMask)
+{
+    if (fidelity_ == FeatureStyleRule::LowFidelity
+        && maxLowFiLod_ >= 0
+        && !bypassLowFiMaxLodFilter()) {
+        if (static_cast<int>(feature->lod()) > maxLowFiLod_) {
+            return;
+        }
+    }
+    onFeatureForRendering(static_cast<mapget::Feature const&>(*feature));
+    auto const& constFeature = static_cast<mapget::Feature const&>(*feature);
+    auto& pending = *pendingRun_;
+    auto& boundEvalFun = pending.boundEvalFun_;
+    pending.currentFeature_ = &constFeature;
+    pending.evaluationContext_.reset();
+    boundEvalFun.context_ = pending.placeholderContext_;
+
+    auto const featureTypeId = constFeature.typeId();
+    auto const& candidateRuleIndices =
+        style_.candidateRuleIndices(highlightMode_, fidelity_, featureTypeId);
+    auto const& typeMatches = style_.ruleTypeMatches(featureTypeId);
+    bool needsFeatureGeomMask = false;
+    for (auto ruleIndex : candidateRuleIndices) {
+        if (style_.rules()[ruleIndex].aspect() == FeatureStyleRule::Feature) {
+            needsFeatureGeomMask = true;
+            break;
+        }
+    }
+    if (needsFeatureGeomMask && !featureGeomMask) {
+        featureGeomMask = 0;
+        if (auto geom = feature->geomOrNull()) {
+            geom->forEachGeometry([&featureGeomMask](auto&& geomEntry) {
+                *featureGeomMask |= geomTypeBit(geomEntry->geomType());
+                return true;
+            });
+        }
+    }
+    for (auto ruleIndex : candidateRuleIndices) {
+        auto const& rule = style_.rules()[ruleIndex];
+        if (rule.aspect() == FeatureStyleRule::Feature) {
+            if ((*featureGeomMask & rule.geometryTypesMask()) == 0) {
+                continue;
+            }
+        }
+        auto const isRelationRule = rule.aspect() == FeatureStyleRule::Relation;
+        if ((sequentialRules_ == SequentialRules::Skip && isRelationRule) ||
+            (sequentialRules_ == SequentialRules::Only && !isRelationRule && !rule.mergesPoints())) {
+            continue;
+        }
+        if (auto* matchingSubRule = rule.match(*feature, boundEvalFun, typeMatches.forRule(ruleIndex))) {
+            // A sequential pass only adds the merged points of a merging rule; the shards
+            // already rendered its other geometry.
+            auto const onlyMergedPoints = sequentialRules_ == SequentialRules::Only && !isRelationRule;
+            if (onlyMergedPoints && !matchingSubRule->pointMergeGridCellSize()) {
+                continue;
+            }
+            if (matchingSubRule->pointMergeGridCellSize()) {
+                if (!pending.evaluationContext_.has_value()) {
+                    pending.evaluationContext_ = makeEvaluationContext(simfil::Value::field(constFeature));
+                }
+                boundEvalFun.context_ = *pending.evaluationContext_;
+            }
+            skipUnmergedGeometry_ = onlyMergedPoints;
+            addFeature(feature, boundEvalFun, *matchingSubRule);
+            skipUnmergedGeometry_ = false;
+            featuresAdded_ = true;
         }
     }
 }
@@ -996,8 +1352,7 @@ void FeatureLayerVisualizationBase::run()
 void FeatureLayerVisualizationBase::addFeature(
     model_ptr<Feature>& feature,
     BoundEvalFun& evalFun,
-    FeatureStyleRule const& rule,
-    std::string const& mapLayerStyleRuleId)
+    FeatureStyleRule const& rule)
 {
     std::optional<std::string> featureId;
     auto resolveFeatureId = [&]() -> std::string const& {
@@ -1006,7 +1361,11 @@ void FeatureLayerVisualizationBase::addFeature(
         }
         return *featureId;
     };
-    if (!featureIdBaseSubset_.empty() && !featureIdBaseSubset_.contains(resolveFeatureId())) {
+    auto const featureAddress = static_cast<uint32_t>(feature->addr().index());
+    // Address subsets are already applied by run(), which only visits subset roots.
+    if (featureAddressSubset_.empty()
+        && !featureIdBaseSubset_.empty()
+        && !featureIdBaseSubset_.contains(resolveFeatureId())) {
         return;
     }
 
@@ -1015,24 +1374,28 @@ void FeatureLayerVisualizationBase::addFeature(
         // Attribute/relation/validity hover ids should not also trigger the
         // whole-feature hover highlight. Only emit feature highlights when the
         // bare feature id itself is part of the highlighted subset.
-        if (highlightMode_ == FeatureStyleRule::HoverHighlight
-            && !featureIdSubset_.empty()
-            && !featureIdSubset_.contains(resolveFeatureId())) {
-            break;
+        if (highlightMode_ == FeatureStyleRule::HoverHighlight) {
+            if (!featureAddressSubset_.empty()) {
+                if (!wholeFeatureAddressSubset_.contains(featureAddress)) {
+                    break;
+                }
+            }
+            else if (!featureIdSubset_.empty() && !featureIdSubset_.contains(resolveFeatureId())) {
+                break;
+            }
         }
         if (auto geomCollection = feature->geomOrNull()) {
             auto const currentOffsetSlot = featureOffsetSlotsByRuleIndex_[rule.index()];
             auto const effectiveOffset = effectiveOffsetForSlot(rule, currentOffsetSlot);
             bool emittedFeatureGeometry = false;
             auto addFeatureGeometry =
-                [this, featureAddress = static_cast<uint32_t>(feature->addr().index()),
-                 &rule, &mapLayerStyleRuleId, &evalFun, &effectiveOffset, &emittedFeatureGeometry](auto&& geom)
+                [this, featureAddress,
+                 &rule, &evalFun, &effectiveOffset, &emittedFeatureGeometry](auto&& geom)
                 {
                     emittedFeatureGeometry = addGeometry(
                         geom,
                         featureAddress,
                         rule,
-                        mapLayerStyleRuleId,
                         evalFun,
                         effectiveOffset) || emittedFeatureGeometry;
                     return true;
@@ -1050,7 +1413,7 @@ void FeatureLayerVisualizationBase::addFeature(
         break;
     }
     case FeatureStyleRule::Relation: {
-        onRelationStyle(feature, evalFun, rule, mapLayerStyleRuleId);
+        onRelationStyle(feature, evalFun, rule, mapLayerStyleRuleId(rule.index()));
         break;
     }
     case FeatureStyleRule::Attribute: {
@@ -1060,11 +1423,14 @@ void FeatureLayerVisualizationBase::addFeature(
         }
 
         auto const hoverAttributeSubsetActive =
-            !featureIdBaseSubset_.empty() &&
+            hasFeatureSubset() &&
             highlightMode_ == FeatureStyleRule::HoverHighlight;
-        std::string featureIdForAttributes;
+        HoveredAttributeSubset const* hoveredAttributes = nullptr;
         if (hoverAttributeSubsetActive) {
-            featureIdForAttributes = resolveFeatureId();
+            hoveredAttributes = hoveredAttributeSubset(featureAddress, resolveFeatureId);
+            if (!hoveredAttributes) {
+                break;
+            }
         }
 
         uint32_t offsetSlot = 0;
@@ -1077,19 +1443,14 @@ void FeatureLayerVisualizationBase::addFeature(
             layer->forEachAttribute([&, this](auto&& attr){
                 auto const attributeIndex = static_cast<uint32_t>(attr->addr().index());
                 std::unordered_set<uint32_t> const* hoveredValidityIndices = nullptr;
-                if (hoverAttributeSubsetActive) {
-                    auto const hoveredAttributeSubset =
-                        hoveredAttributeSubsetsByFeatureId_.find(featureIdForAttributes);
-                    if (hoveredAttributeSubset == hoveredAttributeSubsetsByFeatureId_.end()) {
-                        return true;
-                    }
+                if (hoveredAttributes) {
                     auto const fullAttributeHovered =
-                        hoveredAttributeSubset->second.hoveredAttributeIndices_.contains(attributeIndex);
+                        hoveredAttributes->hoveredAttributeIndices_.contains(attributeIndex);
                     auto const hoveredValiditySet =
-                        hoveredAttributeSubset->second.hoveredValidityIndicesByAttribute_.find(attributeIndex);
+                        hoveredAttributes->hoveredValidityIndicesByAttribute_.find(attributeIndex);
                     if (!fullAttributeHovered) {
                         if (hoveredValiditySet ==
-                            hoveredAttributeSubset->second.hoveredValidityIndicesByAttribute_.end()) {
+                            hoveredAttributes->hoveredValidityIndicesByAttribute_.end()) {
                             return true;
                         }
                         hoveredValidityIndices = &hoveredValiditySet->second;
@@ -1099,9 +1460,8 @@ void FeatureLayerVisualizationBase::addFeature(
                     feature,
                     layerName,
                     attr,
-                    static_cast<uint32_t>(feature->addr().index()),
+                    featureAddress,
                     rule,
-                    mapLayerStyleRuleId,
                     offsetSlot,
                     hoveredValidityIndices);
                 return true;
@@ -1117,7 +1477,6 @@ bool FeatureLayerVisualizationBase::addGeometry(
     model_ptr<Geometry> const& geom,
     uint32_t tileFeatureId,
     FeatureStyleRule const& rule,
-    std::string const& mapLayerStyleRuleId,
     BoundEvalFun& evalFun,
     glm::dvec3 const& offset)
 {
@@ -1150,7 +1509,6 @@ bool FeatureLayerVisualizationBase::addGeometry(
         geom->model().stage(),
         tileFeatureId,
         rule,
-        mapLayerStyleRuleId,
         evalFun,
         offset);
 }
@@ -1164,7 +1522,7 @@ bool FeatureLayerVisualizationBase::addAabbGeometry(
     BoundEvalFun& evalFun,
     glm::dvec3 const& offset)
 {
-    if (!geometryPassesRenderFilters(GeomType::AABB, geometryStage, rule)) {
+    if (skipUnmergedGeometry_ || !geometryPassesRenderFilters(GeomType::AABB, geometryStage, rule)) {
         return false;
     }
 
@@ -1185,6 +1543,9 @@ bool FeatureLayerVisualizationBase::addGltfNodeGeometry(
     BoundEvalFun& evalFun,
     glm::dvec3 const& offset)
 {
+    if (skipUnmergedGeometry_) {
+        return false;
+    }
     if (geometryPassesRenderFilters(GeomType::GltfNodeIndex, geometryStage, rule)) {
         auto const renderFeatureId = rule.selectable() ? tileFeatureId : kUnselectableFeatureId;
         emitGltfNode(nodeIndex, aabbOriginWgs, aabbSizeWgs, rule, renderFeatureId, evalFun);
@@ -1210,7 +1571,6 @@ bool FeatureLayerVisualizationBase::addGeometry(
     std::optional<uint32_t> geometryStage,
     uint32_t tileFeatureId,
     FeatureStyleRule const& rule,
-    std::string const& mapLayerStyleRuleId,
     BoundEvalFun& evalFun,
     glm::dvec3 const& offset)
 {
@@ -1223,33 +1583,35 @@ bool FeatureLayerVisualizationBase::addGeometry(
         hasLocalOffset(offset) ? offsetGeometryLocally(geom, offset) : geom;
 
     std::vector<mapget::Point> vertsProjected;
-    vertsProjected.reserve(geometryForRendering.points_.size());
-    for (auto const& vertCarto : geometryForRendering.points_) {
-        vertsProjected.emplace_back(projectWgsPoint(vertCarto));
-    }
+    projectWgsPoints(geometryForRendering.points_, vertsProjected);
 
+    // Shards leave merged points to the sequential pass, which only adds those.
+    auto const addsMergedPoints = sequentialRules_ != SequentialRules::Skip;
+    auto const emitsNonPoints = includesNonPointGeometry() && !skipUnmergedGeometry_;
     bool emittedAnyGeometry = false;
     switch (geometryForRendering.geomType_) {
     case GeomType::Polygon:
-        if (includesNonPointGeometry() && vertsProjected.size() >= 3) {
+        if (emitsNonPoints && vertsProjected.size() >= 3) {
+            simplifyForLowFidelity(vertsProjected, rule, true);
             emitPolygon(vertsProjected, rule, renderFeatureId, evalFun);
             emittedAnyGeometry = true;
         }
         break;
     case GeomType::Line:
-        if (includesNonPointGeometry()) {
+        if (emitsNonPoints) {
+            simplifyForLowFidelity(vertsProjected, rule, false);
             addPolyLine(vertsProjected, rule, renderFeatureId, evalFun);
             emittedAnyGeometry = true;
         }
         break;
     case GeomType::Mesh:
-        if (includesNonPointGeometry() && vertsProjected.size() >= 3) {
+        if (emitsNonPoints && vertsProjected.size() >= 3) {
             emitMesh(vertsProjected, rule, renderFeatureId, evalFun);
             emittedAnyGeometry = true;
         }
         break;
     case GeomType::AABB:
-        if (includesNonPointGeometry() && geometryForRendering.points_.size() >= 2) {
+        if (emitsNonPoints && geometryForRendering.points_.size() >= 2) {
             emitAabb(
                 geometryForRendering.points_[0],
                 geometryForRendering.points_[1],
@@ -1264,30 +1626,32 @@ bool FeatureLayerVisualizationBase::addGeometry(
             break;
         }
         for (size_t pointIndex = 0; pointIndex < vertsProjected.size(); ++pointIndex) {
-            auto const xyzPos = JsValue(vertsProjected[pointIndex]);
-            if (auto const& gridCellSize = rule.pointMergeGridCellSize()) {
-                addMergedPointGeometry(
-                    renderFeatureId,
-                    mapLayerStyleRuleId,
-                    gridCellSize,
-                    geom.points_[pointIndex],
-                    "pointParameters",
-                    evalFun,
-                    [&](auto& augmentedEvalFun)
-                    {
-                        if (rule.hasIconUrl()) {
-                            return makeMergedPointIconParams(
-                                xyzPos,
+            auto const& xyzPos = vertsProjected[pointIndex];
+            if (rule.pointMergeGridCellSize()) {
+                if (addsMergedPoints) {
+                    // Only the merge-service payload needs the position as a JS value.
+                    addMergedPointGeometry(
+                        renderFeatureId,
+                        rule,
+                        geom.points_[pointIndex],
+                        "pointParameters",
+                        evalFun,
+                        [&](auto& augmentedEvalFun)
+                        {
+                            if (rule.hasIconUrl()) {
+                                return makeMergedPointIconParams(
+                                    JsValue(xyzPos),
+                                    rule,
+                                    renderFeatureId,
+                                    augmentedEvalFun);
+                            }
+                            return makeMergedPointPointParams(
+                                JsValue(xyzPos),
                                 rule,
                                 renderFeatureId,
                                 augmentedEvalFun);
-                        }
-                        return makeMergedPointPointParams(
-                            xyzPos,
-                            rule,
-                            renderFeatureId,
-                            augmentedEvalFun);
-                    });
+                        });
+                }
             }
             else if (rule.hasIconUrl()) {
                 emitIcon(xyzPos, rule, renderFeatureId, evalFun);
@@ -1307,25 +1671,26 @@ bool FeatureLayerVisualizationBase::addGeometry(
         if (!text.empty()) {
             auto const labelWgsPos = geometryCenter(geometryForRendering);
             auto const hashWgsPos = geometryCenter(geom);
-            auto xyzPos = JsValue(projectWgsPoint(labelWgsPos));
-
-            if (auto const& gridCellSize = rule.pointMergeGridCellSize()) {
-                addMergedPointGeometry(
-                    renderFeatureId,
-                    mapLayerStyleRuleId,
-                    gridCellSize,
-                    hashWgsPos,
-                    "labelParameters",
-                    evalFun,
-                    [&](auto& augmentedEvalFun)
-                    {
-                        return makeMergedPointLabelParams(
-                            xyzPos,
-                            text,
-                            rule,
-                            renderFeatureId,
-                            augmentedEvalFun);
-                    });
+            auto const xyzPos = projectWgsPoint(labelWgsPos);
+
+            if (rule.pointMergeGridCellSize()) {
+                if (addsMergedPoints) {
+                    addMergedPointGeometry(
+                        renderFeatureId,
+                        rule,
+                        hashWgsPos,
+                        "labelParameters",
+                        evalFun,
+                        [&](auto& augmentedEvalFun)
+                        {
+                            return makeMergedPointLabelParams(
+                                JsValue(xyzPos),
+                                text,
+                                rule,
+                                renderFeatureId,
+                                augmentedEvalFun);
+                        });
+                }
             }
             else {
                 emitLabel(xyzPos, text, rule, renderFeatureId, evalFun);
@@ -1336,62 +1701,264 @@ bool FeatureLayerVisualizationBase::addGeometry(
     return emittedAnyGeometry;
 }
 
-void FeatureLayerVisualizationBase::addMergedPointGeometry(
-    uint32_t tileFeatureId,
-    const std::string& mapLayerStyleRuleId,
-    const std::optional<glm::dvec3>& gridCellSize,
-    mapget::Point const& pointCartographic,
-    const char* geomField,
-    BoundEvalFun& evalFun,
-    std::function<JsValue(BoundEvalFun&)> const& makeGeomParams)
+FeatureLayerVisualizationBase::MergedPointRule&
+FeatureLayerVisualizationBase::mergedPointRule(uint32_t ruleIndex)
 {
-    auto gridPosition = pointCartographic / *gridCellSize;
-    auto gridPositionHash = fmt::format(
-        "{}:{}:{}",
-        static_cast<int64_t>(glm::floor(gridPosition.x)),
-        static_cast<int64_t>(glm::floor(gridPosition.y)),
-        static_cast<int64_t>(glm::floor(gridPosition.z)));
+    return mergedPointsPerRuleIndex_[ruleIndex];
+}
+
+std::string FeatureLayerVisualizationBase::mergedPointCellHash(MergedPointCell const& cell)
+{
+    return fmt::format("{}:{}:{}", cell.cell_[0], cell.cell_[1], cell.cell_[2]);
+}
 
-    auto& [mergedPointFeatureSet, mergedPointVisu] =
-        mergedPointsPerStyleRuleId_[mapLayerStyleRuleId][gridPositionHash];
-    auto [_, featureIdIsNew] = mergedPointFeatureSet.emplace(tileFeatureId);
+void FeatureLayerVisualizationBase::prefetchMergedPointCounts()
+{
+    auto const serviceType = featureMergeService_.type();
+    if (serviceType == JsValue::Type::Undefined || serviceType == JsValue::Type::Null ||
+        !includesPointLikeGeometry() || sequentialRules_ == SequentialRules::Skip) {
+        return;
+    }
+
+    // Rules (or first-of sub-rules) which merge points, grouped by top-level rule index.
+    std::unordered_map<uint32_t, std::vector<FeatureStyleRule const*>> mergingRulesByIndex;
+    for (auto const& rule : style_.rules()) {
+        if (rule.aspect() != FeatureStyleRule::Feature) {
+            continue;
+        }
+        if (rule.pointMergeGridCellSize()) {
+            mergingRulesByIndex[rule.index()].push_back(&rule);
+        }
+        for (auto const& subRule : rule.firstOfRules()) {
+            if (subRule.pointMergeGridCellSize()) {
+                mergingRulesByIndex[rule.index()].push_back(&subRule);
+            }
+        }
+    }
+    if (mergingRulesByIndex.empty()) {
+        return;
+    }
+
+    struct PendingCell {
+        uint32_t ruleIndex_;
+        GridCellKey key_;
+        std::array<int64_t, 3> cell_;
+        mapget::Point position_;
+    };
+    std::vector<PendingCell> pendingCells;
+    std::unordered_map<uint32_t, std::unordered_set<GridCellKey>> seenKeysByRuleIndex;
+    auto collect = [&](uint32_t ruleIndex, FeatureStyleRule const& rule, mapget::Point const& pos)
+    {
+        auto const cell = mergeGridCell(pos, *rule.pointMergeGridCellSize());
+        auto const key = packMergeGridCell(cell);
+        if (seenKeysByRuleIndex[ruleIndex].insert(key).second) {
+            pendingCells.push_back({ruleIndex, key, cell, pos});
+        }
+    };
 
-    auto externalMergedPointCount = 0;
+    auto collectFeature = [&](mapget::model_ptr<mapget::Feature> const& feature)
+    {
+        auto geomCollection = feature->geomOrNull();
+        if (!geomCollection) {
+            return;
+        }
+        auto const& candidateRuleIndices =
+            style_.candidateRuleIndices(highlightMode_, fidelity_, feature->typeId());
+        for (auto ruleIndex : candidateRuleIndices) {
+            auto const mergingRules = mergingRulesByIndex.find(style_.rules()[ruleIndex].index());
+            if (mergingRules == mergingRulesByIndex.end()) {
+                continue;
+            }
+            geomCollection->forEachGeometry([&](auto&& geomEntry) {
+                auto const geomType = geomEntry->geomType();
+                if (geomType == GeomType::AABB || geomType == GeomType::GltfNodeIndex) {
+                    return true;
+                }
+                std::optional<SelfContainedGeometry> geom;
+                for (auto const* rule : mergingRules->second) {
+                    if (!geometryPassesRenderFilters(geomType, geomEntry->model().stage(), *rule)) {
+                        continue;
+                    }
+                    if (!geom) {
+                        geom = geomEntry->toSelfContained();
+                    }
+                    if (geomType == GeomType::Points) {
+                        for (auto const& point : geom->points_) {
+                            collect(mergingRules->first, *rule, point);
+                        }
+                    }
+                    if (rule->hasLabel()) {
+                        collect(mergingRules->first, *rule, geometryCenter(*geom));
+                    }
+                }
+                return true;
+            });
+        }
+    };
+
+    forEachFeatureInSubset(collectFeature);
+    if (pendingCells.empty()) {
+        return;
+    }
+
+    // Rule ids are sent once; each cell references its rule by slot.
+    std::unordered_map<uint32_t, uint32_t> ruleSlotByIndex;
+    auto ruleIds = JsValue::List();
+    std::vector<uint32_t> ruleSlots;
+    std::vector<double> positions;
+    std::vector<double> cells;
+    ruleSlots.reserve(pendingCells.size());
+    positions.reserve(pendingCells.size() * 3);
+    cells.reserve(pendingCells.size() * 3);
+    for (auto const& pending : pendingCells) {
+        auto [slot, isNewSlot] = ruleSlotByIndex.try_emplace(
+            pending.ruleIndex_, static_cast<uint32_t>(ruleSlotByIndex.size()));
+        if (isNewSlot) {
+            ruleIds.push(JsValue(std::string(mapLayerStyleRuleId(pending.ruleIndex_))));
+        }
+        ruleSlots.push_back(slot->second);
+        positions.insert(positions.end(), {pending.position_.x, pending.position_.y, pending.position_.z});
+        cells.insert(cells.end(), {
+            static_cast<double>(pending.cell_[0]),
+            static_cast<double>(pending.cell_[1]),
+            static_cast<double>(pending.cell_[2])});
+    }
+
+    JsValue counts;
+    try {
+        counts = JsValue(featureMergeService_.call<NativeJsValue>(
+            "countBatch",
+            tile_->tileId().z(),
+            ruleIds,
+            JsValue::Uint32Array(ruleSlots),
+            JsValue::Float64Array(positions),
+            JsValue::Float64Array(cells)));
+    } catch (...) {
+        // Merge services without countBatch fall back to per-cell count calls.
+        return;
+    }
+    if (counts.type() != JsValue::Type::ObjectOrList || counts.size() != pendingCells.size()) {
+        return;
+    }
+    for (uint32_t i = 0; i < pendingCells.size(); ++i) {
+        auto const& pending = pendingCells[i];
+        mergedPointRule(pending.ruleIndex_).prefetchedCounts_[pending.key_] = counts.at(i).as<int32_t>();
+    }
+}
+
+int32_t FeatureLayerVisualizationBase::externalMergedPointCount(
+    uint32_t ruleIndex,
+    MergedPointRule& mergedRule,
+    GridCellKey key,
+    MergedPointCell& cell)
+{
+    if (cell.externalCount_) {
+        return *cell.externalCount_;
+    }
+    if (auto prefetched = mergedRule.prefetchedCounts_.find(key); prefetched != mergedRule.prefetchedCounts_.end()) {
+        cell.externalCount_ = prefetched->second;
+        return prefetched->second;
+    }
+
+    cell.externalCount_ = 0;
     auto featureMergeServiceType = featureMergeService_.type();
     if (featureMergeServiceType != JsValue::Type::Undefined &&
         featureMergeServiceType != JsValue::Type::Null &&
         tile_) {
         try {
-            externalMergedPointCount = featureMergeService_.call<int32_t>(
+            cell.externalCount_ = featureMergeService_.call<int32_t>(
                 "count",
-                pointCartographic,
-                gridPositionHash,
+                cell.position_,
+                mergedPointCellHash(cell),
                 tile_->tileId().z(),
-                mapLayerStyleRuleId);
+                std::string(mapLayerStyleRuleId(ruleIndex)));
         } catch (...) {
-            externalMergedPointCount = 0;
+            cell.externalCount_ = 0;
         }
     }
+    return *cell.externalCount_;
+}
+
+void FeatureLayerVisualizationBase::addMergedPointGeometry(
+    uint32_t tileFeatureId,
+    FeatureStyleRule const& rule,
+    mapget::Point const& pointCartographic,
+    const char* geomField,
+    BoundEvalFun& evalFun,
+    std::function<JsValue(BoundEvalFun&)> const& makeGeomParams)
+{
+    auto const gridCell = mergeGridCell(pointCartographic, *rule.pointMergeGridCellSize());
+    auto const key = packMergeGridCell(gridCell);
+
+    auto& mergedRule = mergedPointRule(rule.index());
+    auto [cellIndex, isNewCell] = mergedRule.cellIndexByKey_.try_emplace(
+        key, static_cast<uint32_t>(mergedRule.cells_.size()));
+    if (isNewCell) {
+        auto& newCell = mergedRule.cells_.emplace_back();
+        newCell.cell_ = gridCell;
+        newCell.position_ = pointCartographic;
+        newCell.parameters_ = JsValue::Dict();
+    }
+    auto& cell = mergedRule.cells_[cellIndex->second];
+
+    // Features are traversed one after another, so a repeated address can only be the last one.
+    if (cell.featureAddresses_.empty() || cell.featureAddresses_.back() != tileFeatureId) {
+        cell.featureAddresses_.push_back(tileFeatureId);
+    }
+
     auto mergedPointCount =
-        externalMergedPointCount + static_cast<int32_t>(mergedPointFeatureSet.size());
+        externalMergedPointCount(rule.index(), mergedRule, key, cell) +
+        static_cast<int32_t>(cell.featureAddresses_.size());
 
-    auto mergeCountId = internalStringPoolCopy_->emplace("$mergeCount");
-    evalFun.context_->set(mergeCountId.value(), simfil::Value(mergedPointCount));
+    evalFun.context_->set(contextFieldIds_.mergeCount_, simfil::Value(mergedPointCount));
 
-    if (!mergedPointVisu) {
-        mergedPointVisu = JsValue::Dict({
-            {"position", JsValue(pointCartographic)},
-            {"positionHash", JsValue(gridPositionHash)},
-            {geomField, JsValue(makeGeomParams(evalFun))},
-            {"featureAddresses", JsValue::List({JsValue(tileFeatureId)})},
-        });
+    cell.parameters_.set(geomField, JsValue(makeGeomParams(evalFun)));
+}
+
+model_ptr<Feature> FeatureLayerVisualizationBase::findFeatureInAddedTiles(
+    std::string_view typeId,
+    KeyValueViewPairs const& featureId)
+{
+    for (; numFeatureIdIndexedTiles_ < allTiles_.size(); ++numFeatureIdIndexedTiles_) {
+        auto const& tile = allTiles_[numFeatureIdIndexedTiles_];
+        if (!tile) {
+            continue;
+        }
+        for (uint32_t address = 0; address < tile->numRoots(); ++address) {
+            auto feature = tile->at(address);
+            if (!feature) {
+                continue;
+            }
+            auto const id = feature->id();
+            auto const idParts = id->keyValuePairs();
+            // Keep the first hit, matching the tile order of the per-tile lookup.
+            featureIdIndex_.try_emplace(
+                featureIdIndexKey(id->typeId(), idParts),
+                static_cast<uint32_t>(numFeatureIdIndexedTiles_),
+                address);
+            featureIdIndexForms_.emplace(featureIdIndexKey(id->typeId(), idParts, false));
+        }
     }
-    else {
-        mergedPointVisu->set(geomField, JsValue(makeGeomParams(evalFun)));
-        if (featureIdIsNew) {
-            (*mergedPointVisu)["featureAddresses"].push(JsValue(tileFeatureId));
+
+    auto const indexed = featureIdIndex_.find(featureIdIndexKey(typeId, featureId));
+    if (indexed != featureIdIndex_.end()) {
+        auto const [tileIndex, address] = indexed->second;
+        if (auto feature = allTiles_[tileIndex]->at(address)) {
+            return feature;
         }
     }
+    // A miss is final if an indexed feature has the same id form, since only the values
+    // differ. Other forms, e.g. another id composition of the type, go through mapget.
+    if (featureIdIndexForms_.contains(featureIdIndexKey(typeId, featureId, false))) {
+        return {};
+    }
+    ++numFeatureIdLookupFallbacks_;
+    return findFeatureAcrossTiles(allTiles_, typeId, featureId);
+}
+
+size_t FeatureLayerVisualizationBase::numFeatureIdLookupFallbacks() const
+{
+    return numFeatureIdLookupFallbacks_;
 }
 
 void FeatureLayerVisualizationBase::rememberExternalRelationReference(
@@ -1449,7 +2016,7 @@ void FeatureLayerVisualizationBase::addLine(
     }
 
     emitLabel(
-        JsValue(mapget::Point(pointA + (pointB - pointA) * labelPositionHint)),
+        mapget::Point(pointA + (pointB - pointA) * labelPositionHint),
         text,
         rule,
         tileFeatureId,
@@ -1490,52 +2057,40 @@ void FeatureLayerVisualizationBase::addPolyLine(
     }
 }
 
-void FeatureLayerVisualizationBase::ensureEvaluationEnvironment()
-{
-    if (evalEnvironment_) {
-        return;
-    }
-    if (!internalStringPoolCopy_) {
-        return;
-    }
-
-    evalEnvironment_ = mapget::makeEnvironment(internalStringPoolCopy_);
-    for (auto const& [key, value] : optionValues_) {
-        evalEnvironment_->constants.insert_or_assign(key, value);
-    }
-}
-
 FeatureLayerVisualizationBase::CachedExpression*
 FeatureLayerVisualizationBase::getOrCompileExpression(
     std::string const& expression,
     bool anyMode,
     bool autoWildcard)
 {
-    ensureEvaluationEnvironment();
-    if (!evalEnvironment_) {
+    if (!expressionScope_ || !expressionScope_->environment_) {
         return nullptr;
     }
 
     auto cacheKey = makeExpressionCacheKey(expression, anyMode, autoWildcard);
-    auto [iter, inserted] = expressionCache_.try_emplace(std::move(cacheKey));
-    if (!inserted) {
-        return &iter->second;
+    auto [iter, inserted] = expressionScope_->expressions_.try_emplace(std::move(cacheKey));
+    if (inserted) {
+        auto ast = simfil::compile(*expressionScope_->environment_, expression, anyMode, autoWildcard);
+        if (ast) {
+            iter->second.ast_ = std::move(*ast);
+        }
+        else {
+            std::cout << "Error compiling " << expression << ": " << ast.error().message
+                      << std::endl;
+            iter->second.compileError_ = ast.error().message;
+        }
     }
 
-    auto ast = simfil::compile(*evalEnvironment_, expression, anyMode, autoWildcard);
-    if (!ast) {
-        std::cout << "Error compiling " << expression << ": " << ast.error().message
-                  << std::endl;
+    // Failed compilations stay cached, but each visualization still reports them.
+    if (!iter->second.ast_) {
         recordRuntimeStyleIssue(
             "expression",
             expression,
-            "Could not compile expression: " + ast.error().message,
+            "Could not compile expression: " + iter->second.compileError_,
             std::nullopt,
             "runtime-sample-skipped");
-        expressionCache_.erase(iter);
         return nullptr;
     }
-    iter->second.ast_ = std::move(*ast);
     return &iter->second;
 }
 
@@ -1546,7 +2101,7 @@ void FeatureLayerVisualizationBase::resolveCachedConstant(CachedExpression& cach
     }
     cached.constantResolved_ = true;
 
-    if (!cached.ast_ || !cached.ast_->expr().constant() || !tile_ || !evalEnvironment_) {
+    if (!cached.ast_ || !cached.ast_->expr().constant() || !tile_ || !expressionScope_) {
         return;
     }
 
@@ -1555,7 +2110,7 @@ void FeatureLayerVisualizationBase::resolveCachedConstant(CachedExpression& cach
         return;
     }
 
-    auto results = simfil::eval(*evalEnvironment_, *cached.ast_, **rootResult, nullptr);
+    auto results = simfil::eval(*expressionScope_->environment_, *cached.ast_, **rootResult, nullptr);
     if (!results) {
         std::cout << "Error evaluating constant expression " << cached.ast_->query()
                   << ": " << results.error().message << std::endl;
@@ -1572,6 +2127,14 @@ void FeatureLayerVisualizationBase::resolveCachedConstant(CachedExpression& cach
     }
 }
 
+void FeatureLayerVisualizationBase::mergeShardState(FeatureLayerVisualizationBase const& shard)
+{
+    featuresAdded_ = featuresAdded_ || shard.featuresAdded_;
+    for (auto const& issue : shard.runtimeStyleIssues_) {
+        recordRuntimeStyleIssue(issue.property, issue.expression, issue.message, issue.ruleIndex, issue.impact);
+    }
+}
+
 void FeatureLayerVisualizationBase::recordRuntimeStyleIssue(
     std::string property,
     std::string expression,
@@ -1631,7 +2194,7 @@ simfil::Value FeatureLayerVisualizationBase::evaluateExpression(
     bool autoWildcard)
 {
     auto* cached = getOrCompileExpression(expression, anyMode, autoWildcard);
-    if (!cached || !cached->ast_ || !evalEnvironment_) {
+    if (!cached || !cached->ast_) {
         return simfil::Value::null();
     }
     resolveCachedConstant(*cached);
@@ -1641,7 +2204,7 @@ simfil::Value FeatureLayerVisualizationBase::evaluateExpression(
 
     try
     {
-        auto results = simfil::eval(*evalEnvironment_, *cached->ast_, ctx, nullptr);
+        auto results = simfil::eval(*expressionScope_->environment_, *cached->ast_, ctx, nullptr);
         if (!results) {
             std::cout << "Error evaluating " << expression << ": " << results.error().message
                       << std::endl;
@@ -1685,7 +2248,6 @@ void FeatureLayerVisualizationBase::addAttribute(
     model_ptr<Attribute> const& attr,
     uint32_t tileFeatureId,
     FeatureStyleRule const& rule,
-    std::string const& mapLayerStyleRuleId,
     uint32_t& offsetSlot,
     std::unordered_set<uint32_t> const* hoveredValidityIndices)
 {
@@ -1708,16 +2270,11 @@ void FeatureLayerVisualizationBase::addAttribute(
     auto const& constAttr = static_cast<mapget::Attribute const&>(*attr);
     auto const& constFeature = static_cast<mapget::Feature const&>(*feature);
 
-    auto nameId = internalStringPoolCopy_->emplace("$name");
-    auto featureId = internalStringPoolCopy_->emplace("$feature");
-    auto layerId = internalStringPoolCopy_->emplace("$layer");
     auto makeAttrEvaluationContext = [&]() {
-        auto context =
-            simfil::model_ptr<simfil::OverlayNode>::make(simfil::Value::field(constAttr));
-        addOptionsToSimfilContext(context);
-        context->set(nameId.value(), simfil::Value(attr->name()));
-        context->set(featureId.value(), simfil::Value::field(constFeature));
-        context->set(layerId.value(), simfil::Value(layer));
+        auto context = makeEvaluationContext(simfil::Value::field(constAttr));
+        context->set(contextFieldIds_.name_, simfil::Value(attr->name()));
+        context->set(contextFieldIds_.feature_, simfil::Value::field(constFeature));
+        context->set(contextFieldIds_.layer_, simfil::Value(layer));
         return context;
     };
 
@@ -1748,8 +2305,8 @@ void FeatureLayerVisualizationBase::addAttribute(
         }
     }
 
-    auto validityIndexId = internalStringPoolCopy_->emplace("$validityIndex");
-    auto validityCountId = internalStringPoolCopy_->emplace("$validityCount");
+    auto const validityIndexId = contextFieldIds_.validityIndex_;
+    auto const validityCountId = contextFieldIds_.validityCount_;
 
     // Draw validity geometry.
     auto const preferredGeometryStage =
@@ -1784,10 +2341,10 @@ void FeatureLayerVisualizationBase::addAttribute(
             attrEvaluationContext = makeAttrEvaluationContext();
             boundEvalFun.context_ = attrEvaluationContext;
             attrEvaluationContext->set(
-                validityIndexId.value(),
+                validityIndexId,
                 simfil::Value(static_cast<int64_t>(validityIndex)));
             attrEvaluationContext->set(
-                validityCountId.value(),
+                validityCountId,
                 simfil::Value(static_cast<int64_t>(totalValidityCount)));
 
             auto validityGeometry =
@@ -1802,7 +2359,6 @@ void FeatureLayerVisualizationBase::addAttribute(
                 validityGeometryStage,
                 tileFeatureId,
                 rule,
-                mapLayerStyleRuleId,
                 boundEvalFun,
                 effectiveOffset);
             if (validity.geometryDescriptionType() == mapget::Validity::FeatureTransition) {
@@ -1819,8 +2375,8 @@ void FeatureLayerVisualizationBase::addAttribute(
         }
         attrEvaluationContext = makeAttrEvaluationContext();
         boundEvalFun.context_ = attrEvaluationContext;
-        attrEvaluationContext->set(validityIndexId.value(), simfil::Value(static_cast<int64_t>(0)));
-        attrEvaluationContext->set(validityCountId.value(), simfil::Value(static_cast<int64_t>(1)));
+        attrEvaluationContext->set(validityIndexId, simfil::Value(static_cast<int64_t>(0)));
+        attrEvaluationContext->set(validityCountId, simfil::Value(static_cast<int64_t>(1)));
         if (auto geomCollection = feature->geomOrNull()) {
             auto const effectiveOffset = effectiveOffsetForSlot(rule, offsetSlot);
             auto addAttributeGeometry =
@@ -1829,7 +2385,6 @@ void FeatureLayerVisualizationBase::addAttribute(
                         geom,
                         tileFeatureId,
                         rule,
-                        mapLayerStyleRuleId,
                         boundEvalFun,
                         effectiveOffset);
                     return true;
@@ -1846,13 +2401,40 @@ void FeatureLayerVisualizationBase::addAttribute(
     }
 }
 
-void FeatureLayerVisualizationBase::addOptionsToSimfilContext(
-    simfil::model_ptr<simfil::OverlayNode>& context)
+void FeatureLayerVisualizationBase::resolveContextFieldIds()
+{
+    auto intern = [this](std::string_view name) {
+        return internalStringPoolCopy_->emplace(name).value();
+    };
+    contextFieldIds_ = ContextFieldIds{
+        .mergeCount_ = intern("$mergeCount"),
+        .name_ = intern("$name"),
+        .feature_ = intern("$feature"),
+        .layer_ = intern("$layer"),
+        .validityIndex_ = intern("$validityIndex"),
+        .validityCount_ = intern("$validityCount"),
+        .source_ = intern("$source"),
+        .target_ = intern("$target"),
+        .twoway_ = intern("$twoway"),
+    };
+    optionFields_.clear();
+    for (auto const& optionId : style_.contextOptionIds()) {
+        if (auto value = optionValues_.find(optionId); value != optionValues_.end()) {
+            optionFields_.emplace_back(intern(optionId), value->second);
+        }
+    }
+}
+
+simfil::model_ptr<simfil::OverlayNode> FeatureLayerVisualizationBase::makeEvaluationContext(
+    simfil::Value const& value) const
 {
-    for (auto const& [key, value] : optionValues_) {
-        auto keyId = internalStringPoolCopy_->emplace(key);
-        context->set(keyId.value(), value);
+    // Options are constants of the expression scope's environment, which the compiler
+    // substitutes once per scope. Only options looked up by name need the overlay.
+    auto context = simfil::model_ptr<simfil::OverlayNode>::make(value);
+    for (auto const& [keyId, optionValue] : optionFields_) {
+        context->set(keyId, optionValue);
     }
+    return context;
 }
 
 JsValue
@@ -1,10 +1,20 @@
 #include "visualization-deck.h"
+#include "geometry.h"
 
 #include <algorithm>
 #include <array>
+#include <cassert>
 #include <cmath>
 #include <cstdint>
+#include <cstring>
 #include <limits>
+#include <optional>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#ifndef EMSCRIPTEN
+#include <thread>
+#endif
 #include <glm/trigonometric.hpp>
 #include <glm/exponential.hpp>
 #include <glm/common.hpp>
@@ -29,16 +39,6 @@ constexpr double kArrowHeadLengthFraction = 0.35;
 constexpr double kArrowHeadWidthFraction = 0.55;
 constexpr double kArrowSegmentEpsilonMeters = 1e-6;
 
-/** Convert the JS `{x,y,z}` point payload emitted by the base class back into `mapget::Point`. */
-mapget::Point pointFromJsValue(JsValue const& xyzPos)
-{
-    return {
-        xyzPos["x"].as<double>(),
-        xyzPos["y"].as<double>(),
-        xyzPos["z"].as<double>(),
-    };
-}
-
 /** Convert normalized float RGBA colors into the byte array shape used by deck labels/icons. */
 JsValue rgbaBytesFromColor(glm::fvec4 const& color)
 {
@@ -69,12 +69,6 @@ glm::fvec4 resolvedGltfTintColor(
     return {1.0f, 1.0f, 1.0f, 1.0f};
 }
 
-/** Convert longitude to deck/math.gl world X units at the canonical 512-tile scale. */
-double mercatorWorldX(double longitudeDeg)
-{
-    return (kMercatorTileSize * ((longitudeDeg * kDegToRad) + kPi)) / (2.0 * kPi);
-}
-
 /** Convert latitude to deck/math.gl world Y units at the canonical 512-tile scale. */
 double mercatorWorldY(double latitudeDeg)
 {
@@ -112,6 +106,192 @@ bool distanceScalesAt(
     unitsPerMeter2 = (unitsPerDegree2 / unitsPerDegreeY) * unitsPerMeter;
     return std::isfinite(unitsPerMeter) && std::isfinite(unitsPerMeter2);
 }
+
+/**
+ * Project a WGS84 point to meters around an origin, given the origin's mercator world Y and
+ * math.gl distance scales. Inverts math.gl addMetersToLngLat:
+ *   worldDeltaY = yMeters * unitsPerMeter
+ *   worldDeltaX = xMeters * (unitsPerMeter + unitsPerMeter2 * yMeters)
+ */
+mapget::Point metersFromOrigin(
+    mapget::Point const& wgsPoint,
+    mapget::Point const& originWgs,
+    double originWorldY,
+    double unitsPerMeter,
+    double unitsPerMeter2)
+{
+    // Mercator world X is linear in longitude, so only Y needs the transcendental term.
+    auto const deltaWorldX = (wgsPoint.x - originWgs.x) * (kMercatorTileSize / 360.0);
+    auto const deltaWorldY = mercatorWorldY(wgsPoint.y) - originWorldY;
+    auto const yMeters = deltaWorldY / unitsPerMeter;
+    auto const xDenominator = unitsPerMeter + unitsPerMeter2 * yMeters;
+    auto const xMeters = std::abs(xDenominator) < 1e-12 ? 0.0 : deltaWorldX / xDenominator;
+    return {xMeters, yMeters, wgsPoint.z - originWgs.z};
+}
+
+/**
+ * Every arena block starts at a multiple of this, so Float64 views stay aligned. Views into
+ * the middle of a block (low-fi LOD sub-ranges) stay aligned to their own element size.
+ */
+constexpr size_t kRenderArenaAlignment = 8;
+
+/** Typed-array constructor name the frontend uses to view an arena slice of element type `T`. */
+template <typename T>
+char const* arenaElementType()
+{
+    if constexpr (std::is_same_v<T, float>) {
+        return "Float32Array";
+    } else if constexpr (std::is_same_v<T, double>) {
+        return "Float64Array";
+    } else if constexpr (std::is_same_v<T, uint32_t>) {
+        return "Uint32Array";
+    } else if constexpr (std::is_same_v<T, uint8_t>) {
+        return "Uint8Array";
+    } else {
+        static_assert(always_false<T>::value, "Unsupported render arena element type.");
+    }
+}
+
+/**
+ * Visit every typed buffer of one geometry bucket set as `(bucket, field, vector)`.
+ * Bucket and field names match the keys produced by `geometryBuffersToJs`. The
+ * visit order is fixed, so two buffer sets can be walked column by column.
+ * Label columns are only visited if labels are emitted as columnar buffers.
+ */
+template <typename Buffers, typename Fn>
+void forEachTypedBuffer(Buffers& buffers, bool withLabels, Fn&& fn)
+{
+    auto const visitPoints = [&fn](char const* bucket, auto& points) {
+        fn(bucket, "positions", points.positions);
+        fn(bucket, "colors", points.colors);
+        fn(bucket, "radii", points.radii);
+        fn(bucket, "depthTests", points.depthTests);
+        fn(bucket, "featureAddresses", points.featureAddresses);
+    };
+    auto const visitPaths = [&fn](char const* bucket, auto& paths, bool withDashArrays)
+    {
+        fn(bucket, "positions", paths.positions);
+        fn(bucket, "startIndices", paths.startIndices);
+        fn(bucket, "colors", paths.colors);
+        fn(bucket, "widths", paths.widths);
+        fn(bucket, "depthTests", paths.depthTests);
+        fn(bucket, "featureAddresses", paths.featureAddresses);
+        if (withDashArrays) {
+            fn(bucket, "dashArrays", paths.dashArray);
+        }
+    };
+    auto const visitLabels = [&fn](char const* bucket, auto& labels) {
+        fn(bucket, "positions", labels.positions);
+        fn(bucket, "text", labels.text);
+        fn(bucket, "textOffsets", labels.textOffsets);
+        fn(bucket, "fillColors", labels.fillColors);
+        fn(bucket, "outlineColors", labels.outlineColors);
+        fn(bucket, "outlineWidths", labels.outlineWidths);
+        fn(bucket, "scales", labels.scales);
+        fn(bucket, "pixelOffsets", labels.pixelOffsets);
+        fn(bucket, "flags", labels.flags);
+        fn(bucket, "featureAddresses", labels.featureAddresses);
+    };
+    visitPoints("pointWorld", buffers.pointWorld);
+    visitPoints("pointBillboard", buffers.pointBillboard);
+    if (withLabels) {
+        visitLabels("labelWorld", buffers.labelWorld);
+        visitLabels("labelBillboard", buffers.labelBillboard);
+    }
+    fn("surface", "positions", buffers.surfaces.surfacePositions);
+    fn("surface", "startIndices", buffers.surfaces.surfaceStartIndices);
+    fn("surface", "colors", buffers.surfaces.surfaceColors);
+    fn("surface", "depthTests", buffers.surfaces.depthTests);
+    fn("surface", "featureAddresses", buffers.surfaces.surfaceFeatureAddresses);
+    fn("surface", "indices", buffers.surfaces.surfaceIndices);
+    fn("surface", "indexStartIndices", buffers.surfaces.surfaceIndexStartIndices);
+    fn("mesh", "positions", buffers.meshes.positions);
+    fn("mesh", "startIndices", buffers.meshes.startIndices);
+    fn("mesh", "indices", buffers.meshes.indices);
+    fn("mesh", "indexStartIndices", buffers.meshes.indexStartIndices);
+    fn("mesh", "colors", buffers.meshes.colors);
+    fn("mesh", "depthTests", buffers.meshes.depthTests);
+    fn("mesh", "featureAddresses", buffers.meshes.featureAddresses);
+    visitPaths("pathWorld", buffers.pathWorld, true);
+    visitPaths("pathBillboard", buffers.pathBillboard, true);
+    visitPaths("arrowWorld", buffers.arrowWorld, false);
+    visitPaths("arrowBillboard", buffers.arrowBillboard, false);
+    fn("gltfNodes", "nodeIndices", buffers.gltfNodes.nodeIndices);
+    fn("gltfNodes", "colors", buffers.gltfNodes.colors);
+    fn("gltfNodes", "depthTests", buffers.gltfNodes.depthTests);
+    fn("gltfNodes", "featureAddresses", buffers.gltfNodes.featureAddresses);
+    fn("gltfPickProxies", "positions", buffers.gltfPickProxies.positions);
+    fn("gltfPickProxies", "startIndices", buffers.gltfPickProxies.startIndices);
+    fn("gltfPickProxies", "nodeIndices", buffers.gltfPickProxies.nodeIndices);
+    fn("gltfPickProxies", "featureAddresses", buffers.gltfPickProxies.featureAddresses);
+}
+
+/** Hash for mesh vertex keys made of the bit patterns of three floats. */
+struct MeshVertexKeyHash
+{
+    size_t operator()(std::array<uint32_t, 3> const& key) const
+    {
+        uint64_t hash = key[0];
+        hash = hash * 0x9e3779b97f4a7c15ull + key[1];
+        hash = hash * 0x9e3779b97f4a7c15ull + key[2];
+        return static_cast<size_t>(hash ^ (hash >> 29));
+    }
+};
+
+/** Report whether a column holds cumulative offsets, which must be rebased when LOD segments are joined. */
+bool isOffsetColumn(char const* field)
+{
+    return std::strcmp(field, "startIndices") == 0 || std::strcmp(field, "textOffsets") == 0 ||
+        std::strcmp(field, "indexStartIndices") == 0;
+}
+
+/** Append the offsets of `src` after its leading zero, shifted by the current end of `dst`. */
+void appendRebasedOffsets(std::vector<uint32_t>& dst, std::vector<uint32_t> const& src)
+{
+    if (dst.empty()) {
+        dst.push_back(0);
+    }
+    auto const base = dst.back();
+    for (size_t i = 1; i < src.size(); ++i) {
+        dst.push_back(base + src[i]);
+    }
+}
+
+/** Append every column of `source` to `target`, rebasing the offset columns onto `target`. */
+void appendGeometryBuffers(
+    DeckFeatureLayerVisualization::GeometryBuffers& target,
+    DeckFeatureLayerVisualization::GeometryBuffers const& source)
+{
+    std::vector<void const*> sourceColumns;
+    forEachTypedBuffer(source, true, [&sourceColumns](char const*, char const*, auto const& values) {
+        sourceColumns.push_back(&values);
+    });
+    size_t column = 0;
+    forEachTypedBuffer(target, true, [&sourceColumns, &column](char const*, char const* field, auto& values) {
+        using Column = std::decay_t<decltype(values)>;
+        auto const& sourceColumn = *static_cast<Column const*>(sourceColumns[column++]);
+        if constexpr (std::is_same_v<typename Column::value_type, uint32_t>) {
+            if (isOffsetColumn(field)) {
+                appendRebasedOffsets(values, sourceColumn);
+                return;
+            }
+        }
+        values.insert(values.end(), sourceColumn.begin(), sourceColumn.end());
+    });
+}
+
+/** Seed every offset column of a buffer set with its leading zero. */
+void initializeOffsetColumns(DeckFeatureLayerVisualization::GeometryBuffers& buffers)
+{
+    forEachTypedBuffer(buffers, true, [](char const*, char const* field, auto& values) {
+        using ElementType = typename std::decay_t<decltype(values)>::value_type;
+        if constexpr (std::is_same_v<ElementType, uint32_t>) {
+            if (isOffsetColumn(field)) {
+                values.push_back(0);
+            }
+        }
+    });
+}
 }
 
 DeckFeatureLayerVisualization::DeckFeatureLayerVisualization(
@@ -143,19 +323,9 @@ DeckFeatureLayerVisualization::DeckFeatureLayerVisualization(
           rawFeatureIdSubset,
           rawFeatureMergeService)
 {
-    aggregateBuffers_.surfaces.surfaceStartIndices.push_back(0);
-    aggregateBuffers_.pathWorld.startIndices.push_back(0);
-    aggregateBuffers_.pathBillboard.startIndices.push_back(0);
-    aggregateBuffers_.arrowWorld.startIndices.push_back(0);
-    aggregateBuffers_.arrowBillboard.startIndices.push_back(0);
-    aggregateBuffers_.gltfPickProxies.startIndices.push_back(0);
+    initializeOffsetColumns(aggregateBuffers_);
     for (auto& lowFiLodBuffer : lowFiLodBuffers_) {
-        lowFiLodBuffer.surfaces.surfaceStartIndices.push_back(0);
-        lowFiLodBuffer.pathWorld.startIndices.push_back(0);
-        lowFiLodBuffer.pathBillboard.startIndices.push_back(0);
-        lowFiLodBuffer.arrowWorld.startIndices.push_back(0);
-        lowFiLodBuffer.arrowBillboard.startIndices.push_back(0);
-        lowFiLodBuffer.gltfPickProxies.startIndices.push_back(0);
+        initializeOffsetColumns(lowFiLodBuffer);
     }
 }
 
@@ -163,7 +333,12 @@ DeckFeatureLayerVisualization::~DeckFeatureLayerVisualization() = default;
 
 uint32_t DeckFeatureLayerVisualization::abiVersion() const
 {
-    return 1u;
+    return abiVersion_;
+}
+
+void DeckFeatureLayerVisualization::setAbiVersion(uint32_t version)
+{
+    abiVersion_ = version == kLabelObjectsAbiVersion ? kLabelObjectsAbiVersion : kColumnarLabelsAbiVersion;
 }
 
 void DeckFeatureLayerVisualization::setGeometryOutputMode(int mode)
@@ -187,6 +362,26 @@ int DeckFeatureLayerVisualization::geometryOutputMode() const
     return static_cast<int>(geometryOutputMode_);
 }
 
+void DeckFeatureLayerVisualization::setTriangulateSurfaces(bool enabled)
+{
+    triangulateSurfaces_ = enabled;
+}
+
+bool DeckFeatureLayerVisualization::triangulateSurfaces() const
+{
+    return triangulateSurfaces_;
+}
+
+void DeckFeatureLayerVisualization::setPerPathAttributes(bool enabled)
+{
+    perPathAttributes_ = enabled;
+}
+
+bool DeckFeatureLayerVisualization::perPathAttributes() const
+{
+    return perPathAttributes_;
+}
+
 JsValue DeckFeatureLayerVisualization::pointBuffersToJs(PointBuffers const& buffers)
 {
     return JsValue::Dict({
@@ -198,6 +393,61 @@ JsValue DeckFeatureLayerVisualization::pointBuffersToJs(PointBuffers const& buff
     });
 }
 
+JsValue DeckFeatureLayerVisualization::labelBuffersToJs(LabelBuffers const& buffers)
+{
+    return JsValue::Dict({
+        {"positions", JsValue::Float32Array(buffers.positions)},
+        {"text", JsValue::Uint8Array(buffers.text)},
+        {"textOffsets", JsValue::Uint32Array(buffers.textOffsets)},
+        {"fillColors", JsValue::Uint8Array(buffers.fillColors)},
+        {"outlineColors", JsValue::Uint8Array(buffers.outlineColors)},
+        {"outlineWidths", JsValue::Float32Array(buffers.outlineWidths)},
+        {"scales", JsValue::Float32Array(buffers.scales)},
+        {"pixelOffsets", JsValue::Float32Array(buffers.pixelOffsets)},
+        {"flags", JsValue::Uint8Array(buffers.flags)},
+        {"featureAddresses", JsValue::Uint32Array(buffers.featureAddresses)},
+    });
+}
+
+JsValue DeckFeatureLayerVisualization::labelObjectsToJs(LabelBuffers const& buffers, bool billboard)
+{
+    auto const colorToJs = [](std::vector<uint8_t> const& colors, size_t label) {
+        return JsValue::List({
+            JsValue(colors[label * 4]),
+            JsValue(colors[label * 4 + 1]),
+            JsValue(colors[label * 4 + 2]),
+            JsValue(colors[label * 4 + 3]),
+        });
+    };
+    auto result = JsValue::List();
+    for (size_t i = 0; i < buffers.featureAddresses.size(); ++i) {
+        auto const textBegin = buffers.text.begin() + buffers.textOffsets[i];
+        auto const textEnd = buffers.text.begin() + buffers.textOffsets[i + 1];
+        auto label = JsValue::Dict({
+            {"featureAddress", JsValue(buffers.featureAddresses[i])},
+            {"position", JsValue(mapget::Point{
+                buffers.positions[i * 3],
+                buffers.positions[i * 3 + 1],
+                buffers.positions[i * 3 + 2]})},
+            {"text", JsValue(std::string(textBegin, textEnd))},
+            {"fillColor", colorToJs(buffers.fillColors, i)},
+            {"outlineColor", colorToJs(buffers.outlineColors, i)},
+            {"outlineWidth", JsValue(buffers.outlineWidths[i])},
+            {"scale", JsValue(buffers.scales[i])},
+            {"billboard", JsValue(billboard)},
+            {"depthTest", JsValue((buffers.flags[i] & kLabelFlagDepthTest) != 0)}
+        });
+        if (buffers.flags[i] & kLabelFlagPixelOffset) {
+            label.set("pixelOffset", JsValue::List({
+                JsValue(buffers.pixelOffsets[i * 2]),
+                JsValue(buffers.pixelOffsets[i * 2 + 1]),
+            }));
+        }
+        result.push(label);
+    }
+    return result;
+}
+
 JsValue DeckFeatureLayerVisualization::surfaceBuffersToJs(SurfaceBuffers const& buffers)
 {
     return JsValue::Dict({
@@ -206,6 +456,21 @@ JsValue DeckFeatureLayerVisualization::surfaceBuffersToJs(SurfaceBuffers const&
         {"colors", JsValue::Uint8Array(buffers.surfaceColors)},
         {"depthTests", JsValue::Uint8Array(buffers.depthTests)},
         {"featureAddresses", JsValue::Uint32Array(buffers.surfaceFeatureAddresses)},
+        {"indices", JsValue::Uint32Array(buffers.surfaceIndices)},
+        {"indexStartIndices", JsValue::Uint32Array(buffers.surfaceIndexStartIndices)},
+    });
+}
+
+JsValue DeckFeatureLayerVisualization::meshBuffersToJs(MeshBuffers const& buffers)
+{
+    return JsValue::Dict({
+        {"positions", JsValue::Float32Array(buffers.positions)},
+        {"startIndices", JsValue::Uint32Array(buffers.startIndices)},
+        {"indices", JsValue::Uint32Array(buffers.indices)},
+        {"indexStartIndices", JsValue::Uint32Array(buffers.indexStartIndices)},
+        {"colors", JsValue::Uint8Array(buffers.colors)},
+        {"depthTests", JsValue::Uint8Array(buffers.depthTests)},
+        {"featureAddresses", JsValue::Uint32Array(buffers.featureAddresses)},
     });
 }
 
@@ -245,22 +510,20 @@ JsValue DeckFeatureLayerVisualization::gltfPickProxyBuffersToJs(GltfPickProxyBuf
     });
 }
 
-JsValue DeckFeatureLayerVisualization::geometryBuffersToJs(GeometryBuffers const& buffers)
+JsValue DeckFeatureLayerVisualization::geometryBuffersToJs(GeometryBuffers const& buffers) const
 {
-    auto labelWorld = JsValue::List();
-    for (auto const& label : buffers.labelWorld) {
-        labelWorld.push(label);
-    }
-    auto labelBillboard = JsValue::List();
-    for (auto const& label : buffers.labelBillboard) {
-        labelBillboard.push(label);
-    }
+    auto const columnarLabels = abiVersion_ >= kColumnarLabelsAbiVersion;
     return JsValue::Dict({
         {"pointWorld", pointBuffersToJs(buffers.pointWorld)},
         {"pointBillboard", pointBuffersToJs(buffers.pointBillboard)},
-        {"labelWorld", labelWorld},
-        {"labelBillboard", labelBillboard},
+        {"labelWorld", columnarLabels
+            ? labelBuffersToJs(buffers.labelWorld)
+            : labelObjectsToJs(buffers.labelWorld, false)},
+        {"labelBillboard", columnarLabels
+            ? labelBuffersToJs(buffers.labelBillboard)
+            : labelObjectsToJs(buffers.labelBillboard, true)},
         {"surface", surfaceBuffersToJs(buffers.surfaces)},
+        {"mesh", meshBuffersToJs(buffers.meshes)},
         {"pathWorld", pathBuffersToJs(buffers.pathWorld, true)},
         {"pathBillboard", pathBuffersToJs(buffers.pathBillboard, true)},
         {"arrowWorld", pathBuffersToJs(buffers.arrowWorld, false)},
@@ -294,24 +557,218 @@ JsValue DeckFeatureLayerVisualization::lowFiBundleResultsToJs() const
 
 NativeJsValue DeckFeatureLayerVisualization::renderResult() const
 {
-    auto result = geometryBuffersToJs(aggregateBuffers_);
+    auto result = lowFiBundleModeEnabled()
+        ? geometryBuffersToJs(lowFiAggregateBuffers())
+        : geometryBuffersToJs(aggregateBuffers_);
     result.set("coordinateOrigin", coordinateOriginToJs());
     result.set("lowFiBundles", lowFiBundleResultsToJs());
     result.set("mergedPointFeatures", JsValue(mergedPointFeatures()));
     return *result;
 }
 
+NativeJsValue DeckFeatureLayerVisualization::renderResultArena() const
+{
+    /** One typed column of a geometry bucket set, as visited by `forEachTypedBuffer`. */
+    struct ArenaColumn {
+        char const* bucket;
+        char const* field;
+        char const* elementType;
+        size_t elementSize;
+        void const* data;
+        size_t length;
+        std::vector<uint32_t> const* offsets;
+    };
+    /** One aligned arena region holding the parts of a column back to back. */
+    struct ArenaBlock {
+        ArenaColumn const* column;
+        std::vector<std::pair<void const*, size_t>> parts;
+        size_t byteOffset;
+    };
+    /** A typed-array view over a run of consecutive parts of one block. */
+    struct ArenaView {
+        int lod;
+        size_t block;
+        size_t firstPart;
+        size_t numParts;
+    };
+
+    auto const columnarLabels = abiVersion_ >= kColumnarLabelsAbiVersion;
+    auto const columnsOf = [columnarLabels](GeometryBuffers const& buffers) {
+        std::vector<ArenaColumn> columns;
+        forEachTypedBuffer(buffers, columnarLabels, [&columns](char const* bucket, char const* field, auto const& values) {
+            using ElementType = typename std::decay_t<decltype(values)>::value_type;
+            std::vector<uint32_t> const* offsets = nullptr;
+            if constexpr (std::is_same_v<ElementType, uint32_t>) {
+                if (isOffsetColumn(field)) {
+                    offsets = &values;
+                }
+            }
+            columns.push_back({
+                bucket,
+                field,
+                arenaElementType<ElementType>(),
+                sizeof(ElementType),
+                values.data(),
+                values.size(),
+                offsets});
+        });
+        return columns;
+    };
+
+    std::vector<ArenaBlock> blocks;
+    std::vector<ArenaView> views;
+    auto const addBlock = [&blocks](ArenaColumn const& column, void const* data, size_t length) {
+        blocks.push_back({&column, {{data, length}}, 0});
+        return blocks.size() - 1;
+    };
+
+    // The aggregate buckets use lod -1; low-fi bundles keep their LOD bucket index.
+    std::vector<ArenaColumn> aggregateColumns;
+    std::array<std::vector<ArenaColumn>, kLowFiLodCount> lodColumns;
+    std::vector<std::vector<uint32_t>> rebasedOffsets;
+    auto lowFiBundles = JsValue::List();
+    if (!lowFiBundleModeEnabled()) {
+        aggregateColumns = columnsOf(aggregateBuffers_);
+        for (auto const& column : aggregateColumns) {
+            views.push_back({-1, addBlock(column, column.data, column.length), 0, 1});
+        }
+    }
+    else {
+        // Low-fi primitives are written once into their LOD bucket. Each column lays out its
+        // LOD segments back to back, so the aggregate is a prefix view and every bundle a
+        // sub-range view of the same block. Only the offset columns need per-view copies.
+        for (size_t lod = 0; lod < kLowFiLodCount; ++lod) {
+            lodColumns[lod] = columnsOf(lowFiLodBuffers_[lod]);
+        }
+        auto const aggregateLods = aggregateLodCount();
+        rebasedOffsets.reserve(lodColumns[0].size());
+        for (size_t columnIndex = 0; columnIndex < lodColumns[0].size(); ++columnIndex) {
+            auto const& firstColumn = lodColumns[0][columnIndex];
+            if (firstColumn.offsets) {
+                auto& rebased = rebasedOffsets.emplace_back();
+                for (size_t lod = 0; lod < aggregateLods; ++lod) {
+                    appendRebasedOffsets(rebased, *lodColumns[lod][columnIndex].offsets);
+                }
+                views.push_back({-1, addBlock(firstColumn, rebased.data(), rebased.size()), 0, 1});
+                for (size_t lod = 0; lod < kLowFiLodCount; ++lod) {
+                    if (!hasLowFiGeometryForLod(lod)) {
+                        continue;
+                    }
+                    auto const& column = lodColumns[lod][columnIndex];
+                    views.push_back({static_cast<int>(lod), addBlock(column, column.data, column.length), 0, 1});
+                }
+                continue;
+            }
+            auto const block = addBlock(firstColumn, firstColumn.data, firstColumn.length);
+            for (size_t lod = 1; lod < kLowFiLodCount; ++lod) {
+                auto const& column = lodColumns[lod][columnIndex];
+                blocks[block].parts.emplace_back(column.data, column.length);
+            }
+            views.push_back({-1, block, 0, aggregateLods});
+            for (size_t lod = 0; lod < kLowFiLodCount; ++lod) {
+                if (hasLowFiGeometryForLod(lod)) {
+                    views.push_back({static_cast<int>(lod), block, lod, 1});
+                }
+            }
+        }
+        for (size_t lod = 0; lod < kLowFiLodCount; ++lod) {
+            if (!hasLowFiGeometryForLod(lod)) {
+                continue;
+            }
+            auto bundle = JsValue::Dict({{"lod", JsValue(static_cast<double>(lod))}});
+            if (!columnarLabels) {
+                bundle.set("labelWorld", labelObjectsToJs(lowFiLodBuffers_[lod].labelWorld, false));
+                bundle.set("labelBillboard", labelObjectsToJs(lowFiLodBuffers_[lod].labelBillboard, true));
+            }
+            lowFiBundles.push(bundle);
+        }
+    }
+
+    size_t arenaSize = 0;
+    for (auto& block : blocks) {
+        arenaSize = (arenaSize + kRenderArenaAlignment - 1) / kRenderArenaAlignment * kRenderArenaAlignment;
+        block.byteOffset = arenaSize;
+        for (auto const& [data, length] : block.parts) {
+            arenaSize += length * block.column->elementSize;
+        }
+    }
+    renderArena_.assign(arenaSize, 0);
+
+    for (auto const& block : blocks) {
+        auto byteOffset = block.byteOffset;
+        for (auto const& [data, length] : block.parts) {
+            auto const byteLength = length * block.column->elementSize;
+            if (byteLength > 0) {
+                std::memcpy(renderArena_.data() + byteOffset, data, byteLength);
+            }
+            byteOffset += byteLength;
+        }
+    }
+
+    auto descriptors = JsValue::List();
+    for (auto const& view : views) {
+        auto const& block = blocks[view.block];
+        auto byteOffset = block.byteOffset;
+        for (size_t part = 0; part < view.firstPart; ++part) {
+            byteOffset += block.parts[part].second * block.column->elementSize;
+        }
+        size_t length = 0;
+        for (size_t part = view.firstPart; part < view.firstPart + view.numParts; ++part) {
+            length += block.parts[part].second;
+        }
+        descriptors.push(JsValue::Dict({
+            {"lod", JsValue(static_cast<double>(view.lod))},
+            {"bucket", JsValue(std::string(block.column->bucket))},
+            {"field", JsValue(std::string(block.column->field))},
+            {"type", JsValue(std::string(block.column->elementType))},
+            {"byteOffset", JsValue(static_cast<double>(byteOffset))},
+            {"length", JsValue(static_cast<double>(length))},
+        }));
+    }
+
+    auto result = JsValue::Dict({
+        {"arenaPointer", JsValue(static_cast<double>(reinterpret_cast<uintptr_t>(renderArena_.data())))},
+        {"arenaByteLength", JsValue(static_cast<double>(renderArena_.size()))},
+        {"buffers", descriptors},
+        {"lowFiBundles", lowFiBundles},
+    });
+    if (!columnarLabels) {
+        std::optional<GeometryBuffers> lowFiAggregate;
+        if (lowFiBundleModeEnabled()) {
+            lowFiAggregate = lowFiAggregateBuffers();
+        }
+        auto const& aggregate = lowFiAggregate ? *lowFiAggregate : aggregateBuffers_;
+        result.set("labelWorld", labelObjectsToJs(aggregate.labelWorld, false));
+        result.set("labelBillboard", labelObjectsToJs(aggregate.labelBillboard, true));
+    }
+    result.set("coordinateOrigin", coordinateOriginToJs());
+    result.set("mergedPointFeatures", JsValue(mergedPointFeatures()));
+    return *result;
+}
+
+std::vector<uint8_t> const& DeckFeatureLayerVisualization::renderArena() const
+{
+    return renderArena_;
+}
+
 NativeJsValue DeckFeatureLayerVisualization::mergedPointFeatures() const
 {
     auto result = JsValue::Dict();
-    for (auto const& [mapLayerStyleRuleId, primitives] : mergedPointsPerStyleRuleId_) {
+    for (auto const& [ruleIndex, mergedRule] : mergedPointsPerRuleIndex_) {
         auto pointList = JsValue::List();
-        for (auto const& [_, featureIdsAndPoint] : primitives) {
-            if (auto const& pt = featureIdsAndPoint.second) {
-                pointList.push(*pt);
+        for (auto const& cell : mergedRule.cells_) {
+            // The cell hash string is only needed once the payload leaves the visualization.
+            auto pointVisu = cell.parameters_;
+            pointVisu.set("position", JsValue(cell.position_));
+            pointVisu.set("positionHash", JsValue(mergedPointCellHash(cell)));
+            auto featureAddresses = JsValue::List();
+            for (auto const address : cell.featureAddresses_) {
+                featureAddresses.push(JsValue(address));
             }
+            pointVisu.set("featureAddresses", featureAddresses);
+            pointList.push(pointVisu);
         }
-        result.set(mapLayerStyleRuleId, pointList);
+        result.set(std::string(mapLayerStyleRuleId(ruleIndex)), pointList);
     }
     return *result;
 }
@@ -341,10 +798,97 @@ void DeckFeatureLayerVisualization::addTileFeatureLayer(TileFeatureLayer const&
         if (rule.mode() != highlightMode_ || !rule.pointMergeGridCellSize()) {
             continue;
         }
-        mergedPointsPerStyleRuleId_.emplace(
-            makeMapLayerStyleRuleId(rule.index()),
-            std::map<std::string, std::pair<std::unordered_set<uint32_t>, std::optional<JsValue>>>());
+        mergedPointRule(rule.index());
+    }
+}
+
+void DeckFeatureLayerVisualization::cancel()
+{
+    FeatureLayerVisualizationBase::cancel();
+    aggregateBuffers_ = {};
+    initializeOffsetColumns(aggregateBuffers_);
+    for (auto& lowFiLodBuffer : lowFiLodBuffers_) {
+        lowFiLodBuffer = {};
+        initializeOffsetColumns(lowFiLodBuffer);
     }
+    renderArena_ = {};
+}
+
+void DeckFeatureLayerVisualization::resetForNextTile()
+{
+    FeatureLayerVisualizationBase::resetForNextTile();
+    hasPathCoordinateOriginWgs_ = false;
+    hasOriginDistanceScales_ = false;
+    activeFeatureLod_ = 0;
+}
+
+NativeJsValue DeckFeatureLayerVisualization::renderTiles(std::vector<TileFeatureLayer const*> const& tiles)
+{
+    auto results = JsValue::List();
+    for (auto const* tile : tiles) {
+        if (tile_) {
+            resetForNextTile();
+        }
+        addTileFeatureLayer(*tile);
+        run();
+        results.push(JsValue(renderResult()));
+    }
+    return *results;
+}
+
+void DeckFeatureLayerVisualization::runShards(std::vector<DeckFeatureLayerVisualization*> const& shards)
+{
+    // Relation rules and merged points depend on every feature rendered before them, so
+    // this visualization renders them over the whole tile and the shards render the rest.
+    for (auto* shard : shards) {
+        shard->sequentialRules_ = SequentialRules::Skip;
+    }
+    auto const runSequentialRules = [this]() {
+        sequentialRules_ = SequentialRules::Only;
+        run();
+        sequentialRules_ = SequentialRules::Render;
+    };
+#ifdef EMSCRIPTEN
+    // JS values are bound to the thread which created them, so shards run one after another.
+    runSequentialRules();
+    for (auto* shard : shards) {
+        shard->run();
+    }
+#else
+    std::vector<std::thread> workers;
+    workers.reserve(shards.size());
+    for (auto* shard : shards) {
+        workers.emplace_back([shard]() { shard->run(); });
+    }
+    runSequentialRules();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+#endif
+    for (auto const* shard : shards) {
+        // Shard positions are relative to the shard's origin, which must become ours.
+        if (shard->hasPathCoordinateOriginWgs_) {
+            if (!hasPathCoordinateOriginWgs_) {
+                hasPathCoordinateOriginWgs_ = true;
+                pathCoordinateOriginWgs_ = shard->pathCoordinateOriginWgs_;
+                hasOriginDistanceScales_ = shard->hasOriginDistanceScales_;
+                originWorldY_ = shard->originWorldY_;
+                originUnitsPerMeter_ = shard->originUnitsPerMeter_;
+                originUnitsPerMeter2_ = shard->originUnitsPerMeter2_;
+            }
+            assert(
+                shard->pathCoordinateOriginWgs_.x == pathCoordinateOriginWgs_.x &&
+                shard->pathCoordinateOriginWgs_.y == pathCoordinateOriginWgs_.y &&
+                shard->pathCoordinateOriginWgs_.z == pathCoordinateOriginWgs_.z);
+        }
+        appendGeometryBuffers(aggregateBuffers_, shard->aggregateBuffers_);
+        for (size_t lod = 0; lod < kLowFiLodCount; ++lod) {
+            appendGeometryBuffers(lowFiLodBuffers_[lod], shard->lowFiLodBuffers_[lod]);
+        }
+        mergeShardState(*shard);
+    }
+    // Without shard geometry, still report the tile-derived origin instead of [0, 0, 0].
+    ensureProjectionOrigin({});
 }
 
 void DeckFeatureLayerVisualization::onFeatureForRendering(mapget::Feature const& feature)
@@ -363,15 +907,30 @@ bool DeckFeatureLayerVisualization::lowFiBundleModeEnabled() const
     return fidelity_ == FeatureStyleRule::LowFidelity;
 }
 
-bool DeckFeatureLayerVisualization::emitToAggregateForCurrentFeatureLod() const
+size_t DeckFeatureLayerVisualization::aggregateLodCount() const
 {
-    if (fidelity_ != FeatureStyleRule::LowFidelity) {
-        return true;
-    }
     if (maxLowFiLod_ < 0) {
-        return true;
+        return kLowFiLodCount;
     }
-    return static_cast<int>(activeFeatureLod_) <= maxLowFiLod_;
+    return std::min<size_t>(static_cast<size_t>(maxLowFiLod_) + 1, kLowFiLodCount);
+}
+
+DeckFeatureLayerVisualization::GeometryBuffers& DeckFeatureLayerVisualization::emitBuffers()
+{
+    if (!lowFiBundleModeEnabled()) {
+        return aggregateBuffers_;
+    }
+    return lowFiBuffersForLod(static_cast<size_t>(activeLodBucket()));
+}
+
+DeckFeatureLayerVisualization::GeometryBuffers DeckFeatureLayerVisualization::lowFiAggregateBuffers() const
+{
+    GeometryBuffers result;
+    initializeOffsetColumns(result);
+    for (size_t lod = 0; lod < aggregateLodCount(); ++lod) {
+        appendGeometryBuffers(result, lowFiLodBuffers_[lod]);
+    }
+    return result;
 }
 
 uint8_t DeckFeatureLayerVisualization::activeLodBucket() const
@@ -384,11 +943,21 @@ bool DeckFeatureLayerVisualization::hasGeometry(PointBuffers const& buffers)
     return !buffers.positions.empty();
 }
 
+bool DeckFeatureLayerVisualization::hasGeometry(LabelBuffers const& buffers)
+{
+    return !buffers.featureAddresses.empty();
+}
+
 bool DeckFeatureLayerVisualization::hasGeometry(SurfaceBuffers const& buffers)
 {
     return buffers.surfaceStartIndices.size() > 1;
 }
 
+bool DeckFeatureLayerVisualization::hasGeometry(MeshBuffers const& buffers)
+{
+    return buffers.startIndices.size() > 1;
+}
+
 bool DeckFeatureLayerVisualization::hasGeometry(PathBuffers const& buffers)
 {
     return buffers.startIndices.size() > 1;
@@ -408,9 +977,10 @@ bool DeckFeatureLayerVisualization::hasGeometry(GeometryBuffers const& buffers)
 {
     return hasGeometry(buffers.pointWorld)
         || hasGeometry(buffers.pointBillboard)
-        || !buffers.labelWorld.empty()
-        || !buffers.labelBillboard.empty()
+        || hasGeometry(buffers.labelWorld)
+        || hasGeometry(buffers.labelBillboard)
         || hasGeometry(buffers.surfaces)
+        || hasGeometry(buffers.meshes)
         || hasGeometry(buffers.pathWorld)
         || hasGeometry(buffers.pathBillboard)
         || hasGeometry(buffers.arrowWorld)
@@ -443,22 +1013,29 @@ bool DeckFeatureLayerVisualization::includesNonPointGeometry() const
     return FeatureLayerVisualizationBase::includesNonPointGeometry();
 }
 
-mapget::Point DeckFeatureLayerVisualization::projectWgsPoint(
-    mapget::Point const& wgsPoint) const
+void DeckFeatureLayerVisualization::ensureProjectionOrigin(
+    mapget::Point const& firstWgsPoint) const
 {
-    if (!hasPathCoordinateOriginWgs_) {
-        if (tile_) {
-            auto const tileCenter = tile_->tileId().center();
-            pathCoordinateOriginWgs_ = {tileCenter.x, tileCenter.y, 0.0};
-        } else {
-            pathCoordinateOriginWgs_ = {wgsPoint.x, wgsPoint.y, 0.0};
-        }
-        hasPathCoordinateOriginWgs_ = true;
+    if (hasPathCoordinateOriginWgs_) {
+        return;
     }
+    if (tile_) {
+        auto const tileCenter = tile_->tileId().center();
+        pathCoordinateOriginWgs_ = {tileCenter.x, tileCenter.y, 0.0};
+    } else {
+        pathCoordinateOriginWgs_ = {firstWgsPoint.x, firstWgsPoint.y, 0.0};
+    }
+    hasPathCoordinateOriginWgs_ = true;
+    hasOriginDistanceScales_ = distanceScalesAt(
+        pathCoordinateOriginWgs_.y, originUnitsPerMeter_, originUnitsPerMeter2_);
+    originWorldY_ = mercatorWorldY(pathCoordinateOriginWgs_.y);
+}
 
-    double unitsPerMeter = 0.0;
-    double unitsPerMeter2 = 0.0;
-    if (!distanceScalesAt(pathCoordinateOriginWgs_.y, unitsPerMeter, unitsPerMeter2)) {
+mapget::Point DeckFeatureLayerVisualization::projectWgsPoint(
+    mapget::Point const& wgsPoint) const
+{
+    ensureProjectionOrigin(wgsPoint);
+    if (!hasOriginDistanceScales_) {
         auto const lat0Rad = glm::radians(pathCoordinateOriginWgs_.y);
         auto const dLonRad = glm::radians(wgsPoint.x - pathCoordinateOriginWgs_.x);
         auto const dLatRad = glm::radians(wgsPoint.y - pathCoordinateOriginWgs_.y);
@@ -469,24 +1046,50 @@ mapget::Point DeckFeatureLayerVisualization::projectWgsPoint(
         };
     }
 
-    auto const originWorldX = mercatorWorldX(pathCoordinateOriginWgs_.x);
-    auto const originWorldY = mercatorWorldY(pathCoordinateOriginWgs_.y);
-    auto const pointWorldX = mercatorWorldX(wgsPoint.x);
-    auto const pointWorldY = mercatorWorldY(wgsPoint.y);
-    auto const deltaWorldX = pointWorldX - originWorldX;
-    auto const deltaWorldY = pointWorldY - originWorldY;
+    return metersFromOrigin(
+        wgsPoint,
+        pathCoordinateOriginWgs_,
+        originWorldY_,
+        originUnitsPerMeter_,
+        originUnitsPerMeter2_);
+}
+
+void DeckFeatureLayerVisualization::projectWgsPoints(
+    std::span<mapget::Point const> wgsPoints,
+    std::vector<mapget::Point>& projected) const
+{
+    if (wgsPoints.empty()) {
+        return;
+    }
+    ensureProjectionOrigin(wgsPoints.front());
+    if (!hasOriginDistanceScales_) {
+        FeatureLayerVisualizationBase::projectWgsPoints(wgsPoints, projected);
+        return;
+    }
+
+    // Origin terms live in locals so the loop does not reload the mutable members per point.
+    auto const origin = pathCoordinateOriginWgs_;
+    auto const originWorldY = originWorldY_;
+    auto const unitsPerMeter = originUnitsPerMeter_;
+    auto const unitsPerMeter2 = originUnitsPerMeter2_;
+    projected.reserve(projected.size() + wgsPoints.size());
+    for (auto const& wgsPoint : wgsPoints) {
+        projected.emplace_back(
+            metersFromOrigin(wgsPoint, origin, originWorldY, unitsPerMeter, unitsPerMeter2));
+    }
+}
 
-    // Invert math.gl addMetersToLngLat:
-    // worldDeltaY = yMeters * unitsPerMeter
-    // worldDeltaX = xMeters * (unitsPerMeter + unitsPerMeter2 * yMeters)
-    auto const yMeters = deltaWorldY / unitsPerMeter;
-    auto const xDenominator = unitsPerMeter + unitsPerMeter2 * yMeters;
-    auto const xMeters = std::abs(xDenominator) < 1e-12 ? 0.0 : deltaWorldX / xDenominator;
-    return {
-        xMeters,
-        yMeters,
-        wgsPoint.z - pathCoordinateOriginWgs_.z,
-    };
+double DeckFeatureLayerVisualization::projectedUnitsPerPixel() const
+{
+    if (!tile_) {
+        return 0.;
+    }
+    // Projected positions are meters; a tile is drawn about one mercator tile wide at its level.
+    auto const tileId = tile_->tileId();
+    auto const widthDegrees = tileId.ne().x - tileId.sw().x;
+    auto const metersPerDegree =
+        kEarthCircumferenceMeters / 360. * std::cos(glm::radians(tileId.center().y));
+    return std::abs(widthDegrees) * metersPerDegree / kMercatorTileSize;
 }
 
 std::string DeckFeatureLayerVisualization::makeMapLayerStyleRuleId(uint32_t ruleIndex) const
@@ -502,12 +1105,12 @@ std::string DeckFeatureLayerVisualization::makeMapLayerStyleRuleId(uint32_t rule
 }
 
 void DeckFeatureLayerVisualization::emitPoint(
-    JsValue const& xyzPos,
+    mapget::Point const& xyzPos,
     FeatureStyleRule const& rule,
     uint32_t tileFeatureId,
     BoundEvalFun& evalFun)
 {
-    appendPointGeometry(pointFromJsValue(xyzPos), rule, tileFeatureId, evalFun);
+    appendPointGeometry(xyzPos, rule, tileFeatureId, evalFun);
 }
 
 void DeckFeatureLayerVisualization::emitPolygon(
@@ -525,16 +1128,44 @@ void DeckFeatureLayerVisualization::emitMesh(
     uint32_t tileFeatureId,
     BoundEvalFun& evalFun)
 {
-    if (vertsCartesian.size() < 3) {
+    auto const numTriangleVertices = vertsCartesian.size() - vertsCartesian.size() % 3;
+    if (numTriangleVertices < 3) {
         return;
     }
-    for (size_t i = 0; i + 2 < vertsCartesian.size(); i += 3) {
-        appendSurfaceGeometry(
-            {vertsCartesian[i], vertsCartesian[i + 1], vertsCartesian[i + 2]},
-            rule,
-            tileFeatureId,
-            evalFun);
+
+    auto const color = rule.color(evalFun);
+    auto& buffers = emitBuffers().meshes;
+    auto const firstVertex = static_cast<uint32_t>(buffers.positions.size() / 3);
+
+    // Triangle soups repeat shared corners; key vertices by their emitted float bits.
+    std::unordered_map<std::array<uint32_t, 3>, uint32_t, MeshVertexKeyHash> vertexIndices;
+    vertexIndices.reserve(numTriangleVertices);
+    for (size_t i = 0; i < numTriangleVertices; ++i) {
+        std::array<float, 3> const position{
+            static_cast<float>(vertsCartesian[i].x),
+            static_cast<float>(vertsCartesian[i].y),
+            static_cast<float>(vertsCartesian[i].z)};
+        std::array<uint32_t, 3> key{};
+        std::memcpy(key.data(), position.data(), sizeof(key));
+        auto const [it, inserted] = vertexIndices.try_emplace(
+            key,
+            static_cast<uint32_t>(buffers.positions.size() / 3) - firstVertex);
+        if (inserted) {
+            buffers.positions.insert(buffers.positions.end(), position.begin(), position.end());
+        }
+        buffers.indices.push_back(it->second);
     }
+
+    buffers.startIndices.push_back(static_cast<uint32_t>(buffers.positions.size() / 3));
+    buffers.indexStartIndices.push_back(static_cast<uint32_t>(buffers.indices.size()));
+    buffers.colors.push_back(toColorByte(color.r));
+    buffers.colors.push_back(toColorByte(color.g));
+    buffers.colors.push_back(toColorByte(color.b));
+    buffers.colors.push_back(toColorByte(color.a));
+    buffers.depthTests.push_back(rule.depthTest() ? 1U : 0U);
+    buffers.featureAddresses.push_back(rule.selectable() ? tileFeatureId : kUnselectableFeatureIndex);
+
+    featuresAdded_ = true;
 }
 
 void DeckFeatureLayerVisualization::emitGltfNode(
@@ -559,13 +1190,7 @@ void DeckFeatureLayerVisualization::emitGltfNode(
         buffers.featureAddresses.push_back(selectableFeatureId);
     };
 
-    if (emitToAggregateForCurrentFeatureLod()) {
-        appendToBuffers(aggregateBuffers_.gltfNodes);
-    }
-    if (lowFiBundleModeEnabled()) {
-        auto const featureLod = static_cast<size_t>(activeLodBucket());
-        appendToBuffers(lowFiBuffersForLod(featureLod).gltfNodes);
-    }
+    appendToBuffers(emitBuffers().gltfNodes);
     if (selectableFeatureId != kUnselectableFeatureIndex) {
         auto const p000 = aabbOriginWgs;
         auto const p100 = mapget::Point{aabbOriginWgs.x + aabbSizeWgs.x, aabbOriginWgs.y, aabbOriginWgs.z};
@@ -618,64 +1243,65 @@ void DeckFeatureLayerVisualization::emitGltfNode(
             buffers.featureAddresses.push_back(selectableFeatureId);
         };
 
-        if (emitToAggregateForCurrentFeatureLod()) {
-            appendPickProxyToBuffers(aggregateBuffers_.gltfPickProxies);
-        }
-        if (lowFiBundleModeEnabled()) {
-            auto const featureLod = static_cast<size_t>(activeLodBucket());
-            appendPickProxyToBuffers(lowFiBuffersForLod(featureLod).gltfPickProxies);
-        }
+        appendPickProxyToBuffers(emitBuffers().gltfPickProxies);
     }
     featuresAdded_ = true;
 }
 
 void DeckFeatureLayerVisualization::emitIcon(
-    JsValue const& xyzPos,
+    mapget::Point const& xyzPos,
     FeatureStyleRule const& rule,
     uint32_t tileFeatureId,
     BoundEvalFun& evalFun)
 {
-    appendPointGeometry(pointFromJsValue(xyzPos), rule, tileFeatureId, evalFun);
+    appendPointGeometry(xyzPos, rule, tileFeatureId, evalFun);
 }
 
 void DeckFeatureLayerVisualization::emitLabel(
-    JsValue const& xyzPos,
+    mapget::Point const& xyzPos,
     std::string const& text,
     FeatureStyleRule const& rule,
     uint32_t tileFeatureId,
     BoundEvalFun& evalFun)
 {
     (void) evalFun;
+    auto const& position = xyzPos;
     auto const selectableFeatureId = rule.selectable() ? tileFeatureId : kUnselectableFeatureIndex;
-    auto params = JsValue::Dict({
-        {"featureAddress", JsValue(selectableFeatureId)},
-        {"position", xyzPos},
-        {"text", JsValue(text)},
-        {"fillColor", rgbaBytesFromColor(rule.labelColor())},
-        {"outlineColor", rgbaBytesFromColor(rule.labelOutlineColor())},
-        {"outlineWidth", JsValue(rule.labelOutlineWidth())},
-        {"scale", JsValue(rule.labelScale())},
-        {"billboard", JsValue(resolveLabelBillboard(rule))},
-        {"depthTest", JsValue(rule.depthTest())}
-    });
-    if (auto const& pixelOffset = rule.labelPixelOffset()) {
-        params.set("pixelOffset", JsValue::List({
-            JsValue(pixelOffset->first),
-            JsValue(pixelOffset->second),
-        }));
+    auto const& fillColor = rule.labelColor();
+    auto const& outlineColor = rule.labelOutlineColor();
+    auto const& pixelOffset = rule.labelPixelOffset();
+    uint8_t flags = 0;
+    if (rule.depthTest()) {
+        flags |= kLabelFlagDepthTest;
+    }
+    if (pixelOffset) {
+        flags |= kLabelFlagPixelOffset;
     }
     auto const billboard = resolveLabelBillboard(rule);
-    auto appendToBuffers = [&](GeometryBuffers& buffers)
+    auto appendToBuffers = [&](GeometryBuffers& geometryBuffers)
     {
-        (billboard ? buffers.labelBillboard : buffers.labelWorld).push_back(params);
+        auto& buffers = billboard ? geometryBuffers.labelBillboard : geometryBuffers.labelWorld;
+        buffers.positions.push_back(static_cast<float>(position.x));
+        buffers.positions.push_back(static_cast<float>(position.y));
+        buffers.positions.push_back(static_cast<float>(position.z));
+        buffers.text.insert(buffers.text.end(), text.begin(), text.end());
+        buffers.textOffsets.push_back(static_cast<uint32_t>(buffers.text.size()));
+        buffers.fillColors.push_back(toColorByte(fillColor.r));
+        buffers.fillColors.push_back(toColorByte(fillColor.g));
+        buffers.fillColors.push_back(toColorByte(fillColor.b));
+        buffers.fillColors.push_back(toColorByte(fillColor.a));
+        buffers.outlineColors.push_back(toColorByte(outlineColor.r));
+        buffers.outlineColors.push_back(toColorByte(outlineColor.g));
+        buffers.outlineColors.push_back(toColorByte(outlineColor.b));
+        buffers.outlineColors.push_back(toColorByte(outlineColor.a));
+        buffers.outlineWidths.push_back(rule.labelOutlineWidth());
+        buffers.scales.push_back(rule.labelScale());
+        buffers.pixelOffsets.push_back(pixelOffset ? pixelOffset->first : 0.f);
+        buffers.pixelOffsets.push_back(pixelOffset ? pixelOffset->second : 0.f);
+        buffers.flags.push_back(flags);
+        buffers.featureAddresses.push_back(selectableFeatureId);
     };
-    if (emitToAggregateForCurrentFeatureLod()) {
-        appendToBuffers(aggregateBuffers_);
-    }
-    if (lowFiBundleModeEnabled()) {
-        auto const featureLod = static_cast<size_t>(activeLodBucket());
-        appendToBuffers(lowFiBuffersForLod(featureLod));
-    }
+    appendToBuffers(emitBuffers());
     featuresAdded_ = true;
 }
 
@@ -769,14 +1395,8 @@ void DeckFeatureLayerVisualization::appendPointGeometry(
         buffers.featureAddresses.push_back(selectableFeatureId);
     };
 
-    if (emitToAggregateForCurrentFeatureLod()) {
-        appendToBuffers(billboard ? aggregateBuffers_.pointBillboard : aggregateBuffers_.pointWorld);
-    }
-    if (lowFiBundleModeEnabled()) {
-        auto const featureLod = static_cast<size_t>(activeLodBucket());
-        auto& lowFiBuffers = lowFiBuffersForLod(featureLod);
-        appendToBuffers(billboard ? lowFiBuffers.pointBillboard : lowFiBuffers.pointWorld);
-    }
+    auto& targetBuffers = emitBuffers();
+    appendToBuffers(billboard ? targetBuffers.pointBillboard : targetBuffers.pointWorld);
 
     featuresAdded_ = true;
 }
@@ -791,10 +1411,23 @@ void DeckFeatureLayerVisualization::appendSurfaceGeometry(
         return;
     }
 
+    // Triangulating here moves tessellation off the consumer's thread.
+    std::vector<uint32_t> triangleIndices;
+    if (triangulateSurfaces_) {
+        triangleIndices = triangulatePolygon(vertsCartesian);
+        if (triangleIndices.empty()) {
+            return;
+        }
+    }
+
     auto const color = rule.color(evalFun);
     auto const selectableFeatureId = rule.selectable() ? tileFeatureId : kUnselectableFeatureIndex;
     auto appendToBuffers = [&](SurfaceBuffers& buffers)
     {
+        if (triangulateSurfaces_) {
+            buffers.surfaceIndices.insert(buffers.surfaceIndices.end(), triangleIndices.begin(), triangleIndices.end());
+            buffers.surfaceIndexStartIndices.push_back(static_cast<uint32_t>(buffers.surfaceIndices.size()));
+        }
         for (auto const& point : vertsCartesian) {
             buffers.surfacePositions.push_back(static_cast<float>(point.x));
             buffers.surfacePositions.push_back(static_cast<float>(point.y));
@@ -809,13 +1442,7 @@ void DeckFeatureLayerVisualization::appendSurfaceGeometry(
         buffers.surfaceFeatureAddresses.push_back(selectableFeatureId);
     };
 
-    if (emitToAggregateForCurrentFeatureLod()) {
-        appendToBuffers(aggregateBuffers_.surfaces);
-    }
-    if (lowFiBundleModeEnabled()) {
-        auto const featureLod = static_cast<size_t>(activeLodBucket());
-        appendToBuffers(lowFiBuffersForLod(featureLod).surfaces);
-    }
+    appendToBuffers(emitBuffers().surfaces);
 
     featuresAdded_ = true;
 }
@@ -880,12 +1507,16 @@ void DeckFeatureLayerVisualization::appendPathGeometry(
     auto const selectableFeatureId = rule.selectable() ? tileFeatureId : kUnselectableFeatureIndex;
     auto const dashed = enableDash && rule.isDashed();
     auto const dashLength = static_cast<float>(std::max(1, rule.dashLength()));
+    // Style attributes are evaluated once per feature, so per-path storage loses nothing.
+    auto const attributeCount = perPathAttributes_ ? size_t{1} : vertsCartesian.size();
     auto appendToBuffers = [&](PathBuffers& buffers)
     {
         for (auto const& point : vertsCartesian) {
             buffers.positions.push_back(static_cast<float>(point.x));
             buffers.positions.push_back(static_cast<float>(point.y));
             buffers.positions.push_back(static_cast<float>(point.z));
+        }
+        for (size_t i = 0; i < attributeCount; ++i) {
             buffers.colors.push_back(toColorByte(color.r));
             buffers.colors.push_back(toColorByte(color.g));
             buffers.colors.push_back(toColorByte(color.b));
@@ -905,14 +1536,8 @@ void DeckFeatureLayerVisualization::appendPathGeometry(
         buffers.startIndices.push_back(static_cast<uint32_t>(buffers.positions.size() / 3));
     };
 
-    if (emitToAggregateForCurrentFeatureLod()) {
-        appendToBuffers(billboard ? aggregateBuffers_.pathBillboard : aggregateBuffers_.pathWorld);
-    }
-    if (lowFiBundleModeEnabled()) {
-        auto const featureLod = static_cast<size_t>(activeLodBucket());
-        auto& lowFiBuffers = lowFiBuffersForLod(featureLod);
-        appendToBuffers(billboard ? lowFiBuffers.pathBillboard : lowFiBuffers.pathWorld);
-    }
+    auto& targetBuffers = emitBuffers();
+    appendToBuffers(billboard ? targetBuffers.pathBillboard : targetBuffers.pathWorld);
 
     featuresAdded_ = true;
 }
@@ -932,12 +1557,15 @@ void DeckFeatureLayerVisualization::appendArrowGeometry(
     auto const billboard = resolvePathBillboard(rule);
     auto const selectableFeatureId = rule.selectable() ? tileFeatureId : kUnselectableFeatureIndex;
     auto const normalizedWidth = std::max(1.0f, width);
+    auto const attributeCount = perPathAttributes_ ? size_t{1} : vertsCartesian.size();
     auto appendToBuffers = [&](PathBuffers& buffers)
     {
         for (auto const& point : vertsCartesian) {
             buffers.positions.push_back(static_cast<float>(point.x));
             buffers.positions.push_back(static_cast<float>(point.y));
             buffers.positions.push_back(static_cast<float>(point.z));
+        }
+        for (size_t i = 0; i < attributeCount; ++i) {
             buffers.colors.push_back(toColorByte(color.r));
             buffers.colors.push_back(toColorByte(color.g));
             buffers.colors.push_back(toColorByte(color.b));
@@ -949,14 +1577,8 @@ void DeckFeatureLayerVisualization::appendArrowGeometry(
         buffers.startIndices.push_back(static_cast<uint32_t>(buffers.positions.size() / 3));
     };
 
-    if (emitToAggregateForCurrentFeatureLod()) {
-        appendToBuffers(billboard ? aggregateBuffers_.arrowBillboard : aggregateBuffers_.arrowWorld);
-    }
-    if (lowFiBundleModeEnabled()) {
-        auto const featureLod = static_cast<size_t>(activeLodBucket());
-        auto& lowFiBuffers = lowFiBuffersForLod(featureLod);
-        appendToBuffers(billboard ? lowFiBuffers.arrowBillboard : lowFiBuffers.arrowWorld);
-    }
+    auto& targetBuffers = emitBuffers();
+    appendToBuffers(billboard ? targetBuffers.arrowBillboard : targetBuffers.arrowWorld);
 
     featuresAdded_ = true;
 }
@@ -1047,4 +1669,69 @@ std::uint8_t DeckFeatureLayerVisualization::toColorByte(float value)
     return static_cast<std::uint8_t>(scaled);
 }
 
+DeckMultiStyleVisualization::DeckMultiStyleVisualization(
+    int viewIndex,
+    std::string const& mapTileKey,
+    std::vector<FeatureLayerStyle const*> const& styles,
+    NativeJsValue const& rawOptionValuesPerStyle,
+    NativeJsValue const& rawFeatureMergeService,
+    FeatureStyleRule::HighlightMode const& highlightMode,
+    FeatureStyleRule::Fidelity fidelity,
+    int highFidelityStage,
+    int maxLowFiLod,
+    int geometryOutputMode)
+{
+    auto const optionValuesPerStyle = JsValue(rawOptionValuesPerStyle);
+    visualizations_.reserve(styles.size());
+    for (size_t i = 0; i < styles.size(); ++i) {
+        auto const optionValues = i < optionValuesPerStyle.size()
+            ? optionValuesPerStyle.at(static_cast<uint32_t>(i))
+            : JsValue::Dict();
+        visualizations_.push_back(std::make_unique<DeckFeatureLayerVisualization>(
+            viewIndex,
+            mapTileKey,
+            *styles[i],
+            *optionValues,
+            rawFeatureMergeService,
+            highlightMode,
+            fidelity,
+            highFidelityStage,
+            maxLowFiLod,
+            geometryOutputMode));
+    }
+}
+
+void DeckMultiStyleVisualization::addTileFeatureLayer(TileFeatureLayer const& tile)
+{
+    if (!strings_) {
+        strings_ = std::make_shared<simfil::StringPool>(*tile.model_->strings());
+        for (auto& visualization : visualizations_) {
+            visualization->setSharedStringPool(strings_);
+        }
+    }
+    for (auto& visualization : visualizations_) {
+        visualization->addTileFeatureLayer(tile);
+    }
+}
+
+void DeckMultiStyleVisualization::run()
+{
+    std::vector<FeatureLayerVisualizationBase*> visualizations;
+    visualizations.reserve(visualizations_.size());
+    for (auto& visualization : visualizations_) {
+        visualizations.push_back(visualization.get());
+    }
+    FeatureLayerVisualizationBase::runJointly(visualizations);
+}
+
+uint32_t DeckMultiStyleVisualization::size() const
+{
+    return static_cast<uint32_t>(visualizations_.size());
+}
+
+DeckFeatureLayerVisualization& DeckMultiStyleVisualization::visualization(uint32_t index)
+{
+    return *visualizations_[index];
+}
+
 }  // namespace erdblick
@@ -0,0 +1,320 @@
+#include "erdblick/parser.h"
+#include "erdblick/testdataprovider.h"
+#include "erdblick/visualization.h"
+#include "nlohmann/json.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace erdblick;
+
+namespace {
+
+/** Command-line configuration of one benchmark run. */
+struct BenchConfig
+{
+    TestDataProvider::SyntheticTileParams tile;
+    double lon = 11.;
+    double lat = 42.;
+    uint16_t level = 13;
+    uint32_t iterations = 10;
+    uint32_t warmup = 2;
+    std::string format = "json";
+    std::string stylePath;
+    std::string outputPath;
+    bool help = false;
+};
+
+/** Wall-clock samples of the three timed pipeline phases. */
+struct PhaseSamples
+{
+    std::vector<double> deserializeMs;
+    std::vector<double> runMs;
+    std::vector<double> renderResultMs;
+};
+
+/** Aggregated statistics of one phase. */
+struct PhaseStats
+{
+    double min = 0.;
+    double median = 0.;
+    double mean = 0.;
+    double max = 0.;
+};
+
+void printUsage(char const* program, std::ostream& out)
+{
+    out
+        << "Usage: " << program << " [options]\n"
+        << "  --ways N                 Number of Way line features (default 2)\n"
+        << "  --signs N                Number of Sign polygon features (default 2)\n"
+        << "  --pois N                 Number of PointOfInterest features (default 5)\n"
+        << "  --ponis N                Number of PointOfNoInterest features (default 5)\n"
+        << "  --diamonds N             Number of Diamond mesh features (default 1)\n"
+        << "  --line-points MIN:MAX    Vertex count range of generated lines (default 2:8)\n"
+        << "  --polygon-points MIN:MAX Vertex count range of generated polygons (default 2:6)\n"
+        << "  --attribute-layers N     Attribute layers per Way (default 1)\n"
+        << "  --attributes N           Attributes per attribute layer (default 1)\n"
+        << "  --relations N            Relations per Diamond (default 1)\n"
+        << "  --seed N                 Random seed (default 1)\n"
+        << "  --level N                Tile level (default 13)\n"
+        << "  --iterations N           Timed iterations (default 10)\n"
+        << "  --warmup N               Untimed warm-up iterations (default 2)\n"
+        << "  --style PATH             Style YAML to render with (default: TestDataProvider style)\n"
+        << "  --format json|csv        Output format (default json)\n"
+        << "  --output PATH            Write results to PATH instead of stdout\n";
+}
+
+bool parseRange(std::string const& value, uint32_t& min, uint32_t& max)
+{
+    auto const separator = value.find(':');
+    if (separator == std::string::npos) {
+        min = max = static_cast<uint32_t>(std::stoul(value));
+        return true;
+    }
+    min = static_cast<uint32_t>(std::stoul(value.substr(0, separator)));
+    max = static_cast<uint32_t>(std::stoul(value.substr(separator + 1)));
+    return min <= max;
+}
+
+bool parseArgs(int argc, char** argv, BenchConfig& config)
+{
+    config.tile.seed = 1;
+    config.tile.verbose = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string const arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            config.help = true;
+            return true;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << std::endl;
+            return false;
+        }
+        std::string const value = argv[++i];
+        try {
+            if (arg == "--ways") config.tile.numWays = std::stoul(value);
+            else if (arg == "--signs") config.tile.numSigns = std::stoul(value);
+            else if (arg == "--pois") config.tile.numPois = std::stoul(value);
+            else if (arg == "--ponis") config.tile.numPonis = std::stoul(value);
+            else if (arg == "--diamonds") config.tile.numDiamonds = std::stoul(value);
+            else if (arg == "--attribute-layers") config.tile.attributeLayersPerWay = std::stoul(value);
+            else if (arg == "--attributes") config.tile.attributesPerLayer = std::stoul(value);
+            else if (arg == "--relations") config.tile.relationsPerDiamond = std::stoul(value);
+            else if (arg == "--seed") config.tile.seed = std::stoul(value);
+            else if (arg == "--level") config.level = static_cast<uint16_t>(std::stoul(value));
+            else if (arg == "--iterations") config.iterations = std::stoul(value);
+            else if (arg == "--warmup") config.warmup = std::stoul(value);
+            else if (arg == "--style") config.stylePath = value;
+            else if (arg == "--format") config.format = value;
+            else if (arg == "--output") config.outputPath = value;
+            else if (arg == "--line-points") {
+                if (!parseRange(value, config.tile.minLinePoints, config.tile.maxLinePoints)) {
+                    std::cerr << "Invalid range for " << arg << ": " << value << std::endl;
+                    return false;
+                }
+            }
+            else if (arg == "--polygon-points") {
+                if (!parseRange(value, config.tile.minPolygonPoints, config.tile.maxPolygonPoints)) {
+                    std::cerr << "Invalid range for " << arg << ": " << value << std::endl;
+                    return false;
+                }
+            }
+            else {
+                std::cerr << "Unknown option " << arg << std::endl;
+                return false;
+            }
+        }
+        catch (std::exception const&) {
+            std::cerr << "Invalid value for " << arg << ": " << value << std::endl;
+            return false;
+        }
+    }
+    if (config.format != "json" && config.format != "csv") {
+        std::cerr << "Unsupported format " << config.format << std::endl;
+        return false;
+    }
+    return config.iterations > 0;
+}
+
+PhaseStats computeStats(std::vector<double> samples)
+{
+    PhaseStats stats;
+    if (samples.empty()) {
+        return stats;
+    }
+    std::sort(samples.begin(), samples.end());
+    stats.min = samples.front();
+    stats.max = samples.back();
+    auto const mid = samples.size() / 2;
+    stats.median = samples.size() % 2 ? samples[mid] : (samples[mid - 1] + samples[mid]) * .5;
+    double sum = 0.;
+    for (auto const sample : samples) {
+        sum += sample;
+    }
+    stats.mean = sum / static_cast<double>(samples.size());
+    return stats;
+}
+
+double elapsedMs(std::chrono::steady_clock::time_point const& start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/** Load the `--style` sheet, or the test style if none was given. Fails if the given file cannot be read. */
+std::optional<FeatureLayerStyle> loadStyle(BenchConfig const& config)
+{
+    if (config.stylePath.empty()) {
+        return TestDataProvider::style();
+    }
+    std::ifstream file(config.stylePath);
+    if (!file) {
+        std::cerr << "Could not open style " << config.stylePath << std::endl;
+        return std::nullopt;
+    }
+    std::stringstream yaml;
+    yaml << file.rdbuf();
+    return FeatureLayerStyle(SharedUint8Array(yaml.str()));
+}
+
+/**
+ * Deserialize, run and pack one tile. Each phase is timed separately, so style
+ * evaluation cost (run) and JS interop cost (renderResult) can be told apart.
+ */
+void runIteration(
+    TileLayerParser& parser,
+    SharedUint8Array const& tileBlob,
+    FeatureLayerStyle const& style,
+    std::string const& tileKey,
+    PhaseSamples* samples)
+{
+    auto start = std::chrono::steady_clock::now();
+    auto tile = parser.readTileFeatureLayer(tileBlob);
+    auto const deserializeMs = elapsedMs(start);
+
+    DeckFeatureLayerVisualization visualization(0, tileKey, style, {}, {});
+    visualization.addTileFeatureLayer(tile);
+
+    start = std::chrono::steady_clock::now();
+    visualization.run();
+    auto const runMs = elapsedMs(start);
+
+    start = std::chrono::steady_clock::now();
+    auto result = visualization.renderResult();
+    auto const renderResultMs = elapsedMs(start);
+
+    if (samples) {
+        samples->deserializeMs.push_back(deserializeMs);
+        samples->runMs.push_back(runMs);
+        samples->renderResultMs.push_back(renderResultMs);
+    }
+}
+
+nlohmann::json statsToJson(PhaseStats const& stats)
+{
+    return {
+        {"minMs", stats.min},
+        {"medianMs", stats.median},
+        {"meanMs", stats.mean},
+        {"maxMs", stats.max}};
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    BenchConfig config;
+    if (!parseArgs(argc, argv, config)) {
+        printUsage(argv[0], std::cerr);
+        return 1;
+    }
+    if (config.help) {
+        printUsage(argv[0], std::cout);
+        return 0;
+    }
+
+    TileLayerParser parser;
+    auto generated = TestDataProvider(parser).getTestLayer(config.lon, config.lat, config.level, config.tile);
+    std::stringstream serialized;
+    generated->write(serialized);
+    SharedUint8Array tileBlob(serialized.str());
+
+    auto const loadedStyle = loadStyle(config);
+    if (!loadedStyle) {
+        return 1;
+    }
+    auto const& style = *loadedStyle;
+    auto const tileKey = generated->mapId() + "/" + generated->layerInfo()->layerId_ + "/" +
+        std::to_string(generated->tileId().value_);
+
+    auto const probe = parser.readTileFeatureLayer(tileBlob);
+    auto const numFeatures = probe.numFeatures();
+    auto const numVertices = probe.numVertices();
+
+    for (uint32_t i = 0; i < config.warmup; ++i) {
+        runIteration(parser, tileBlob, style, tileKey, nullptr);
+    }
+    PhaseSamples samples;
+    for (uint32_t i = 0; i < config.iterations; ++i) {
+        runIteration(parser, tileBlob, style, tileKey, &samples);
+    }
+
+    auto const deserialize = computeStats(samples.deserializeMs);
+    auto const run = computeStats(samples.runMs);
+    auto const renderResult = computeStats(samples.renderResultMs);
+
+    std::ofstream outputFile;
+    if (!config.outputPath.empty()) {
+        outputFile.open(config.outputPath);
+        if (!outputFile) {
+            std::cerr << "Could not open " << config.outputPath << " for writing." << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& out = config.outputPath.empty() ? std::cout : outputFile;
+
+    if (config.format == "csv") {
+        out << "phase,features,vertices,tileBytes,iterations,minMs,medianMs,meanMs,maxMs\n";
+        auto const writeRow = [&](char const* phase, PhaseStats const& stats) {
+            out << phase << ',' << numFeatures << ',' << numVertices << ',' << tileBlob.getSize() << ','
+                << config.iterations << ',' << stats.min << ',' << stats.median << ',' << stats.mean << ','
+                << stats.max << '\n';
+        };
+        writeRow("readTileFeatureLayer", deserialize);
+        writeRow("run", run);
+        writeRow("renderResult", renderResult);
+        return 0;
+    }
+
+    nlohmann::json report{
+        {"style", style.name()},
+        {"tile",
+         {{"key", tileKey},
+          {"features", numFeatures},
+          {"vertices", numVertices},
+          {"bytes", tileBlob.getSize()},
+          {"ways", config.tile.numWays},
+          {"signs", config.tile.numSigns},
+          {"pois", config.tile.numPois},
+          {"ponis", config.tile.numPonis},
+          {"diamonds", config.tile.numDiamonds},
+          {"attributeLayersPerWay", config.tile.attributeLayersPerWay},
+          {"attributesPerLayer", config.tile.attributesPerLayer},
+          {"relationsPerDiamond", config.tile.relationsPerDiamond},
+          {"seed", config.tile.seed}}},
+        {"iterations", config.iterations},
+        {"warmup", config.warmup},
+        {"phases",
+         {{"readTileFeatureLayer", statsToJson(deserialize)},
+          {"run", statsToJson(run)},
+          {"renderResult", statsToJson(renderResult)}}}};
+    out << report.dump(2) << std::endl;
+    return 0;
+}
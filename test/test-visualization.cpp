@@ -1,5 +1,6 @@
 #include <catch2/catch_test_macros.hpp>
 
+#include "erdblick/geometry.h"
 #include "erdblick/inspection.h"
 #include "erdblick/parser.h"
 #include "erdblick/rule.h"
@@ -9,7 +10,11 @@
 #include "nlohmann/json.hpp"
 
 #include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
 #include <iostream>
+#include <map>
 
 using namespace erdblick;
 
@@ -80,6 +85,50 @@ std::shared_ptr<mapget::TileFeatureLayer> makeRelationTestTile(
     return layer;
 }
 
+/** Create an empty tile of the relation test layer, to which a test adds its own features. */
+std::shared_ptr<mapget::TileFeatureLayer> makeEmptyRelationTestTile(mapget::TileId tileId)
+{
+    auto layer = std::make_shared<mapget::TileFeatureLayer>(
+        tileId,
+        "RelationTestNode",
+        "RelationTestMap",
+        relationTestLayerInfo(),
+        std::make_shared<simfil::StringPool>());
+    layer->setIdPrefix({{"areaId", "Area"}});
+    return layer;
+}
+
+/** Create a tile with one Diamond feature per line, with `diamondId` set to the line index. */
+std::shared_ptr<mapget::TileFeatureLayer> makeDiamondLineTile(
+    mapget::TileId tileId,
+    std::vector<std::vector<mapget::Point>> const& lines)
+{
+    auto layer = makeEmptyRelationTestTile(tileId);
+    for (uint32_t i = 0; i < lines.size(); ++i) {
+        layer->newFeature("Diamond", {{"diamondId", i}})->addLine(lines[i]);
+    }
+    return layer;
+}
+
+/** Return `count` short horizontal lines stacked northwards from the tile center. */
+std::vector<std::vector<mapget::Point>> stackedTestLines(mapget::TileId tileId, uint32_t count)
+{
+    auto const center = tileId.center();
+    std::vector<std::vector<mapget::Point>> lines;
+    for (uint32_t i = 0; i < count; ++i) {
+        lines.push_back({
+            {center.x, center.y + i * 0.0001, 0.},
+            {center.x + 0.0005, center.y + i * 0.0001, 0.}});
+    }
+    return lines;
+}
+
+/** Return the path bucket which received geometry, since billboarding depends on the style. */
+std::string renderedPathBucket(nlohmann::json const& renderResult)
+{
+    return renderResult["pathWorld"]["positions"].empty() ? "pathBillboard" : "pathWorld";
+}
+
 FeatureLayerStyle relationTestStyle()
 {
     return FeatureLayerStyle(SharedUint8Array(R"yaml(
@@ -202,7 +251,11 @@ TEST_CASE("DeckFeatureLayerVisualization", "[erdblick.renderer]")
 {
     auto style = TestDataProvider::style();
     DeckFeatureLayerVisualization visualization(0, "Features:Test:Test:0", style, {}, {});
+    REQUIRE(visualization.abiVersion() == DeckFeatureLayerVisualization::kColumnarLabelsAbiVersion);
+    visualization.setAbiVersion(DeckFeatureLayerVisualization::kLabelObjectsAbiVersion);
     REQUIRE(visualization.abiVersion() == 1);
+    visualization.setAbiVersion(42);
+    REQUIRE(visualization.abiVersion() == 2);
 }
 
 TEST_CASE("FeatureInspection", "[erdblick.inspection]")
@@ -249,6 +302,81 @@ TEST_CASE("FeatureInspection preserves external feature-reference map ids", "[er
             std::pair<std::string, std::string>{"Way.3", "ValidationMap"}) != featureRefs.end());
 }
 
+TEST_CASE("TileFeatureLayer resolves features by address", "[erdblick.layer]")
+{
+    auto tile = TileFeatureLayer(makeRelationTestTile(mapget::TileId::fromWgs84(42.0, 11.0, 13), true, true));
+    REQUIRE(tile.numFeatures() == 2);
+
+    auto const diamondId = tile.featureIdByAddress(0);
+    auto const poiId = tile.featureIdByAddress(1);
+    REQUIRE(diamondId.find("Diamond") != std::string::npos);
+    REQUIRE(poiId.find("PointOfInterest") != std::string::npos);
+    REQUIRE(tile.featureByAddress(1)->id()->toString() == poiId);
+    REQUIRE(tile.featureIdByAddress(2).empty());
+    REQUIRE(!tile.featureByAddress(2));
+
+    auto const ids = nlohmann::json(tile.featureIdsByAddresses(nlohmann::json::array({1, 5, 0})));
+    REQUIRE(ids == nlohmann::json::array({poiId, "", diamondId}));
+}
+
+TEST_CASE("simplifyProjectedPolyline drops vertices within tolerance", "[erdblick.geometry]")
+{
+    std::vector<mapget::Point> const line{{0., 0., 0.}, {1., .01, 0.}, {2., -.01, 0.}, {3., 2., 0.}, {4., 2., 0.}};
+
+    auto const simplified = simplifyProjectedPolyline(line, .1, false, false);
+    REQUIRE(simplified.size() == 4);
+    REQUIRE(simplified.front().x == 0.);
+    REQUIRE(simplified[1].x == 2.);
+    REQUIRE(simplified.back().x == 4.);
+    REQUIRE(simplifyProjectedPolyline(line, .1, false, true).size() == simplified.size());
+    REQUIRE(simplifyProjectedPolyline(line, 0., false, false).size() == line.size());
+
+    std::vector<mapget::Point> const ring{{0., 0., 0.}, {1., .01, 0.}, {2., 0., 0.}, {1., 1., 0.}};
+    REQUIRE(simplifyProjectedPolyline(ring, .1, true, true).size() == 3);
+
+    // Rings never collapse below a triangle; the input is kept instead.
+    std::vector<mapget::Point> const thinRing{{0., 0., 0.}, {1., .01, 0.}, {.5, .2, 0.}, {1., 1., 0.}};
+    REQUIRE(simplifyProjectedPolyline(thinRing, 100., true, false).size() == thinRing.size());
+}
+
+TEST_CASE("triangulatePolygon clips concave rings into covering triangles", "[erdblick.geometry]")
+{
+    auto triangleArea = [](std::vector<mapget::Point> const& ring, std::vector<uint32_t> const& indices) {
+        auto area = 0.;
+        for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+            auto const& a = ring[indices[i]];
+            auto const& b = ring[indices[i + 1]];
+            auto const& c = ring[indices[i + 2]];
+            area += std::abs((b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x)) * .5;
+        }
+        return area;
+    };
+
+    // L-shaped footprint with an area of 3, in both windings.
+    std::vector<mapget::Point> lShape{{0., 0., 0.}, {2., 0., 0.}, {2., 1., 0.}, {1., 1., 0.}, {1., 2., 0.}, {0., 2., 0.}};
+    auto indices = triangulatePolygon(lShape);
+    REQUIRE(indices.size() == (lShape.size() - 2) * 3);
+    REQUIRE(triangleArea(lShape, indices) == 3.);
+
+    std::reverse(lShape.begin(), lShape.end());
+    indices = triangulatePolygon(lShape);
+    REQUIRE(indices.size() == (lShape.size() - 2) * 3);
+    REQUIRE(triangleArea(lShape, indices) == 3.);
+
+    // A repeated closing vertex is never referenced.
+    std::vector<mapget::Point> const closedSquare{{0., 0., 0.}, {1., 0., 0.}, {1., 1., 0.}, {0., 1., 0.}, {0., 0., 0.}};
+    indices = triangulatePolygon(closedSquare);
+    REQUIRE(indices.size() == 6);
+    REQUIRE(std::all_of(indices.begin(), indices.end(), [](uint32_t i) { return i < 4; }));
+
+    // Vertical walls are triangulated in their own plane.
+    std::vector<mapget::Point> const wall{{0., 0., 0.}, {1., 0., 0.}, {1., 0., 1.}, {0., 0., 1.}};
+    REQUIRE(triangulatePolygon(wall).size() == 6);
+
+    std::vector<mapget::Point> const collinear{{0., 0., 0.}, {1., 0., 0.}, {2., 0., 0.}};
+    REQUIRE(triangulatePolygon(collinear).empty());
+}
+
 TEST_CASE("FeatureStyleRuleLodFilterParsing", "[erdblick.style]")
 {
     auto yamlWithLod = YAML::Load(R"(
@@ -282,6 +410,132 @@ offset-increment: [4.0, 5.0, 6.0]
     REQUIRE(rule.offsetIncrement() == glm::dvec3(4.0, 5.0, 6.0));
 }
 
+TEST_CASE("FeatureLayerStyle caches type decisions of first-of sub-rules", "[erdblick.style]")
+{
+    auto style = FeatureLayerStyle(SharedUint8Array(R"yaml(
+name: "TypeMatchStyle"
+rules:
+  - type: "Way"
+    geometry: [line]
+  - type: "Poi.*"
+    geometry: [point]
+    first-of:
+      - type: "PointOfInterest"
+      - type: "PointOf.*"
+        first-of:
+          - type: "PointOfNoInterest"
+)yaml"));
+    REQUIRE(style.rules().size() == 2);
+    REQUIRE(style.rules()[1].typeMatchCount() == 4);
+
+    auto const& way = style.ruleTypeMatches("Way");
+    REQUIRE(way.decisions == std::vector<uint8_t>{1, 0, 0, 0, 0});
+    REQUIRE(way.offsetByRule == std::vector<uint32_t>{0, 1});
+
+    auto const& poi = style.ruleTypeMatches("PointOfNoInterest");
+    REQUIRE(poi.decisions == std::vector<uint8_t>{0, 1, 0, 1, 1});
+    REQUIRE(*poi.forRule(1) == 1);
+    REQUIRE(&style.ruleTypeMatches("PointOfNoInterest") == &poi);
+}
+
+TEST_CASE("FeatureLayerStyle shares expression scopes per field dictionary", "[erdblick.style]")
+{
+    auto style = FeatureLayerStyle(SharedUint8Array(R"yaml(
+name: "ScopeTestStyle"
+rules:
+  - type: "Way"
+    geometry: [line]
+)yaml"));
+    auto strings = std::make_shared<simfil::StringPool>();
+    std::map<std::string, simfil::Value> options;
+
+    auto scope = style.expressionScope(strings, options);
+    REQUIRE(scope);
+    REQUIRE(scope->strings_ != strings);
+    REQUIRE(style.expressionScope(strings, options) == scope);
+
+    options.emplace("showLabels", simfil::Value(true));
+    auto scopeWithOptions = style.expressionScope(strings, options);
+    REQUIRE(scopeWithOptions != scope);
+
+    // A grown source dictionary invalidates compiled ASTs, while old holders keep theirs.
+    REQUIRE(strings->emplace("SomeNewField").has_value());
+    auto grownScope = style.expressionScope(strings, options);
+    REQUIRE(grownScope != scopeWithOptions);
+    REQUIRE(scopeWithOptions->strings_);
+
+    // Values containing separators must not alias other option combinations.
+    std::map<std::string, simfil::Value> splitOptions{
+        {"a", simfil::Value::make(std::string("x"))}, {"b", simfil::Value::make(std::string("y"))}};
+    std::map<std::string, simfil::Value> joinedOptions{{"a", simfil::Value::make(std::string("x\nb=y"))}};
+    REQUIRE(style.expressionScope(strings, splitOptions) != style.expressionScope(strings, joinedOptions));
+
+    // Each distinct option value adds a scope, but only the most recent ones are kept.
+    for (int64_t i = 0; i < 2 * static_cast<int64_t>(FeatureLayerStyle::kMaxExpressionScopes); ++i) {
+        options.insert_or_assign("width", simfil::Value::make(i));
+        REQUIRE(style.expressionScope(strings, options));
+    }
+    REQUIRE(style.numExpressionScopes() == FeatureLayerStyle::kMaxExpressionScopes);
+
+    // Scopes of a released dictionary are dropped on the next lookup.
+    auto otherStrings = std::make_shared<simfil::StringPool>();
+    REQUIRE(style.expressionScope(otherStrings, {}));
+    REQUIRE(style.numExpressionScopes() == FeatureLayerStyle::kMaxExpressionScopes);
+    otherStrings.reset();
+    strings.reset();
+    auto freshStrings = std::make_shared<simfil::StringPool>();
+    REQUIRE(style.expressionScope(freshStrings, {}));
+    REQUIRE(style.numExpressionScopes() == 1);
+}
+
+TEST_CASE("FeatureLayerStyle tracks which options each rule reads", "[erdblick.style]")
+{
+    auto style = FeatureLayerStyle(SharedUint8Array(R"yaml(
+name: "OptionDependencyStyle"
+options:
+  - label: Show Ways
+    id: showWays
+    default: true
+  - label: Way Color
+    id: wayColor
+    type: color
+    default: "#ff0000"
+  - label: Show Hover Labels
+    id: showHoverLabels
+    default: false
+  - label: Show Pois
+    id: show-pois
+    default: true
+  - label: Unused
+    id: unused
+    default: false
+rules:
+  - type: "Way"
+    geometry: [line]
+    filter: "showWays and name != 'wayColor showHoverLabels unused'"
+    color-expression: "wayColor"
+  - type: "Poi"
+    geometry: [point]
+    first-of:
+      - type: "Poi"
+        filter: "_['show-pois']"
+  - type: "Way"
+    geometry: [line]
+    mode: hover
+    label-text-expression: "showHoverLabels and name"
+)yaml"));
+    REQUIRE(style.rules().size() == 3);
+
+    REQUIRE(style.optionAffectsHighlightMode("showWays", FeatureStyleRule::NoHighlight));
+    REQUIRE(style.optionAffectsHighlightMode("show-pois", FeatureStyleRule::NoHighlight));
+    REQUIRE_FALSE(style.optionAffectsHighlightMode("unused", FeatureStyleRule::NoHighlight));
+    REQUIRE_FALSE(style.optionAffectsHighlightMode("unused", FeatureStyleRule::HoverHighlight));
+    REQUIRE(style.optionAffectsHighlightMode("wayColor", FeatureStyleRule::NoHighlight));
+    REQUIRE_FALSE(style.optionAffectsHighlightMode("wayColor", FeatureStyleRule::HoverHighlight));
+    REQUIRE_FALSE(style.optionAffectsHighlightMode("showHoverLabels", FeatureStyleRule::NoHighlight));
+    REQUIRE(style.optionAffectsHighlightMode("showHoverLabels", FeatureStyleRule::HoverHighlight));
+}
+
 TEST_CASE("DeckFeatureLayerVisualization renders intra-tile relations", "[erdblick.renderer]")
 {
     auto style = relationTestStyle();
@@ -307,6 +561,39 @@ TEST_CASE("DeckFeatureLayerVisualization resolves relation targets from added au
     visualization.run();
 
     REQUIRE(hasRenderedPathGeometry(nlohmann::json(visualization.renderResult())));
+    // The target was found through the feature id index, not the per-tile fallback.
+    REQUIRE(visualization.numFeatureIdLookupFallbacks() == 0);
+}
+
+TEST_CASE("DeckFeatureLayerVisualization only falls back for unindexed relation target id forms", "[erdblick.renderer]")
+{
+    auto style = relationTestStyle();
+    auto sourceTileId = mapget::TileId::fromWgs84(42.0, 11.0, 13);
+
+    SECTION("A miss on an indexed id form is final")
+    {
+        // The auxiliary tile has a PointOfInterest, but not the referenced one.
+        auto auxiliaryTile = makeEmptyRelationTestTile(sourceTileId.neighbor(1, 0));
+        auxiliaryTile->newFeature("PointOfInterest", {{"pointId", 201}})->addPoint(sourceTileId.center());
+
+        DeckFeatureLayerVisualization visualization(0, "RelationTestMap/RelationLayer/0", style, {}, {});
+        visualization.addTileFeatureLayer(TileFeatureLayer(makeRelationTestTile(sourceTileId, true, false)));
+        visualization.addTileFeatureLayer(TileFeatureLayer(auxiliaryTile));
+        visualization.run();
+
+        REQUIRE(visualization.numFeatureIdLookupFallbacks() == 0);
+        REQUIRE(nlohmann::json(visualization.externalRelationReferences()).size() == 1);
+    }
+
+    SECTION("Another id composition goes through the per-tile lookup")
+    {
+        DeckFeatureLayerVisualization visualization(0, "RelationTestMap/RelationLayer/0", style, {}, {});
+        visualization.addTileFeatureLayer(TileFeatureLayer(makeSecondaryReferenceSourceTile(sourceTileId)));
+        visualization.run();
+
+        REQUIRE(visualization.numFeatureIdLookupFallbacks() == 1);
+        REQUIRE(nlohmann::json(visualization.externalRelationReferences()).size() == 1);
+    }
 }
 
 TEST_CASE("DeckFeatureLayerVisualization exposes unresolved external relation references", "[erdblick.renderer]")
@@ -349,3 +636,737 @@ TEST_CASE("DeckFeatureLayerVisualization resolves external relations with canoni
 
     REQUIRE(hasRenderedPathGeometry(nlohmann::json(visualization.renderResult())));
 }
+
+TEST_CASE("DeckFeatureLayerVisualization restricts highlights to a feature address subset", "[erdblick.renderer]")
+{
+    auto style = FeatureLayerStyle(SharedUint8Array(R"yaml(
+name: "HoverTestStyle"
+rules:
+  - type: "Diamond"
+    mode: hover
+    color: "#ff5500"
+    width: 4
+  - type: "PointOfInterest"
+    mode: hover
+    color: "#00ff00"
+)yaml"));
+    auto tile = makeRelationTestTile(mapget::TileId::fromWgs84(42.0, 11.0, 13), true, true);
+
+    auto renderSubset = [&](nlohmann::json const& addresses) {
+        DeckFeatureLayerVisualization visualization(
+            0, "RelationTestMap/RelationLayer/0", style, {}, {}, FeatureStyleRule::HoverHighlight);
+        visualization.setFeatureAddressSubset(addresses);
+        visualization.addTileFeatureLayer(TileFeatureLayer(tile));
+        visualization.run();
+        return nlohmann::json(visualization.renderResult());
+    };
+    auto hasPoints = [](nlohmann::json const& result) {
+        return !result["pointWorld"]["positions"].empty() || !result["pointBillboard"]["positions"].empty();
+    };
+
+    auto const diamondOnly = renderSubset(nlohmann::json::array({0}));
+    REQUIRE(hasRenderedPathGeometry(diamondOnly));
+    REQUIRE(!hasPoints(diamondOnly));
+
+    auto const poiOnly = renderSubset(nlohmann::json::array({1, 7}));
+    REQUIRE(!hasRenderedPathGeometry(poiOnly));
+    REQUIRE(hasPoints(poiOnly));
+}
+
+TEST_CASE("DeckFeatureLayerVisualization packs typed buffers into one render arena", "[erdblick.renderer]")
+{
+    auto style = relationTestStyle();
+    auto tile = makeRelationTestTile(mapget::TileId::fromWgs84(42.0, 11.0, 13), true, true);
+
+    DeckFeatureLayerVisualization visualization(0, "RelationTestMap/RelationLayer/0", style, {}, {});
+    visualization.addTileFeatureLayer(TileFeatureLayer(tile));
+    visualization.run();
+
+    auto const copied = nlohmann::json(visualization.renderResult());
+    auto const packed = nlohmann::json(visualization.renderResultArena());
+    auto const& arena = visualization.renderArena();
+    REQUIRE(packed["arenaByteLength"].get<size_t>() == arena.size());
+
+    bool sawPathPositions = false;
+    for (auto const& descriptor : packed["buffers"]) {
+        auto const byteOffset = descriptor["byteOffset"].get<size_t>();
+        auto const length = descriptor["length"].get<size_t>();
+        auto const type = descriptor["type"].get<std::string>();
+        auto const elementSize = type == "Uint8Array" ? 1u : (type == "Float64Array" ? 8u : 4u);
+        REQUIRE(byteOffset % 8 == 0);
+        REQUIRE(byteOffset + length * elementSize <= arena.size());
+        if (descriptor["lod"].get<int>() != -1 || type == "Uint8Array") {
+            continue;
+        }
+
+        auto const& expected = copied[descriptor["bucket"].get<std::string>()][descriptor["field"].get<std::string>()];
+        REQUIRE(expected.size() == length);
+        auto const bucket = descriptor["bucket"].get<std::string>();
+        auto const isPathBucket = bucket == "pathWorld" || bucket == "pathBillboard";
+        if (isPathBucket && descriptor["field"] == "positions" && length > 0) {
+            sawPathPositions = true;
+            for (size_t i = 0; i < length; ++i) {
+                float value = 0.f;
+                std::memcpy(&value, arena.data() + byteOffset + i * sizeof(float), sizeof(float));
+                REQUIRE(value == expected[i].get<float>());
+            }
+        }
+    }
+    REQUIRE(sawPathPositions);
+}
+
+TEST_CASE("DeckFeatureLayerVisualization shares low-fi LOD ranges with the aggregate", "[erdblick.renderer]")
+{
+    auto style = relationTestStyle();
+    auto tile = makeRelationTestTile(mapget::TileId::fromWgs84(42.0, 11.0, 13), true, true);
+
+    DeckFeatureLayerVisualization visualization(
+        0, "RelationTestMap/RelationLayer/0", style, {}, {},
+        FeatureStyleRule::NoHighlight, FeatureStyleRule::LowFidelity, 0, 0);
+    visualization.addTileFeatureLayer(TileFeatureLayer(tile));
+    visualization.run();
+
+    auto const copied = nlohmann::json(visualization.renderResult());
+    REQUIRE(hasRenderedPathGeometry(copied));
+    REQUIRE(copied["lowFiBundles"].size() == 1);
+    auto const& bundle = copied["lowFiBundles"][0];
+    REQUIRE(bundle["lod"].get<int>() == 0);
+    REQUIRE(bundle["pathWorld"] == copied["pathWorld"]);
+    REQUIRE(bundle["pathBillboard"] == copied["pathBillboard"]);
+
+    // Every LOD-0 bulk column is a view of the same arena bytes as the aggregate.
+    auto const packed = nlohmann::json(visualization.renderResultArena());
+    std::map<std::string, nlohmann::json> aggregateDescriptors;
+    for (auto const& descriptor : packed["buffers"]) {
+        if (descriptor["lod"].get<int>() == -1) {
+            aggregateDescriptors[descriptor["bucket"].get<std::string>() + "/" + descriptor["field"].get<std::string>()] =
+                descriptor;
+        }
+    }
+    size_t sharedColumns = 0;
+    for (auto const& descriptor : packed["buffers"]) {
+        if (descriptor["lod"].get<int>() != 0) {
+            continue;
+        }
+        auto const& aggregate =
+            aggregateDescriptors.at(descriptor["bucket"].get<std::string>() + "/" + descriptor["field"].get<std::string>());
+        REQUIRE(descriptor["length"] == aggregate["length"]);
+        auto const field = descriptor["field"].get<std::string>();
+        if (field != "startIndices" && field != "textOffsets") {
+            REQUIRE(descriptor["byteOffset"] == aggregate["byteOffset"]);
+            ++sharedColumns;
+        }
+    }
+    REQUIRE(sharedColumns > 0);
+}
+
+TEST_CASE("DeckFeatureLayerVisualization simplifies lines in low-fidelity passes", "[erdblick.renderer]")
+{
+    auto style = FeatureLayerStyle(SharedUint8Array(R"yaml(
+name: "SimplifyTestStyle"
+rules:
+  - type: "Diamond"
+    color: "#ff5500"
+    width: 2
+)yaml"));
+    auto const tileId = mapget::TileId::fromWgs84(42.0, 11.0, 13);
+    auto const center = tileId.center();
+    std::vector<mapget::Point> jitteredLine;
+    for (int i = 0; i <= 40; ++i) {
+        jitteredLine.push_back({center.x - 0.001 + i * 0.00005, center.y + (i % 2 ? 1e-9 : -1e-9), 0.0});
+    }
+    auto tile = makeDiamondLineTile(tileId, {jitteredLine});
+
+    auto renderedVertices = [&](FeatureStyleRule::Fidelity fidelity) {
+        DeckFeatureLayerVisualization visualization(
+            0, "RelationTestMap/RelationLayer/0", style, {}, {}, FeatureStyleRule::NoHighlight, fidelity);
+        visualization.addTileFeatureLayer(TileFeatureLayer(tile));
+        visualization.run();
+        auto const result = nlohmann::json(visualization.renderResult());
+        return result["pathWorld"]["positions"].size() + result["pathBillboard"]["positions"].size();
+    };
+    REQUIRE(renderedVertices(FeatureStyleRule::AnyFidelity) == jitteredLine.size() * 3);
+    REQUIRE(renderedVertices(FeatureStyleRule::LowFidelity) == 2 * 3);
+}
+
+TEST_CASE("DeckFeatureLayerVisualization emits triangle indices for surfaces on request", "[erdblick.renderer]")
+{
+    auto style = FeatureLayerStyle(SharedUint8Array(R"yaml(
+name: "TriangulationTestStyle"
+rules:
+  - type: "Diamond"
+    geometry: [polygon]
+    color: "#ff5500"
+)yaml"));
+    auto const tileId = mapget::TileId::fromWgs84(42.0, 11.0, 13);
+    auto tile = makeEmptyRelationTestTile(tileId);
+    auto const center = tileId.center();
+    auto const d = 0.0005;
+    tile->newFeature("Diamond", {{"diamondId", 1}})->addPoly({
+        {center.x, center.y, 0.},
+        {center.x + 2 * d, center.y, 0.},
+        {center.x + 2 * d, center.y + d, 0.},
+        {center.x + d, center.y + d, 0.},
+        {center.x + d, center.y + 2 * d, 0.},
+        {center.x, center.y + 2 * d, 0.}});
+
+    auto render = [&](bool triangulate) {
+        DeckFeatureLayerVisualization visualization(0, "RelationTestMap/RelationLayer/0", style, {}, {});
+        visualization.setTriangulateSurfaces(triangulate);
+        visualization.addTileFeatureLayer(TileFeatureLayer(tile));
+        visualization.run();
+        return nlohmann::json(visualization.renderResult())["surface"];
+    };
+
+    auto const plain = render(false);
+    REQUIRE(plain["startIndices"].size() == 2);
+    auto const numVertices = plain["startIndices"][1].get<uint32_t>();
+    REQUIRE(plain["indexStartIndices"] == nlohmann::json::array({0}));
+    REQUIRE(plain["indices"].empty());
+
+    auto const triangulated = render(true);
+    REQUIRE(triangulated["positions"] == plain["positions"]);
+    REQUIRE(triangulated["indexStartIndices"] == nlohmann::json::array({0, 12}));
+    REQUIRE(triangulated["indices"].size() == 12);
+    for (auto const& index : triangulated["indices"]) {
+        REQUIRE(index.get<uint32_t>() < numVertices);
+    }
+}
+
+TEST_CASE("DeckFeatureLayerVisualization emits meshes as indexed buffers", "[erdblick.renderer]")
+{
+    auto style = FeatureLayerStyle(SharedUint8Array(R"yaml(
+name: "MeshTestStyle"
+rules:
+  - type: "Diamond"
+    geometry: [mesh]
+    color: "#ff5500"
+)yaml"));
+    auto const tileId = mapget::TileId::fromWgs84(42.0, 11.0, 13);
+    auto tile = makeEmptyRelationTestTile(tileId);
+    auto const center = tileId.center();
+    mapget::Point const a{center.x, center.y, 0.};
+    mapget::Point const b{center.x + 0.001, center.y, 0.};
+    mapget::Point const c{center.x + 0.001, center.y + 0.001, 0.};
+    mapget::Point const d{center.x, center.y + 0.001, 0.};
+    tile->newFeature("Diamond", {{"diamondId", 1}})->addMesh({a, b, c, a, c, d});
+
+    DeckFeatureLayerVisualization visualization(0, "RelationTestMap/RelationLayer/0", style, {}, {});
+    visualization.addTileFeatureLayer(TileFeatureLayer(tile));
+    visualization.run();
+    auto const result = nlohmann::json(visualization.renderResult());
+
+    // The quad's shared diagonal is stored once, with one color and address for the whole mesh.
+    auto const& mesh = result["mesh"];
+    REQUIRE(mesh["startIndices"] == nlohmann::json::array({0, 4}));
+    REQUIRE(mesh["positions"].size() == 4 * 3);
+    REQUIRE(mesh["indexStartIndices"] == nlohmann::json::array({0, 6}));
+    REQUIRE(mesh["indices"] == nlohmann::json::array({0, 1, 2, 0, 2, 3}));
+    REQUIRE(mesh["colors"].size() == 4);
+    REQUIRE(mesh["depthTests"].size() == 1);
+    REQUIRE(mesh["featureAddresses"].size() == 1);
+    REQUIRE(result["surface"]["featureAddresses"].empty());
+}
+
+TEST_CASE("DeckFeatureLayerVisualization stores path attributes once per path on request", "[erdblick.renderer]")
+{
+    auto style = FeatureLayerStyle(SharedUint8Array(R"yaml(
+name: "PerPathAttributeTestStyle"
+rules:
+  - type: "Diamond"
+    color: "#ff5500"
+    width: 2
+)yaml"));
+    auto const tileId = mapget::TileId::fromWgs84(42.0, 11.0, 13);
+    auto const center = tileId.center();
+    std::vector<mapget::Point> line;
+    for (int i = 0; i < 5; ++i) {
+        line.push_back({center.x + i * 0.0002, center.y + (i % 2) * 0.0001, 0.});
+    }
+    auto tile = makeDiamondLineTile(tileId, {line});
+
+    auto render = [&](bool perPath) {
+        DeckFeatureLayerVisualization visualization(0, "RelationTestMap/RelationLayer/0", style, {}, {});
+        visualization.setPerPathAttributes(perPath);
+        visualization.addTileFeatureLayer(TileFeatureLayer(tile));
+        visualization.run();
+        auto result = nlohmann::json(visualization.renderResult());
+        return result[renderedPathBucket(result)];
+    };
+
+    auto const perVertex = render(false);
+    auto const perPath = render(true);
+    REQUIRE(perPath["positions"] == perVertex["positions"]);
+    REQUIRE(perVertex["widths"].size() == line.size());
+    REQUIRE(perPath["widths"].size() == 1);
+    REQUIRE(perPath["colors"].size() == 4);
+    REQUIRE(perPath["dashArrays"].size() == 2);
+    for (size_t i = 0; i < 4; ++i) {
+        REQUIRE(perPath["colors"][i] == perVertex["colors"][i]);
+    }
+}
+
+TEST_CASE("DeckFeatureLayerVisualization merges shard buffers in feature order", "[erdblick.renderer]")
+{
+    auto const styleYaml = std::string(R"yaml(
+name: "ShardTestStyle"
+rules:
+  - type: "Diamond"
+    color: "#ff5500"
+    width: 2
+)yaml");
+    auto const tileId = mapget::TileId::fromWgs84(42.0, 11.0, 13);
+    constexpr uint32_t featureCount = 7;
+    auto const center = tileId.center();
+    std::vector<std::vector<mapget::Point>> lines(featureCount);
+    for (uint32_t i = 0; i < featureCount; ++i) {
+        for (uint32_t j = 0; j <= i % 3 + 1; ++j) {
+            lines[i].push_back({center.x + j * 0.0002, center.y + i * 0.0001, 0.});
+        }
+    }
+    // Every shard needs its own parsed tile, so the same tile is built once per visualization.
+    auto makeTile = [&]() { return makeDiamondLineTile(tileId, lines); };
+
+    auto style = FeatureLayerStyle(SharedUint8Array(styleYaml));
+    DeckFeatureLayerVisualization sequential(0, "RelationTestMap/RelationLayer/0", style, {}, {});
+    sequential.addTileFeatureLayer(TileFeatureLayer(makeTile()));
+    sequential.run();
+    auto const expected = nlohmann::json(sequential.renderResult());
+
+    DeckFeatureLayerVisualization merged(0, "RelationTestMap/RelationLayer/0", style, {}, {});
+    merged.addTileFeatureLayer(TileFeatureLayer(makeTile()));
+    std::vector<std::unique_ptr<FeatureLayerStyle>> shardStyles;
+    std::vector<std::unique_ptr<DeckFeatureLayerVisualization>> shards;
+    std::vector<DeckFeatureLayerVisualization*> shardPointers;
+    for (auto const& [begin, end] : {std::pair{0u, 3u}, std::pair{3u, 5u}, std::pair{5u, featureCount}}) {
+        auto& shardStyle = shardStyles.emplace_back(
+            std::make_unique<FeatureLayerStyle>(SharedUint8Array(styleYaml)));
+        auto& shard = shards.emplace_back(std::make_unique<DeckFeatureLayerVisualization>(
+            0, "RelationTestMap/RelationLayer/0", *shardStyle, NativeJsValue{}, NativeJsValue{}));
+        shard->addTileFeatureLayer(TileFeatureLayer(makeTile()));
+        shard->setFeatureAddressRange(begin, end);
+        shardPointers.push_back(shard.get());
+    }
+    merged.runShards(shardPointers);
+    auto const actual = nlohmann::json(merged.renderResult());
+
+    auto const bucket = renderedPathBucket(expected);
+    REQUIRE(expected[bucket]["featureAddresses"].size() == featureCount);
+    for (auto const* field : {"positions", "startIndices", "colors", "widths", "featureAddresses"}) {
+        REQUIRE(actual[bucket][field] == expected[bucket][field]);
+    }
+    REQUIRE(expected["coordinateOrigin"] != nlohmann::json::array({0., 0., 0.}));
+    REQUIRE(actual["coordinateOrigin"] == expected["coordinateOrigin"]);
+}
+
+TEST_CASE("DeckFeatureLayerVisualization renders relations and merged points of shards over the whole tile", "[erdblick.renderer]")
+{
+    auto const styleYaml = std::string(R"yaml(
+name: "ShardMergeTestStyle"
+rules:
+  - type: "Diamond"
+    color: "#00aaff"
+    width: 2
+  - type: "Diamond"
+    aspect: relation
+    relation-type: "hasPoi"
+    color: "#ff5500"
+    width: 4
+  - type: "PointOfInterest"
+    color-expression: "$mergeCount == 3 and 'red' or 'lime'"
+    label-text: "Poi"
+    point-merge-grid-cell: [0.01, 0.01, 1000]
+)yaml");
+    auto const tileId = mapget::TileId::fromWgs84(42.0, 11.0, 13);
+    auto const center = tileId.center();
+    // Addresses: Diamond 1, POI 200, POI 201, POI 202 and a Diamond whose POI is missing.
+    // The shard boundary splits the POIs of the one merge grid cell.
+    auto makeTile = [&]() {
+        auto tile = makeRelationTestTile(tileId, true, true);
+        for (auto pointId : {201, 202}) {
+            tile->newFeature("PointOfInterest", {{"pointId", pointId}})
+                ->addPoint({center.x, center.y + 0.0005, 0.0});
+        }
+        auto source = tile->newFeature("Diamond", {{"diamondId", 2}});
+        source->addLine({{center.x - 0.0005, center.y - 0.0005, 0.0}, {center.x, center.y - 0.0005, 0.0}});
+        source->addRelation("hasPoi", "PointOfInterest", {{"areaId", "Area"}, {"pointId", 300}});
+        return tile;
+    };
+
+    auto style = FeatureLayerStyle(SharedUint8Array(styleYaml));
+    DeckFeatureLayerVisualization sequential(0, "RelationTestMap/RelationLayer/0", style, {}, {});
+    sequential.addTileFeatureLayer(TileFeatureLayer(makeTile()));
+    sequential.run();
+    auto const expected = nlohmann::json(sequential.renderResult());
+
+    DeckFeatureLayerVisualization merged(0, "RelationTestMap/RelationLayer/0", style, {}, {});
+    merged.addTileFeatureLayer(TileFeatureLayer(makeTile()));
+    std::vector<std::unique_ptr<FeatureLayerStyle>> shardStyles;
+    std::vector<std::unique_ptr<DeckFeatureLayerVisualization>> shards;
+    std::vector<DeckFeatureLayerVisualization*> shardPointers;
+    for (auto const& [begin, end] : {std::pair{0u, 2u}, std::pair{2u, 5u}}) {
+        auto& shardStyle = shardStyles.emplace_back(
+            std::make_unique<FeatureLayerStyle>(SharedUint8Array(styleYaml)));
+        auto& shard = shards.emplace_back(std::make_unique<DeckFeatureLayerVisualization>(
+            0, "RelationTestMap/RelationLayer/0", *shardStyle, NativeJsValue{}, NativeJsValue{}));
+        shard->addTileFeatureLayer(TileFeatureLayer(makeTile()));
+        shard->setFeatureAddressRange(begin, end);
+        shardPointers.push_back(shard.get());
+    }
+    merged.runShards(shardPointers);
+    auto const actual = nlohmann::json(merged.renderResult());
+
+    auto const mergedPoints = nlohmann::json(merged.mergedPointFeatures());
+    REQUIRE(mergedPoints == nlohmann::json(sequential.mergedPointFeatures()));
+    REQUIRE(mergedPoints.size() == 1);
+    auto const& cells = mergedPoints.begin().value();
+    REQUIRE(cells.size() == 1);
+    REQUIRE(cells[0]["featureAddresses"].size() == 3);
+    REQUIRE(cells[0]["pointParameters"]["color"] == nlohmann::json::array({255, 0, 0, 255}));
+
+    auto const references = nlohmann::json(merged.externalRelationReferences());
+    REQUIRE(references.size() == 1);
+    REQUIRE(references == nlohmann::json(sequential.externalRelationReferences()));
+
+    // Relation paths precede the shards' paths, so only the set of paths must match.
+    auto const bucket = renderedPathBucket(expected);
+    auto sortedAddresses = [&](nlohmann::json const& result) {
+        auto addresses = result[bucket]["featureAddresses"].get<std::vector<uint32_t>>();
+        std::ranges::sort(addresses);
+        return addresses;
+    };
+    REQUIRE_FALSE(expected[bucket]["featureAddresses"].empty());
+    REQUIRE(sortedAddresses(actual) == sortedAddresses(expected));
+}
+
+TEST_CASE("DeckFeatureLayerVisualization resumes and cancels time-sliced runs", "[erdblick.renderer]")
+{
+    auto style = FeatureLayerStyle(SharedUint8Array(R"yaml(
+name: "TimeSliceTestStyle"
+rules:
+  - type: "Diamond"
+    color: "#ff5500"
+    width: 2
+)yaml"));
+    auto const tileId = mapget::TileId::fromWgs84(42.0, 11.0, 13);
+    constexpr uint32_t featureCount = 4;
+    auto tile = makeDiamondLineTile(tileId, stackedTestLines(tileId, featureCount));
+
+    DeckFeatureLayerVisualization complete(0, "RelationTestMap/RelationLayer/0", style, {}, {});
+    complete.addTileFeatureLayer(TileFeatureLayer(tile));
+    complete.run();
+    auto const expected = nlohmann::json(complete.renderResult());
+
+    // A zero budget still renders one feature per slice.
+    DeckFeatureLayerVisualization sliced(0, "RelationTestMap/RelationLayer/0", style, {}, {});
+    sliced.addTileFeatureLayer(TileFeatureLayer(tile));
+    uint32_t slices = 1;
+    while (sliced.runFor(0.)) {
+        ++slices;
+    }
+    REQUIRE(slices == featureCount);
+    auto const bucket = renderedPathBucket(expected);
+    auto const actual = nlohmann::json(sliced.renderResult());
+    REQUIRE(actual[bucket]["positions"] == expected[bucket]["positions"]);
+    REQUIRE(actual[bucket]["featureAddresses"] == expected[bucket]["featureAddresses"]);
+
+    DeckFeatureLayerVisualization cancelled(0, "RelationTestMap/RelationLayer/0", style, {}, {});
+    cancelled.addTileFeatureLayer(TileFeatureLayer(tile));
+    REQUIRE(cancelled.runFor(0.));
+    cancelled.cancel();
+    auto const empty = nlohmann::json(cancelled.renderResult());
+    REQUIRE(empty[bucket]["positions"].empty());
+    REQUIRE_FALSE(cancelled.runFor(1e9));
+    REQUIRE(nlohmann::json(cancelled.renderResult())[bucket]["positions"] == expected[bucket]["positions"]);
+}
+
+TEST_CASE("DeckFeatureLayerVisualization renders a batch of tiles with one setup", "[erdblick.renderer]")
+{
+    auto style = FeatureLayerStyle(SharedUint8Array(R"yaml(
+name: "BatchTestStyle"
+rules:
+  - type: "Diamond"
+    color: "#ff5500"
+    width: 2
+)yaml"));
+    auto makeTile = [](mapget::TileId tileId, uint32_t featureCount) {
+        return makeDiamondLineTile(tileId, stackedTestLines(tileId, featureCount));
+    };
+    std::vector<std::shared_ptr<mapget::TileFeatureLayer>> tiles{
+        makeTile(mapget::TileId::fromWgs84(42.0, 11.0, 13), 3),
+        makeTile(mapget::TileId::fromWgs84(42.1, 11.0, 13), 1)};
+
+    std::vector<std::unique_ptr<TileFeatureLayer>> tileLayers;
+    std::vector<TileFeatureLayer const*> batch;
+    for (auto const& tile : tiles) {
+        batch.push_back(tileLayers.emplace_back(std::make_unique<TileFeatureLayer>(tile)).get());
+    }
+    DeckFeatureLayerVisualization batchVisualization(0, "RelationTestMap/RelationLayer/0", style, {}, {});
+    auto const results = nlohmann::json(batchVisualization.renderTiles(batch));
+    REQUIRE(results.size() == tiles.size());
+
+    for (size_t i = 0; i < tiles.size(); ++i) {
+        DeckFeatureLayerVisualization single(0, "RelationTestMap/RelationLayer/0", style, {}, {});
+        single.addTileFeatureLayer(TileFeatureLayer(tiles[i]));
+        single.run();
+        auto const expected = nlohmann::json(single.renderResult());
+        auto const bucket = renderedPathBucket(expected);
+        REQUIRE(results[i]["coordinateOrigin"] == expected["coordinateOrigin"]);
+        REQUIRE(results[i][bucket]["positions"] == expected[bucket]["positions"]);
+        REQUIRE(results[i][bucket]["featureAddresses"] == expected[bucket]["featureAddresses"]);
+    }
+}
+
+TEST_CASE("DeckMultiStyleVisualization renders several styles in one traversal", "[erdblick.renderer]")
+{
+    auto lineStyle = FeatureLayerStyle(SharedUint8Array(R"yaml(
+name: "MultiStyleLines"
+rules:
+  - type: "Diamond"
+    color: "#ff5500"
+    width: 2
+)yaml"));
+    auto outlineStyle = FeatureLayerStyle(SharedUint8Array(R"yaml(
+name: "MultiStyleOutlines"
+rules:
+  - type: "Diamond"
+    color: "#0055ff"
+    width: 6
+)yaml"));
+    auto const tileId = mapget::TileId::fromWgs84(42.0, 11.0, 13);
+    auto tile = makeDiamondLineTile(tileId, stackedTestLines(tileId, 3));
+
+    DeckMultiStyleVisualization multiStyle(
+        0, "RelationTestMap/RelationLayer/0", {&lineStyle, &outlineStyle}, {}, {});
+    multiStyle.addTileFeatureLayer(TileFeatureLayer(tile));
+    multiStyle.run();
+    REQUIRE(multiStyle.size() == 2);
+
+    std::array<FeatureLayerStyle const*, 2> styles{&lineStyle, &outlineStyle};
+    for (uint32_t i = 0; i < styles.size(); ++i) {
+        DeckFeatureLayerVisualization single(0, "RelationTestMap/RelationLayer/0", *styles[i], {}, {});
+        single.addTileFeatureLayer(TileFeatureLayer(tile));
+        single.run();
+        auto const expected = nlohmann::json(single.renderResult());
+        auto const actual = nlohmann::json(multiStyle.visualization(i).renderResult());
+        auto const bucket = renderedPathBucket(expected);
+        REQUIRE_FALSE(expected[bucket]["featureAddresses"].empty());
+        for (auto const* field : {"positions", "colors", "widths", "featureAddresses"}) {
+            REQUIRE(actual[bucket][field] == expected[bucket][field]);
+        }
+    }
+}
+
+TEST_CASE("DeckMultiStyleVisualization shares one field dictionary across styles with options", "[erdblick.renderer]")
+{
+    auto lineStyle = FeatureLayerStyle(SharedUint8Array(R"yaml(
+name: "MultiStyleTintedLines"
+options:
+  - label: Line Tint
+    id: lineTint
+    type: color
+    default: "#ff0000"
+rules:
+  - type: "Diamond"
+    filter: "not lineOnlyField"
+    color-expression: "lineTint"
+    width: 2
+)yaml"));
+    auto outlineStyle = FeatureLayerStyle(SharedUint8Array(R"yaml(
+name: "MultiStyleTintedOutlines"
+options:
+  - label: Outline Tint
+    id: outlineTint
+    type: color
+    default: "#00ff00"
+rules:
+  - type: "Diamond"
+    filter: "not outlineOnlyField"
+    color-expression: "outlineTint"
+    width: 6
+)yaml"));
+    auto const tileId = mapget::TileId::fromWgs84(42.0, 11.0, 13);
+    auto tile = makeDiamondLineTile(tileId, stackedTestLines(tileId, 2));
+    auto const optionValuesPerStyle = nlohmann::json::array({
+        nlohmann::json{{"lineTint", "#112233"}},
+        nlohmann::json{{"outlineTint", "#445566"}}});
+
+    // Both styles intern their option and field names while the tile is rendered; the
+    // tile must resolve either style's names through the one dictionary it points to.
+    DeckMultiStyleVisualization multiStyle(
+        0, "RelationTestMap/RelationLayer/0", {&lineStyle, &outlineStyle}, optionValuesPerStyle, {});
+    multiStyle.addTileFeatureLayer(TileFeatureLayer(tile));
+    multiStyle.run();
+
+    std::array<FeatureLayerStyle const*, 2> styles{&lineStyle, &outlineStyle};
+    for (uint32_t i = 0; i < styles.size(); ++i) {
+        auto singleTile = makeDiamondLineTile(tileId, stackedTestLines(tileId, 2));
+        DeckFeatureLayerVisualization single(
+            0, "RelationTestMap/RelationLayer/0", *styles[i], optionValuesPerStyle[i], {});
+        single.addTileFeatureLayer(TileFeatureLayer(singleTile));
+        single.run();
+        auto const expected = nlohmann::json(single.renderResult());
+        auto const actual = nlohmann::json(multiStyle.visualization(i).renderResult());
+        auto const bucket = renderedPathBucket(expected);
+        REQUIRE(expected[bucket]["featureAddresses"].size() == 2);
+        for (auto const* field : {"colors", "widths", "featureAddresses"}) {
+            REQUIRE(actual[bucket][field] == expected[bucket][field]);
+        }
+    }
+}
+
+TEST_CASE("DeckFeatureLayerVisualization reads options in per-feature expressions", "[erdblick.renderer]")
+{
+    auto style = FeatureLayerStyle(SharedUint8Array(R"yaml(
+name: "PerFeatureOptionTestStyle"
+options:
+  - label: Line Tint
+    id: lineTint
+    type: color
+    default: "#ff0000"
+  - label: Other Tint
+    id: other-tint
+    type: color
+    default: "#ff0000"
+rules:
+  - type: "Diamond"
+    color-expression: "diamondId == 1 and lineTint or _['other-tint']"
+    width: 2
+)yaml"));
+    auto const tileId = mapget::TileId::fromWgs84(42.0, 11.0, 13);
+    auto tile = makeDiamondLineTile(tileId, stackedTestLines(tileId, 2));
+    REQUIRE(style.contextOptionIds() == std::vector<std::string>{"other-tint"});
+
+    // lineTint compiles into a constant, other-tint is looked up in the evaluation context.
+    DeckFeatureLayerVisualization visualization(
+        0,
+        "RelationTestMap/RelationLayer/0",
+        style,
+        nlohmann::json{{"lineTint", "#00ff00"}, {"other-tint", "#0000ff"}},
+        {});
+    visualization.setPerPathAttributes(true);
+    visualization.addTileFeatureLayer(TileFeatureLayer(tile));
+    visualization.run();
+    auto const result = nlohmann::json(visualization.renderResult());
+    auto const& paths = result[renderedPathBucket(result)];
+
+    REQUIRE(paths["featureAddresses"].size() == 2);
+    REQUIRE(paths["colors"] == nlohmann::json::array({0, 0, 255, 255, 0, 255, 0, 255}));
+}
+
+TEST_CASE("TileFeatureLayer caches feature geometry summaries by address", "[erdblick.layer]")
+{
+    auto const tileId = mapget::TileId::fromWgs84(42.0, 11.0, 13);
+    auto const center = tileId.center();
+    std::vector<mapget::Point> const line{
+        {center.x, center.y, 0.},
+        {center.x + 0.002, center.y + 0.001, 4.},
+        {center.x + 0.001, center.y - 0.001, 2.}};
+    auto tile = makeDiamondLineTile(tileId, {line});
+
+    TileFeatureLayer layer(tile);
+    auto const& summary = layer.geometrySummary(0);
+    auto feature = layer.featureByAddress(0);
+    REQUIRE(summary.center.x == geometryCenter(feature->preferredGeometry()).x);
+    REQUIRE(summary.center.y == geometryCenter(feature->preferredGeometry()).y);
+    REQUIRE(layer.featureBoundingRadiusEndPoint(0).x == summary.boundingRadiusEndPoint.x);
+
+    // Copies of the wrapper share one table, so the entry is not recomputed.
+    TileFeatureLayer copy(layer);
+    REQUIRE(&copy.geometrySummary(0) == &summary);
+    REQUIRE(layer.geometrySummary(7).center.x == 0.);
+}
+
+TEST_CASE("DeckFeatureLayerVisualization emits columnar labels and legacy label objects", "[erdblick.renderer]")
+{
+    auto style = FeatureLayerStyle(SharedUint8Array(R"yaml(
+name: "LabelTestStyle"
+rules:
+  - type: "PointOfInterest"
+    label-text: "Poi"
+    label-color: "#ff0000"
+)yaml"));
+    auto tile = makeRelationTestTile(mapget::TileId::fromWgs84(42.0, 11.0, 13), false, true);
+
+    DeckFeatureLayerVisualization visualization(0, "RelationTestMap/RelationLayer/0", style, {}, {});
+    visualization.addTileFeatureLayer(TileFeatureLayer(tile));
+    visualization.run();
+
+    auto const columnar = nlohmann::json(visualization.renderResult());
+    auto const& labels = columnar["labelWorld"]["featureAddresses"].empty()
+        ? columnar["labelBillboard"]
+        : columnar["labelWorld"];
+    auto const numLabels = labels["featureAddresses"].size();
+    REQUIRE(numLabels > 0);
+    REQUIRE(labels["positions"].size() == numLabels * 3);
+    REQUIRE(labels["textOffsets"].size() == numLabels + 1);
+    REQUIRE(labels["textOffsets"][numLabels].get<uint32_t>() == numLabels * 3);
+    REQUIRE(labels["scales"].size() == numLabels);
+
+    visualization.setAbiVersion(DeckFeatureLayerVisualization::kLabelObjectsAbiVersion);
+    auto const legacy = nlohmann::json(visualization.renderResult());
+    auto const& labelObjects = legacy["labelWorld"].empty() ? legacy["labelBillboard"] : legacy["labelWorld"];
+    REQUIRE(labelObjects.is_array());
+    REQUIRE(labelObjects.size() == numLabels);
+    REQUIRE(labelObjects[0]["text"].get<std::string>() == "Poi");
+    REQUIRE(labelObjects[0]["fillColor"][0].get<int>() == 255);
+    REQUIRE(labelObjects[0]["fillColor"][1].get<int>() == 0);
+}
+
+TEST_CASE("DeckFeatureLayerVisualization merges points and labels per grid cell", "[erdblick.renderer]")
+{
+    auto style = FeatureLayerStyle(SharedUint8Array(R"yaml(
+name: "MergeTestStyle"
+rules:
+  - type: "PointOfInterest"
+    color-expression: "$mergeCount == 2 and 'red' or $mergeCount == 7 and 'blue' or 'lime'"
+    label-text: "Poi"
+    point-merge-grid-cell: [0.01, 0.01, 1000]
+)yaml"));
+    auto const tileId = mapget::TileId::fromWgs84(42.0, 11.0, 13);
+    auto tile = makeRelationTestTile(tileId, false, true);
+    // A second POI at the same position shares the packed grid cell key of the first.
+    tile->newFeature("PointOfInterest", {{"pointId", 201}})
+        ->addPoint({tileId.center().x, tileId.center().y + 0.0005, 0.0});
+
+    auto renderMergedCell = [&](nlohmann::json const& mergeService)
+    {
+        DeckFeatureLayerVisualization visualization(
+            0, "RelationTestMap/RelationLayer/0", style, {}, mergeService);
+        visualization.addTileFeatureLayer(TileFeatureLayer(tile));
+        visualization.run();
+
+        auto const merged = nlohmann::json(visualization.mergedPointFeatures());
+        REQUIRE(merged.size() == 1);
+        REQUIRE(merged.begin().key() == "0:RelationTestMap:RelationLayer:MergeTestStyle:0:0");
+        auto const& cells = merged.begin().value();
+        REQUIRE(cells.size() == 1);
+        return cells[0];
+    };
+
+    SECTION("Local features of one cell are counted together")
+    {
+        // The mock merge service has no canned countBatch result, so counts fall back to count().
+        auto const cell = renderMergedCell(nlohmann::json::object());
+        REQUIRE(cell["featureAddresses"].size() == 2);
+        REQUIRE(cell.contains("pointParameters"));
+        REQUIRE(cell.contains("labelParameters"));
+        REQUIRE(cell["pointParameters"]["color"] == nlohmann::json::array({255, 0, 0, 255}));
+
+        auto const& position = cell["position"];
+        auto const expectedHash =
+            std::to_string(static_cast<int64_t>(std::floor(position["x"].get<double>() / 0.01))) + ":" +
+            std::to_string(static_cast<int64_t>(std::floor(position["y"].get<double>() / 0.01))) + ":" +
+            std::to_string(static_cast<int64_t>(std::floor(position["z"].get<double>() / 1000.)));
+        REQUIRE(cell["positionHash"].get<std::string>() == expectedHash);
+    }
+
+    SECTION("Batched external counts replace per-cell count calls")
+    {
+        // A count() result would yield $mergeCount == 102, so blue proves it was not consulted.
+        auto const cell = renderMergedCell(nlohmann::json{
+            {"mockResults", {{"countBatch", nlohmann::json::array({5})}, {"count", 100}}}});
+        REQUIRE(cell["featureAddresses"].size() == 2);
+        REQUIRE(cell["pointParameters"]["color"] == nlohmann::json::array({0, 0, 255, 255}));
+    }
+}